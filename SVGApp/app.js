@@ -90,26 +90,31 @@ console.log('Running app at localhost: ' + portNum);
 
 //Get images
 app.get('/files', function (req, res) {
-  const fs = require('fs');
-  const files = fs.readdirSync('uploads');
-  let images = [];
-  const library = ffi.Library("./libsvgparse", {'fileToJSON': ['string', ['string', 'string']]});
-
-  //Populate an array wiht information about every SVG image in the uploads directory
-  files.forEach(file => {
-    var fileData = [];
-    var result = JSON.parse(library.fileToJSON('uploads/' + file, "parser/bin/files/svg.xsd"));
-    fileData[0] = file;
-    fileData[1] = Math.round(fs.statSync("uploads/" + file).size / 1024);
-    fileData[2] = result.numRect;
-    fileData[3] = result.numCirc;
-    fileData[4] = result.numPaths;
-    fileData[5] = result.numGroups;
-    images.push(fileData);
-  });
+  const library = ffi.Library("./libsvgparse", {'directoryToJSON': ['string', ['string', 'string']]});
+  //Every file is summarized in one call, on the parser's own worker threads. The call runs off the event loop so
+  //other requests are served while the directory is scanned.
+  library.directoryToJSON.async('uploads', "parser/bin/files/svg.xsd", function (error, result) {
+    if (error) {
+      return res.status(500).send("Could not read the uploaded files.");
+    }
+    const summaries = JSON.parse(result || "[]");
+    let images = [];
+
+    //Populate an array wiht information about every SVG image in the uploads directory
+    summaries.forEach(summary => {
+      var fileData = [];
+      fileData[0] = summary.name;
+      fileData[1] = Math.round(summary.size / 1024);
+      fileData[2] = summary.numRect;
+      fileData[3] = summary.numCirc;
+      fileData[4] = summary.numPaths;
+      fileData[5] = summary.numGroups;
+      images.push(fileData);
+    });
 
-  res.send({
-    data: JSON.stringify(images)
+    res.send({
+      data: JSON.stringify(images)
+    });
   });
 });
 
@@ -135,6 +140,34 @@ app.get('/fileData', function(req, res) {
   res.send(result);
 });
 
+//Components returned per page when the request does not say
+const DEFAULT_PAGE_SIZE = 50;
+
+//Get one page of an image's components of a type, optionally only those with an attribute or in an area
+app.get('/fileComponents', function(req, res) {
+  const library = ffi.Library("./libsvgparse", {'componentQueryJSON': ['string', ['string', 'string', 'string', 'int', 'int', 'string', 'string', 'string']]});
+  const offset = parseInt(req.query.offset) || 0;
+  const limit = parseInt(req.query.limit) || DEFAULT_PAGE_SIZE;
+  const result = library.componentQueryJSON("uploads/" + req.query.filename, "parser/bin/files/svg.xsd", req.query.type,
+    offset, limit, req.query.attrName || null, req.query.attrValue || null, req.query.area || null);
+  if (result === null) {
+    return res.status(400).send("Could not read components.");
+  }
+  res.send(result);
+});
+
+//Get the first page of each type of an image's components, with the same filters as /fileComponents, from one load
+app.get('/fileDetails', function(req, res) {
+  const library = ffi.Library("./libsvgparse", {'componentPagesJSON': ['string', ['string', 'string', 'int', 'string', 'string', 'string']]});
+  const limit = parseInt(req.query.limit) || DEFAULT_PAGE_SIZE;
+  const result = library.componentPagesJSON("uploads/" + req.query.filename, "parser/bin/files/svg.xsd", limit,
+    req.query.attrName || null, req.query.attrValue || null, req.query.area || null);
+  if (result === null) {
+    return res.status(400).send("Could not read components.");
+  }
+  res.send(result);
+});
+
 function validFile (filePath) {
   const library = ffi.Library("./libsvgparse", {'validateFile': ['bool', ['string', 'string']]});
   return library.validateFile(filePath, "parser/bin/files/svg.xsd");
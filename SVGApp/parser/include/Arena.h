@@ -0,0 +1,79 @@
+/**
+ * @file Arena.h
+ * @brief Region allocator used to give an SVGimage all of its memory from a few large slabs, so that the whole
+ * image can be released at once instead of one struct at a time.
+ */
+
+#ifndef _ARENA_API_
+#define _ARENA_API_
+
+#include <stddef.h>
+
+/**
+ * One block of memory that allocations are carved out of. Slabs are chained so the arena can grow.
+ **/
+typedef struct arenaSlab{
+    struct arenaSlab* next;
+    size_t size;
+    size_t used;
+} ArenaSlab;
+
+/**
+ * A function to run, and the data to run it on, when the arena is freed.
+ * Used for heap memory that the arena has taken ownership of.
+ **/
+typedef struct arenaCleanup{
+    struct arenaCleanup* next;
+    void* data;
+    void (*cleanup)(void* data);
+} ArenaCleanup;
+
+/**
+ * Metadata head of the arena.
+ **/
+typedef struct arena{
+    ArenaSlab* slabs;
+    ArenaCleanup* cleanups;
+    size_t slabSize;
+} Arena;
+
+
+/** Function to create an empty arena.
+ *@post An arena with no slabs has been allocated. Slabs are allocated as memory is requested.
+ *@return On success the newly allocated Arena. NULL if malloc fails
+ *@param slabSize - size in bytes of each slab. 0 uses a default size
+ **/
+Arena* createArena(size_t slabSize);
+
+/** Allocates zeroed memory from the arena, like calloc. The memory is only released by freeArena.
+ *@pre arena is not NULL
+ *@return Pointer to size bytes of zeroed memory, aligned for any type. NULL if malloc fails
+ *@param arena - the arena to allocate from
+ *@param size - number of bytes to allocate
+ **/
+void* arenaAlloc(Arena* arena, size_t size);
+
+/** Copies a string into the arena.
+ *@pre arena and string are not NULL
+ *@return The copy of the string
+ *@param arena - the arena to allocate from
+ *@param string - the string to copy
+ **/
+char* arenaStrdup(Arena* arena, const char* string);
+
+/** Registers a function to run when the arena is freed, e.g. to free heap memory the arena has taken ownership of.
+ * Cleanups run in the reverse order that they were added.
+ *@pre arena and cleanup are not NULL
+ *@param arena - the arena
+ *@param data - the data to pass to cleanup
+ *@param cleanup - the function to run
+ **/
+void arenaAddCleanup(Arena* arena, void* data, void (*cleanup)(void* data));
+
+/** Runs the arena's cleanups, then releases every slab and the arena itself.
+ *@post Every pointer that was allocated from the arena is invalid
+ *@param arena - the arena to free. May be NULL
+ **/
+void freeArena(Arena* arena);
+
+#endif
@@ -0,0 +1,65 @@
+/**
+ * @file BoundingBox.h
+ * @brief Axis aligned bounding boxes, and kernels that compute them over contiguous coordinate arrays.
+ * The kernels use SSE or AVX when the compiler targets them and plain C otherwise.
+ */
+
+#ifndef _BOUNDING_BOX_API_
+#define _BOUNDING_BOX_API_
+
+#include <stdbool.h>
+
+/**
+ * An axis aligned box. A box that contains nothing has minX > maxX, see emptyBounds.
+ **/
+typedef struct boundingBox{
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+} BoundingBox;
+
+
+/** Function to get a box that contains nothing. Adding anything to it gives that thing's box.
+ *@return The empty box
+ **/
+BoundingBox emptyBounds();
+
+/** Function to check whether a box contains nothing
+ *@return true if the box is empty
+ *@param box - the box
+ **/
+bool boundsIsEmpty(BoundingBox box);
+
+/** Function to check whether two boxes overlap, edges included
+ *@return true if they overlap. An empty box overlaps nothing
+ *@param a - the first box
+ *@param b - the second box
+ **/
+bool boundsIntersect(BoundingBox a, BoundingBox b);
+
+/** Grows a box to contain a point.
+ *@pre box is not NULL
+ *@param box - the box to grow
+ *@param x - the point's x coordinate
+ *@param y - the point's y coordinate
+ **/
+void boundsAddPoint(BoundingBox* box, float x, float y);
+
+/** Grows a box to contain every point in a pair of coordinate arrays.
+ *@pre box is not NULL, x and y have at least count elements
+ *@param box - the box to grow
+ *@param x - the points' x coordinates
+ *@param y - the points' y coordinates
+ *@param count - the number of points
+ **/
+void boundsAddPoints(BoundingBox* box, const float* x, const float* y, int count);
+
+/** Grows a box to contain another box.
+ *@pre box is not NULL
+ *@param box - the box to grow
+ *@param other - the box to add. Empty boxes add nothing
+ **/
+void boundsAddBox(BoundingBox* box, BoundingBox other);
+
+#endif
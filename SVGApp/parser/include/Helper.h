@@ -1,42 +1,244 @@
 /* Name: Nicholas Rosati
  * Student ID: 1037025
  * Email: nrosati@uoguelph.ca*/
+#include <time.h>
+#include <pthread.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
+#include <libxml/xmlwriter.h>
 #include "LinkedListAPI.h"
+#include "VectorAPI.h"
+#include "StringBuffer.h"
+#include "StringPool.h"
+#include "RTree.h"
+#include "SummaryCache.h"
+#include "MappedFile.h"
+#include "MetadataPatch.h"
+#include "Snapshot.h"
+#include "NumberParser.h"
+#include "NumberFormat.h"
+#include "Keywords.h"
 #include "SVGParser.h"
 
 #ifndef _HELPER_
 #define _HELPER_
 #define PI 3.1415926535
 
+//A random access copy of a list, in list order, and the version of the list it was copied from
+typedef struct {
+    Vector* elements;
+    unsigned long version;
+} ListView;
+
+//Flattened views of every component in an image, nested ones included, in the order the get* functions return them
+typedef struct {
+    Vector* rectangles;
+    Vector* circles;
+    Vector* paths;
+    Vector* groups;
+} ComponentViews;
+
+//Lookup structures for an SVGimage, built from its lists when first needed
+typedef struct svgIndex {
+    //Views of the image's top level lists, used to find an element by index.
+    //A view is rebuilt when its list's version no longer matches.
+    ListView rectangles;
+    ListView circles;
+    ListView paths;
+    ListView groups;
+    //Flattened views shared by the get*, num* and JSON functions, built on first use and rebuilt when the image is no
+    //longer at viewsVersion. See getComponentViews.
+    ComponentViews views;
+    unsigned long viewsVersion;
+    //Cached result of getImageBounds, used while boundsValid is set and the image is still at boundsVersion
+    BoundingBox bounds;
+    bool boundsValid;
+    unsigned long boundsVersion;
+    //Spatial index over every rectangle, circle and path, built on first query and rebuilt when the image is no
+    //longer at spatialVersion. See getSpatialIndex.
+    RTree* spatial;
+    unsigned long spatialVersion;
+    //Parsed path data, by path. See getPathGeometry.
+    PathGeometryCache* geometry;
+} SVGindex;
+
+//A compiled XSD schema, cached by path and invalidated when the file on disk changes
+typedef struct {
+    char* path;
+    struct timespec mtime;
+    long size;
+    xmlSchema* schema;
+    //Number of validations currently using the schema
+    int refCount;
+    //Set once the entry has been replaced in the cache. It is freed when the last user releases it.
+    bool stale;
+} SchemaCacheEntry;
+
+//The component counts SVGtoJSON reports, nested components included
+typedef struct {
+    int rectangles;
+    int circles;
+    int paths;
+    int groups;
+} ComponentCounts;
+
+//Shared state for the worker threads of directoryToJSON
+typedef struct {
+    char* directory;
+    char* schemaFile;
+    //Compiled once and shared by every worker
+    SchemaCacheEntry* schema;
+    //File names, sorted, and the JSON summary each worker writes for the file at the same index
+    char** names;
+    char** results;
+    int count;
+    //Index of the next file to summarize, taken under lock
+    int next;
+    pthread_mutex_t lock;
+} DirectoryScan;
+
+SVGimage* createSVGimageFromDoc(xmlDoc* document);
+void initSVGParser();
+void initLibraries();
+void cleanupSVGParser();
+
 //TODO: Condense ALL of the add* functions into one variadic function
-void addRectangle (xmlNode* node, List* list);
-void addCircle (xmlNode* node, List* list);
-void addPath (xmlNode* node, List* list);
-void addGroup (xmlNode* node, List* list);
-void getGroupsHelper (List* masterList, Group* groupRoot);
-Attribute* makeAttribute(xmlAttr* attrNode);
+void addRectangle (xmlNode* node, List* list, KeywordCache* names, StringPool* strings);
+void addCircle (xmlNode* node, List* list, KeywordCache* names, StringPool* strings);
+void addPath (xmlNode* node, List* list, KeywordCache* names, StringPool* strings);
+void addGroup (xmlNode* node, List* list, KeywordCache* names, StringPool* strings);
+Attribute* makeAttribute(xmlAttr* attrNode, KeywordCache* names, StringPool* strings);
+Attribute* newAttribute(const char* name, const char* value);
+Attribute* newAttributeIn(Arena* arena, const char* name, const char* value);
+Attribute* newInternedAttribute(Arena* arena, StringPool* strings, SVGKeyword keyword, const char* name, const char* value);
+const char* internName(StringPool* strings, SVGKeyword keyword, const char* name);
+List* initializeAttributeList(Arena* arena, StringPool* strings);
+void deleteInternedAttribute(void* data);
+char* shareString(Arena* arena, StringPool* strings, const char* string);
+bool isInternedList(const List* list);
+void setAttributeValue(List* list, StringPool* strings, Attribute* attribute, const char* value);
+void* allocateIn(Arena* arena, size_t size);
+char* copyStringIn(Arena* arena, const char* string);
+char* replaceString(Arena* arena, char* oldString, const char* newString);
+void insertAttribute(List* list, StringPool* strings, Attribute* attribute);
+void addShapeBounds(SVGimage* image, BoundingBox* box, List* rectangles, List* circles, List* paths);
+BoundingBox collectGroupBounds(SVGimage* image, Group* group, BoundingBox* boxes, int* next);
+BoundingBox getComponentBounds(SVGimage* image, elementType type, void* component);
+BoundingBox getCachedPathBounds(SVGimage* image, Path* path);
+bool isGeometryAttribute(elementType type, const char* name);
+void applyAttribute(SVGimage* image, elementType elemType, void* element, Attribute* newAttribute);
+RTree* getSpatialIndex(SVGimage* image);
+char* rtreeEntryToString(void* data);
+int compareRTreeEntries(const void* first, const void* second);
+int comparePointers(const void* first, const void* second);
+SVGimage* loadSVGimage(char* fileName, char* schemaFile, bool useArena);
+SVGimage* loadMappedSVGimage(MappedFile* input, char* fileName, char* schemaFile, SchemaCacheEntry* schema,
+                             const FileIdentity* identity, bool useArena);
+SVGimage* streamSVGimage(MappedFile* input, char* fileName, SchemaCacheEntry* schema, bool useArena);
+bool countMappedSVGcomponents(MappedFile* input, char* fileName, char* schemaFile, SchemaCacheEntry* schema,
+                              const FileIdentity* identity, ComponentCounts* counts);
+bool streamSVGcounts(MappedFile* input, char* fileName, SchemaCacheEntry* schema, ComponentCounts* counts);
+xmlTextReader* readerForMappedFile(MappedFile* input, char* fileName);
+bool validateMappedSVG(MappedFile* input, char* fileName, char* schemaFile);
+bool validLoadArguments(char* fileName, char* schemaFile);
+SVGimage* readSVGimage(xmlTextReader* reader, Arena* arena);
+bool readSVGcounts(xmlTextReader* reader, ComponentCounts* counts);
+void readAttributes(xmlTextReader* reader, List* list, KeywordCache* names, StringPool* strings);
+void readRectangle(xmlTextReader* reader, List* list, KeywordCache* names, StringPool* strings);
+void readCircle(xmlTextReader* reader, List* list, KeywordCache* names, StringPool* strings);
+void readPath(xmlTextReader* reader, List* list, KeywordCache* names, StringPool* strings);
+void readGroup(xmlTextReader* reader, List* list, KeywordCache* names, StringPool* strings);
+xmlChar* readFirstChildContent(xmlTextReader* reader);
 void dummy();
 xmlDoc* imageToXML(SVGimage* image);
+bool hasValidComponents(SVGimage* image);
+bool writeImageXML(xmlTextWriter* writer, SVGimage* image);
+bool writeIndentXML(xmlTextWriter* writer, int depth);
+bool writeTextElementXML(xmlTextWriter* writer, const char* name, const char* text, int depth);
+xmlChar* formatLength(char* buffer, float value, const char* units);
+bool writeAttributesXML(List* elementList, xmlTextWriter* writer);
+bool writeRectsXML(List* elementList, xmlTextWriter* writer, int depth);
+bool writeCirclesXML(List* elementList, xmlTextWriter* writer, int depth);
+bool writePathsXML(List* elementList, xmlTextWriter* writer, int depth);
+bool writeGroupsXML(List* elementList, xmlTextWriter* writer, int depth);
 bool validateRects (List* list);
 bool validateCircles (List* list);
 bool validatePaths (List* list);
 bool validateGroups (List* list);
 bool validateAttributes (List* list);
+bool validateComponent (elementType type, void* component);
 bool fileExists (char* fileName);
 int validateXMLwithXSD(xmlDoc* xml, char* xsdFile);
+SchemaCacheEntry* acquireSchema(char* xsdFile);
+void releaseSchema(SchemaCacheEntry* entry);
+void clearSchemaCache();
+void dropSchemaCacheEntry(void* data);
+void deleteSchemaCacheEntry(void* data);
+char* schemaCacheEntryToString(void* data);
+int compareSchemaCacheEntries(const void* first, const void* second);
+bool schemaCacheEntryHasPath(const void* first, const void* second);
 void addAttributesToXML(List* elementList, xmlNode* node);
 void addRectsToXML(List* elementList, xmlNode* docHead);
 void addCirclesToXML(List* elementList, xmlNode* docHead);
 void addPathsToXML(List* elementList, xmlNode* docHead);
 void addGroupsToXML(List* elementList, xmlNode* docHead);
-Attribute* existsInList(List* list, Attribute* attribute);
+Attribute* existsInList(List* list, StringPool* strings, const char* name);
+void* getComponentAt(SVGimage* image, elementType type, int index);
+Vector* getComponentView(SVGimage* image, elementType type);
+void deleteImageIndex(SVGindex* index);
+const ComponentViews* getComponentViews(SVGimage* image);
+void buildComponentViews(const SVGimage* image, ComponentViews* views);
+void freeComponentViews(ComponentViews* views);
+Vector* getComponentsOfType(const ComponentViews* views, elementType type);
+void collectGroups(Vector* groups, Group* root);
+void countImageComponents(const SVGimage* image, ComponentCounts* counts);
+void countGroupComponents(const Group* group, ComponentCounts* counts);
+unsigned long getImageVersion(const SVGimage* image);
+unsigned long getGroupVersion(const Group* group);
+List* flatViewToList(SVGimage* image, elementType type);
 
 bool createEmptySVG(char* filename);
 char* fileToJSON(char* filename, char* schema);
 bool validateFile (char* filename, char* schema);
 char* fullImageToJSON(char* filename, char* schema);
+char* componentQueryJSON(char* fileName, char* schemaFile, char* type, int offset, int limit, char* attributeName,
+                         char* attributeValue, char* area);
+char* componentPagesJSON(char* fileName, char* schemaFile, int limit, char* attributeName, char* attributeValue,
+                         char* area);
+bool makeComponentFilter(char* attributeName, char* attributeValue, char* area, ComponentFilter* filter);
+bool parseArea(const char* text, BoundingBox* area);
+char* cachedImageJSON(char* fileName, char* schemaFile, SchemaCacheEntry* schema, bool full);
+char* countsToJSON(const ComponentCounts* counts);
+char* directoryToJSON(char* directory, char* schema);
+char** listDirectoryFiles(char* directory, int* count);
+int compareFileNames(const void* first, const void* second);
+void* summarizeDirectoryFiles(void* data);
+char* fileSummaryJSON(DirectoryScan* scan, char* name);
+void writeJSONString(StringBuffer* out, const char* string);
+void writeJSONStringN(StringBuffer* out, const char* string, size_t length);
+bool SVGimageToFile(SVGimage* img, FILE* file);
+void writeSVGimageText(StringBuffer* out, SVGimage* img);
+void writeListText(StringBuffer* out, List* list, void (*writeElement)(StringBuffer* out, const void* data));
+void writeAttributeText(StringBuffer* out, const void* data);
+void writeRectangleText(StringBuffer* out, const void* data);
+void writeCircleText(StringBuffer* out, const void* data);
+void writePathText(StringBuffer* out, const void* data);
+void writeGroupText(StringBuffer* out, const void* data);
+void writeFullImageJSON(StringBuffer* out, SVGimage* image);
+char* listToJSON(const List* list, void (*writeElement)(StringBuffer* out, const void* data));
+void writeListJSON(StringBuffer* out, const List* list, void (*writeElement)(StringBuffer* out, const void* data));
+void writeComponentsJSON(StringBuffer* out, SVGimage* image, elementType type, void (*writeElement)(StringBuffer* out, const void* data));
+bool componentMatches(SVGimage* image, elementType type, void* component, const BoundingBox* groupBounds,
+                      const ComponentFilter* filter, void** inArea, int numInArea);
+List* getComponentAttributes(elementType type, void* component);
+void writeAttrJSON(StringBuffer* out, const void* data);
+void writeCircleJSON(StringBuffer* out, const void* data);
+void writeRectJSON(StringBuffer* out, const void* data);
+void writePathJSON(StringBuffer* out, const void* data);
+void writeGroupJSON(StringBuffer* out, const void* data);
 bool saveTitle(char* filename, char* schema, char* newTitle);
 bool saveDesc(char* filename, char* schema, char* newDesc);
+bool saveMetadata(char* fileName, char* schemaFile, char* title, char* description);
+void copyMetadataText(char* field, const char* text);
 
 #endif
@@ -0,0 +1,83 @@
+/**
+ * @file Keywords.h
+ * @brief Perfect hash table of SVG element and attribute names. A name is looked up with one multiply of a few of its
+ * characters and one memcmp, so the parsers can dispatch on a switch instead of a chain of strcmp calls. Names that
+ * libxml2 has interned can go through a KeywordCache instead, which finds a name it has seen before by its address.
+ */
+
+#ifndef _KEYWORDS_API_
+#define _KEYWORDS_API_
+
+#include <stddef.h>
+
+/**
+ * Every name in the table. Element and attribute names share it, a name used as both (style, mask) has one keyword.
+ **/
+typedef enum svgKeyword{
+    KEYWORD_UNKNOWN,
+    //Elements
+    KEYWORD_SVG, KEYWORD_G, KEYWORD_RECT, KEYWORD_CIRCLE, KEYWORD_ELLIPSE, KEYWORD_LINE, KEYWORD_POLYLINE,
+    KEYWORD_POLYGON, KEYWORD_PATH, KEYWORD_TEXT, KEYWORD_TSPAN, KEYWORD_TITLE, KEYWORD_DESC, KEYWORD_DEFS,
+    KEYWORD_USE, KEYWORD_IMAGE, KEYWORD_SYMBOL, KEYWORD_STYLE, KEYWORD_CLIPPATH, KEYWORD_MASK,
+    KEYWORD_LINEARGRADIENT, KEYWORD_RADIALGRADIENT, KEYWORD_STOP, KEYWORD_PATTERN, KEYWORD_MARKER, KEYWORD_A,
+    KEYWORD_METADATA,
+    //Geometry and presentation attributes
+    KEYWORD_X, KEYWORD_Y, KEYWORD_WIDTH, KEYWORD_HEIGHT, KEYWORD_CX, KEYWORD_CY, KEYWORD_R, KEYWORD_RX, KEYWORD_RY,
+    KEYWORD_D, KEYWORD_X1, KEYWORD_Y1, KEYWORD_X2, KEYWORD_Y2, KEYWORD_POINTS, KEYWORD_FILL, KEYWORD_FILL_OPACITY,
+    KEYWORD_FILL_RULE, KEYWORD_STROKE, KEYWORD_STROKE_WIDTH, KEYWORD_STROKE_OPACITY, KEYWORD_STROKE_LINECAP,
+    KEYWORD_STROKE_LINEJOIN, KEYWORD_STROKE_DASHARRAY, KEYWORD_STROKE_MITERLIMIT, KEYWORD_OPACITY,
+    KEYWORD_TRANSFORM, KEYWORD_ID, KEYWORD_CLASS, KEYWORD_VIEWBOX, KEYWORD_VERSION, KEYWORD_FONT_SIZE,
+    KEYWORD_FONT_FAMILY, KEYWORD_FONT_WEIGHT, KEYWORD_TEXT_ANCHOR, KEYWORD_VISIBILITY, KEYWORD_DISPLAY,
+    KEYWORD_COLOR, KEYWORD_CLIP_PATH, KEYWORD_FILTER, KEYWORD_OFFSET, KEYWORD_STOP_COLOR,
+    KEYWORD_PRESERVEASPECTRATIO,
+    NUM_KEYWORDS
+} SVGKeyword;
+
+//A KeywordCache remembers 2^KEYWORD_CACHE_BITS names
+#define KEYWORD_CACHE_BITS 6
+#define KEYWORD_CACHE_SIZE (1 << KEYWORD_CACHE_BITS)
+
+/**
+ * Remembers the keyword of each name string it has been asked about, by address. Only valid while those strings stay
+ * where they are, e.g. for the names of one libxml2 dictionary while a single document is parsed. A document only
+ * uses a few distinct names, so after the first few elements each lookup is one pointer compare.
+ **/
+typedef struct keywordCache{
+    const char* names[KEYWORD_CACHE_SIZE];
+    unsigned char keywords[KEYWORD_CACHE_SIZE];
+} KeywordCache;
+
+
+/** Function to look up a null terminated name.
+ *@return The name's keyword, or KEYWORD_UNKNOWN if it is not in the table or is NULL. Matching is case sensitive
+ *@param name - the name to look up
+ **/
+SVGKeyword lookupKeyword(const char* name);
+
+/** Function to look up a name that is not null terminated.
+ *@return As lookupKeyword
+ *@param name - the name to look up
+ *@param length - number of characters in name
+ **/
+SVGKeyword lookupKeywordN(const char* name, size_t length);
+
+/** Function to empty a cache before use.
+ *@param cache - the cache
+ **/
+void initKeywordCache(KeywordCache* cache);
+
+/** Function to look up a name through a cache, falling back to lookupKeyword for names it has not seen.
+ *@pre cache was emptied with initKeywordCache, and every name given to it since is still at the same address
+ *@return As lookupKeyword
+ *@param cache - the cache
+ *@param name - the name to look up
+ **/
+SVGKeyword lookupCachedKeyword(KeywordCache* cache, const char* name);
+
+/** Function to get the text of a keyword.
+ *@return A static string that must not be freed, or NULL for KEYWORD_UNKNOWN and values out of range
+ *@param keyword - the keyword
+ **/
+const char* keywordName(SVGKeyword keyword);
+
+#endif
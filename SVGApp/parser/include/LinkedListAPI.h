@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <assert.h>
+#include "Arena.h"
 
 /**
  * Node of a linked list. This list is doubly linked, meaning that it has points to both the node immediately in front 
@@ -37,6 +38,12 @@ typedef struct listHead{
     void (*deleteData)(void* toBeDeleted);
     int (*compare)(const void* first,const void* second);
     char* (*printData)(void* toBePrinted);
+    //Arena the list's nodes are allocated from, or NULL if they are on the heap. The data in an arena list is owned
+    //by the arena too, so freeing or clearing the list does not call deleteData.
+    Arena* arena;
+    //Changes on every insert, delete or clear, so anything built from the list can tell when it is out of date.
+    //Values come from one counter shared by all lists, so a new list never repeats the version of an old one.
+    unsigned long version;
 } List;
 
 
@@ -64,6 +71,19 @@ List* initializeList(char* (*printFunction)(void* toBePrinted),void (*deleteFunc
 
 
 
+/** Function to initialize a list whose List struct and nodes are allocated from an arena.
+ * The list and everything in it is released by freeArena, so freeList and clearList do not free anything.
+*@pre function pointer arguments must not be NULL
+*@return On success returns newly allocated List struct. Returns NULL if any of the arguments are invalid
+*@param printFunction - function pointer to print a single node of the list
+*@param deleteFunction - function pointer to delete a single piece of data from the list
+*@param compareFunction - function pointer to compare two nodes of the list in order to test for equality or order
+*@param arena - arena to allocate from. If NULL, this is the same as initializeList
+**/
+List* initializeListInArena(char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second), Arena* arena);
+
+
+
 /**Function for creating a node for the linked list. 
 * This node contains abstracted (void *) data as well as previous and next
 * pointers to connect to other nodes in the list
@@ -77,6 +97,15 @@ Node* initializeNode(void* data);
 
 
 
+/**Function for creating a node that belongs to a list, allocated from the list's arena if it has one.
+*@return On success returns a node that can be added to the list. On failure, returns NULL.
+*@param list - the list the node will be added to
+*@param data - is a void * pointer to any data type.
+**/
+Node* initializeListNode(List* list, void* data);
+
+
+
 /**Inserts a Node at the front of a linked list.  List metadata is updated
 * so that head and tail pointers are correct.
 *@pre 'List' type must exist and be used in order to keep track of the linked list.
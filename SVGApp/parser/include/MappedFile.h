@@ -0,0 +1,41 @@
+/**
+ * @file MappedFile.h
+ * @brief Read only view of a whole file, mapped into memory once so that hashing, parsing and validating it all read
+ * the same bytes without copying them or opening the file again.
+ */
+
+#ifndef _MAPPED_FILE_API_
+#define _MAPPED_FILE_API_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * A file's contents, and the details of the file they were read from.
+ **/
+typedef struct mappedFile{
+    //The contents. Not null terminated.
+    const char* data;
+    size_t size;
+    //Modification time of the file that was opened, which may since have been replaced
+    long long mtimeSec;
+    long mtimeNsec;
+    //True if data is a mapping. Files that cannot be mapped are read into memory instead.
+    bool mapped;
+} MappedFile;
+
+
+/** Function to open a regular file and map its contents.
+ *@return On success the newly allocated MappedFile. NULL if the file does not exist, is not a regular file, or could
+ *        not be read
+ *@param path - the file to open
+ **/
+MappedFile* openMappedFile(const char* path);
+
+/** Function to unmap a file and free the MappedFile.
+ *@post file->data is invalid
+ *@param file - the file to close. May be NULL
+ **/
+void closeMappedFile(MappedFile* file);
+
+#endif
@@ -0,0 +1,52 @@
+/**
+ * @file MetadataPatch.h
+ * @brief Edits the title and description of an SVG file by copying its bytes and replacing only the root's <title>
+ * and <desc> elements, instead of parsing the file into an SVGimage and writing the whole document back out.
+ * Everything else in the file, including its formatting, comments and unknown elements, is kept as it was.
+ */
+
+#ifndef _METADATA_PATCH_API_
+#define _METADATA_PATCH_API_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+//Most bytes of a title or description that are kept, as the parser keeps in SVGimage's 256 char fields
+#define METADATA_TEXT_LIMIT 255
+
+/** Function to find how much of a title or description is kept: at most METADATA_TEXT_LIMIT bytes, shortened further
+ * so that a UTF-8 character is not split.
+ *@return The number of bytes kept
+ *@param text - the title or description
+ **/
+size_t metadataTextLength(const char* text);
+
+/** Function to write a copy of an SVG document with new title and description elements. The first <title> child of
+ * the root is given the new text and any later ones are removed, or one is added as the root's first child. An empty
+ * string removes the element, like writeSVGimage which omits empty ones. <desc> is handled the same way, and added
+ * after the title. New text longer than metadataTextLength allows is truncated, so the file holds what the parser
+ * would keep of it.
+ *@pre data is a well formed SVG document
+ *@return True if the copy was written. False if the document could not be patched, e.g. it is not UTF-8, its markup
+ *        could not be followed, or a new string is not valid XML text, or if writing failed
+ *@param out - where to write the copy
+ *@param data - the document
+ *@param size - number of bytes in data
+ *@param title - the new title, or NULL to leave it as it is
+ *@param description - the new description, or NULL to leave it as it is
+ **/
+bool writePatchedSVG(FILE* out, const char* data, size_t size, const char* title, const char* description);
+
+/** Function to patch an SVG file as writePatchedSVG does, replacing it with an atomic rename so readers see either the
+ * old or the new file. The new file keeps the old one's permissions.
+ *@return True if the file was replaced. False if it was left unchanged
+ *@param path - the file to replace
+ *@param data - the file's current contents, e.g. from a MappedFile
+ *@param size - number of bytes in data
+ *@param title - as writePatchedSVG
+ *@param description - as writePatchedSVG
+ **/
+bool patchSVGfile(const char* path, const char* data, size_t size, const char* title, const char* description);
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file NumberFormat.h
+ * @brief Locale independent formatting of SVG numbers, the counterpart of NumberParser.h. By default a float is written
+ * with the fewest digits that parseSVGNumber reads back as exactly the same float, found with the Ryu algorithm rather
+ * than by trying printf precisions in turn. Numbers are written like JavaScript writes them: without an exponent
+ * unless they are very large or very small, and without trailing zeros.
+ */
+
+#ifndef _NUMBER_FORMAT_API_
+#define _NUMBER_FORMAT_API_
+
+//Size of a buffer that holds any number formatNumber writes, with its terminator
+#define NUMBER_FORMAT_SIZE 32
+//Precision for formatNumber that writes every digit needed to read the same float back, and no more
+#define NUMBER_SHORTEST -1
+
+/** Function to write a float as text.
+ *@pre buffer holds at least NUMBER_FORMAT_SIZE chars
+ *@post buffer holds the null terminated text. Infinities are written as the largest float and NaN as 0, since SVG
+ *      and JSON can hold neither
+ *@return The length of the text
+ *@param buffer - where to write the text
+ *@param value - the number to write
+ *@param precision - NUMBER_SHORTEST, or the most digits to keep after the decimal point. The shortest text is then
+ *                   rounded half away from zero, so 1.005 gives "1.01" with a precision of 2
+ **/
+int formatNumber(char* buffer, float value, int precision);
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file NumberParser.h
+ * @brief Locale independent parsing of SVG numbers and lengths. Most numbers in a drawing have few enough digits to be
+ * converted exactly with one double multiply or divide. The rest fall back to strtof in the C locale, so every result
+ * is the correctly rounded float that strtof would give for the same text in the C locale.
+ */
+
+#ifndef _NUMBER_PARSER_API_
+#define _NUMBER_PARSER_API_
+
+#include <stddef.h>
+
+/** Function to parse a number: optional leading whitespace, an optional sign, digits with an optional decimal point,
+ * and an optional exponent. Unlike strtof, the decimal point is always '.', and hex, infinity and nan are not accepted.
+ *@return The value, or 0 if string does not start with a number. Out of range values give what strtof gives
+ *@param string - the text to parse
+ *@param end - set to the first character after the number, or to string if there is none. May be NULL
+ **/
+float parseSVGNumber(const char* string, char** end);
+
+/** Function to parse a length, a number followed by its units, e.g. "12.5px".
+ *@return The number, as parseSVGNumber
+ *@param string - the text to parse
+ *@param units - set to the text after the number, truncated to fit and null terminated. May be NULL
+ *@param size - size of the units buffer
+ **/
+float parseSVGLength(const char* string, char* units, size_t size);
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file PathGeometry.h
+ * @brief Parsed form of an SVG path's d attribute. Commands are kept in a byte array and numbers and points in
+ * contiguous float arrays, so geometry code can work on a path without re-tokenizing its string.
+ */
+
+#ifndef _PATH_GEOMETRY_API_
+#define _PATH_GEOMETRY_API_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "Arena.h"
+#include "BoundingBox.h"
+
+/**
+ * A tokenized path. Implicit repeated commands are expanded, so "M0 0 10 10" holds the commands M and L.
+ * Parsing stops at the first error, as SVG renderers do, so only the valid prefix of a bad d is kept and errorOffset
+ * says where it stopped.
+ **/
+typedef struct pathGeometry{
+    //One byte per command, the letter as written (e.g. 'M', 'l', 'Z')
+    unsigned char* commands;
+    int numCommands;
+
+    //Every number in the path in order. Each command uses pathCommandArgCount(command) of them.
+    float* args;
+    int numArgs;
+
+    //Absolute end and control points of every command, as separate x and y arrays. S and T add the control point
+    //they reflect from the previous command too. Arcs add their end point only.
+    float* x;
+    float* y;
+    int numPoints;
+
+    //Box containing the whole path: its points, and the full extent of any arcs. Bezier curves are bounded by
+    //their control points, which always contain the curve.
+    BoundingBox bounds;
+
+    //Offset in the d string of the first malformed command or number, or -1 if all of it was parsed
+    long errorOffset;
+} PathGeometry;
+
+/**
+ * A geometry cached for one path, and the length and hash of the d string it was parsed from.
+ **/
+typedef struct {
+    //The path the geometry belongs to, or NULL for an empty slot
+    const void* owner;
+    PathGeometry* geometry;
+    size_t length;
+    uint64_t hash;
+} PathGeometryEntry;
+
+/**
+ * Parsed geometry of a set of paths, looked up by path. An entry is only used while the path's d string still
+ * hashes to what it was parsed from, so changing the string never gives back stale geometry. The table is open
+ * addressed and kept at most half full.
+ **/
+typedef struct pathGeometryCache{
+    PathGeometryEntry* entries;
+    size_t capacity;
+    size_t count;
+} PathGeometryCache;
+
+
+/** Parses path data into a PathGeometry.
+ *@pre data is not NULL
+ *@return The geometry, allocated from arena when it is not NULL or from the heap otherwise. NULL if malloc fails
+ *@param data - the path's d string
+ *@param arena - arena to allocate from, or NULL for the heap
+ **/
+PathGeometry* parsePathGeometry(const char* data, Arena* arena);
+
+/** Number of arguments a path command takes.
+ *@return The argument count, or -1 if command is not a path command letter
+ *@param command - the command letter
+ **/
+int pathCommandArgCount(unsigned char command);
+
+/** Recomputes a geometry's absolute points and bounds from its commands and args, e.g. after args were edited.
+ *@pre geometry is not NULL
+ *@param geometry - the geometry to update
+ **/
+void computePathPoints(PathGeometry* geometry);
+
+/** Writes a geometry back out as path data.
+ *@pre geometry is not NULL
+ *@return A heap allocated d string, which the caller frees
+ *@param geometry - the geometry to write
+ **/
+char* pathGeometryToString(const PathGeometry* geometry);
+
+/** Frees a heap allocated geometry. Geometry from an arena is released with the arena instead.
+ *@param geometry - the geometry to free. May be NULL
+ **/
+void deletePathGeometry(PathGeometry* geometry);
+
+/** Creates an empty geometry cache.
+ *@return The new cache, or NULL if malloc fails
+ **/
+PathGeometryCache* createPathGeometryCache(void);
+
+/** Gets the cached geometry of a path, parsing its data if it has none or the data changed since it was parsed.
+ *@pre cache, owner and data are not NULL
+ *@return The geometry, owned by the cache. NULL if malloc fails
+ *@param cache - the cache
+ *@param owner - the path the geometry belongs to
+ *@param data - the path's d string
+ **/
+PathGeometry* getCachedPathGeometry(PathGeometryCache* cache, const void* owner, const char* data);
+
+/** Records that a path's d string was regenerated from its cached geometry, so the geometry stays in use.
+ *@pre data was written from owner's geometry with pathGeometryToString
+ *@param cache - the cache
+ *@param owner - the path
+ *@param data - the path's new d string
+ **/
+void updateCachedPathData(PathGeometryCache* cache, const void* owner, const char* data);
+
+/** Frees a cache and every geometry in it.
+ *@param cache - the cache to free. May be NULL
+ **/
+void freePathGeometryCache(PathGeometryCache* cache);
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file RTree.h
+ * @brief Spatial index over bounding boxes, bulk loaded with Sort-Tile-Recursive packing. Queries find every entry
+ * whose box meets a point or an area without scanning all of them. Later inserts and moves go to a small overflow
+ * list that queries also scan, and the tree is repacked once that list grows past a fraction of the tree.
+ */
+
+#ifndef _RTREE_API_
+#define _RTREE_API_
+
+#include <stdbool.h>
+#include "BoundingBox.h"
+#include "VectorAPI.h"
+
+/**
+ * One indexed item. type and data are the caller's, e.g. an elementType and the component.
+ **/
+typedef struct rtreeEntry{
+    BoundingBox bounds;
+    int type;
+    void* data;
+    //Set when the item has moved and a newer entry replaces this one. Stale entries are skipped by queries.
+    bool stale;
+} RTreeEntry;
+
+/**
+ * A tree node. Its children are count consecutive nodes, or entries for a leaf, starting at first.
+ **/
+typedef struct rtreeNode{
+    BoundingBox bounds;
+    int first;
+    int count;
+    bool leaf;
+} RTreeNode;
+
+/**
+ * Metadata head of the tree.
+ **/
+typedef struct rtree{
+    //entries[0, numPacked) are in the tree, the rest are the overflow list
+    RTreeEntry* entries;
+    int numEntries;
+    int capacity;
+    int numPacked;
+    int numStale;
+
+    //Nodes in level order, children before parents. The root is the last node. Empty when numPacked is 0.
+    RTreeNode* nodes;
+    int numNodes;
+
+    //Open addressing table from data pointer to the index of its current entry
+    void** keys;
+    int* slots;
+    int tableSize;
+} RTree;
+
+
+/** Function to bulk load a tree.
+ *@return On success the newly allocated RTree. NULL if malloc fails
+ *@param entries - the items to index. They are copied. May be NULL if count is 0
+ *@param count - number of entries. Each data pointer must appear once
+ **/
+RTree* createRTree(const RTreeEntry* entries, int count);
+
+/** Adds an item to the tree.
+ *@pre tree is not NULL and data is not already in the tree
+ *@param tree - the tree
+ *@param type - the caller's type tag for the item
+ *@param data - the item
+ *@param bounds - the item's box
+ **/
+void rtreeInsert(RTree* tree, int type, void* data, BoundingBox bounds);
+
+/** Moves an item that is already in the tree. Items that are not in the tree are ignored.
+ *@pre tree is not NULL
+ *@param tree - the tree
+ *@param data - the item
+ *@param bounds - the item's new box
+ **/
+void rtreeUpdate(RTree* tree, void* data, BoundingBox bounds);
+
+/** Finds every item whose box intersects an area, edges included.
+ *@pre tree and results are not NULL
+ *@post Pointers to the matching RTreeEntry structs are appended to results. They belong to the tree and stay valid
+        until it is next changed
+ *@param tree - the tree
+ *@param area - the area to search
+ *@param results - vector to append the matches to
+ **/
+void rtreeSearch(RTree* tree, BoundingBox area, Vector* results);
+
+/** Finds every item whose box contains a point, edges included.
+ *@pre tree and results are not NULL
+ *@post As rtreeSearch
+ *@param tree - the tree
+ *@param x - the point's x coordinate
+ *@param y - the point's y coordinate
+ *@param results - vector to append the matches to
+ **/
+void rtreeSearchPoint(RTree* tree, float x, float y, Vector* results);
+
+/** Frees the tree. The items it indexes are not freed.
+ *@param tree - the tree to free. May be NULL
+ **/
+void freeRTree(RTree* tree);
+
+#endif
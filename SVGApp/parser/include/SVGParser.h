@@ -8,6 +8,9 @@
 #include <libxml/xmlwriter.h>
 #include <libxml/xmlschemastypes.h>
 #include "LinkedListAPI.h"
+#include "PathGeometry.h"
+#include "BoundingBox.h"
+#include "RTree.h"
 
 typedef enum COMP{
     SVG_IMAGE, CIRC, RECT, PATH, GROUP
@@ -16,6 +19,8 @@ typedef enum COMP{
 //Represents a generic SVG element/XML node Attribute
 typedef struct  {
     //Attribute name.  Must not be NULL
+    //In an image on the heap each attribute owns its strings, which may be freed and replaced. In an arena backed
+    //image (see createSVGimageInArena) they belong to the image and may be shared, so change them with setAttribute.
 	char* 	name;
     //Attribute value.  Must not be NULL
 	char*	value; 
@@ -119,8 +124,32 @@ typedef struct {
     //All objects in the list will be of type Attribute.  It must not be NULL.  It may be empty.  
     //Do not put the namespace here, since it already has its own field
     List* otherAttributes;
+
+    //Arena that the image and all of its components are allocated from, or NULL if they are individually allocated
+    //on the heap. See createSVGimageInArena.
+    Arena* arena;
+
+    //One copy of each distinct attribute name and value the image was loaded with, shared by the attributes that use
+    //them. Only arena backed images have one; it is NULL otherwise. It does not grow after loading. Owned by the image.
+    struct stringPool* strings;
+
+    //Lookup structures built from the lists above on demand, by the get*, num* and JSON functions, setAttribute,
+    //addComponent and the bounds and area queries. Building them writes to the image, so threads sharing an image must
+    //not call any of those at the same time. May be NULL. Owned by the image.
+    struct svgIndex* index;
 } SVGimage;
 
+//Conditions on the components componentPageToJSON exports. A component is exported if it meets every one that is set.
+typedef struct {
+    //Name of an attribute the component must have in its otherAttributes, or NULL for any component
+    const char* attributeName;
+    //Value that attribute must have, or NULL for any value
+    const char* attributeValue;
+    //If hasArea is set, the component's bounding box must intersect area
+    BoundingBox area;
+    bool hasArea;
+} ComponentFilter;
+
 //A1
 
 /* Public API - main */
@@ -137,6 +166,21 @@ typedef struct {
 **/
 SVGimage* createSVGimage(char* fileName);
 
+/** Function to create an SVG object whose memory all comes from one arena, based on the contents of an SVG file.
+ * The image is used the same way as one from createSVGimage, but loads with far fewer allocations and
+ * deleteSVGimage releases it all at once. Its attributes also share one copy of each distinct name and value, which
+ * images on the heap do not, so it is the cheaper choice for images that are only read.
+ *@pre File name cannot be an empty string or NULL.
+       File represented by this name must exist and must be readable.
+ *@post Either:
+        A valid SVGimage has been created and its address was returned
+		or 
+		An error occurred, and NULL was returned
+ *@return the pinter to the new struct or NULL
+ *@param fileName - a string containing the name of the SVG file
+**/
+SVGimage* createSVGimageInArena(char* fileName);
+
 /** Function to create a string representation of an SVG object.
  *@pre SVGimgage exists, is not null, and is valid
  *@post SVGimgage has not been modified in any way, and a string representing the SVG contents has been created
@@ -232,11 +276,22 @@ bool validateSVGimage(SVGimage* image, char* schemaFile);
         A valid SVGimage has been created and its address was returned
 		or 
 		An error occurred, or SVG file was invalid, and NULL was returned
+        The image is allocated on the heap, like one from createSVGimage. A snapshot of it is saved beside the file,
+        which createValidSVGimageInArena maps back while the file and schema are unchanged (see Snapshot.h)
  *@return the pinter to the new struct or NULL
  *@param fileName - a string containing the name of the SVG file
 **/
 SVGimage* createValidSVGimage(char* fileName, char* schemaFile);
 
+/** Function to create an arena backed SVG object, see createSVGimageInArena, from a file that is valid
+ * against a SVG schema file. While the file and schema are unchanged since a snapshot was saved, the image is mapped
+ * back from the snapshot without parsing or validating.
+ *@return the pinter to the new struct or NULL
+ *@param fileName - a string containing the name of the SVG file
+ *@param schemaFile - the name of a schema file
+**/
+SVGimage* createValidSVGimageInArena(char* fileName, char* schemaFile);
+
 /** Function to writing a SVGimage into a file in SVG format.
  *@pre
     SVGimage object exists, is valid, and and is not NULL.
@@ -250,6 +305,37 @@ SVGimage* createValidSVGimage(char* fileName, char* schemaFile);
  **/
 bool writeSVGimage(SVGimage* image, char* fileName);
 
+/** Function to write a SVGimage into a file in SVG format, optionally gzip compressed. Like writeSVGimage, the image
+ * is streamed to the file as it is serialized, without building an XML tree of it first
+ *@pre
+    SVGimage object exists, is valid, and and is not NULL.
+    fileName is not NULL, and has a .svg or .svgz extension
+ *@post SVGimage has not been modified in any way, and the file has been created
+ *@return a boolean value indicating success or failure of the write
+ *@param
+    image - a pointer to a SVGimage struct
+    fileName - the name of the output file
+    compression - the gzip compression level, 1 to 9, or 0 for plain text
+ **/
+bool writeSVGimageCompressed(SVGimage* image, char* fileName, int compression);
+
+/** Function to write a SVGimage in SVG format to an open file descriptor, e.g. a socket or pipe
+ *@pre SVGimage object exists, is valid, and and is not NULL.
+ *@post SVGimage has not been modified in any way, and fd is still open
+ *@return a boolean value indicating success or failure of the write
+ *@param
+    image - a pointer to a SVGimage struct
+    fd - the file descriptor to write to
+ **/
+bool writeSVGimageToFd(SVGimage* image, int fd);
+
+/** Function to get the SVG document writeSVGimage would write for a SVGimage
+ *@pre SVGimage object exists, is valid, and and is not NULL.
+ *@return a newly allocated string holding the document, or NULL if the image is not valid
+ *@param image - a pointer to a SVGimage struct
+ **/
+char* SVGimageToXMLString(SVGimage* image);
+
 /** Function to setting an attribute in an SVGimage or component
  *@pre
     SVGimage object exists, is valid, and and is not NULL.
@@ -277,6 +363,110 @@ void setAttribute(SVGimage* image, elementType elemType, int elemIndex, Attribut
  **/
 void addComponent(SVGimage* image, elementType type, void* newElement);
 
+/** Function to get the parsed form of a path's data, parsing it on first use. errorOffset in the result says whether
+    the whole of data was valid
+ *@pre image and path are not NULL, and path is in image
+ *@post The geometry is cached in the image. It is parsed again if path->data changes
+ *@return the path's geometry, owned by the image. It is valid until path->data changes or the image is freed. NULL if
+          memory could not be allocated
+ *@param image - a pointer to the SVGimage struct the path is in
+ *@param path - a pointer to a Path struct
+ **/
+PathGeometry* getPathGeometry(SVGimage* image, Path* path);
+
+/** Function to record that a path's geometry args were edited in place
+ *@pre image and path are not NULL, and the geometry was edited through getPathGeometry(image, path)
+ *@post The geometry's points are recomputed, path->data is regenerated from it, and the image's cached bounds and
+        spatial index are updated
+ *@return N/A
+ *@param image - a pointer to the SVGimage struct the path is in
+ *@param path - a pointer to a Path struct
+ **/
+void pathGeometryChanged(SVGimage* image, Path* path);
+
+/** Function to get the box containing a rectangle. Units are ignored
+ *@pre rect is not NULL
+ *@return the rectangle's bounding box
+ *@param rect - a pointer to a Rectangle struct
+ **/
+BoundingBox getRectBounds(const Rectangle* rect);
+
+/** Function to get the box containing a circle. Units are ignored
+ *@pre circle is not NULL
+ *@return the circle's bounding box
+ *@param circle - a pointer to a Circle struct
+ **/
+BoundingBox getCircleBounds(const Circle* circle);
+
+/** Function to get the box containing a path. Its data is parsed on every call, getImageBounds and the area queries
+    use the geometry cached in the image instead
+ *@pre path is not NULL
+ *@return the path's bounding box. Empty if the path has no drawable data
+ *@param path - a pointer to a Path struct
+ **/
+BoundingBox getPathBounds(Path* path);
+
+/** Function to get the box containing everything in a group, including nested groups
+ *@pre group is not NULL
+ *@return the group's bounding box. Empty if the group has no shapes
+ *@param group - a pointer to a Group struct
+ **/
+BoundingBox getGroupBounds(Group* group);
+
+/** Function to get the box containing every shape in an image, including those in groups
+ *@pre image is not NULL
+ *@post The result is cached on the image. setAttribute and addComponent keep it up to date, and it is recomputed
+        after other changes to the image's lists
+ *@return the image's bounding box. Empty if the image has no shapes
+ *@param image - a pointer to an SVGimage struct
+ **/
+BoundingBox getImageBounds(SVGimage* image);
+
+/** Function to drop an image's cached bounding box, after its shapes were changed other than through
+    setAttribute, addComponent and pathGeometryChanged (e.g. a rectangle's x assigned directly)
+ *@pre image is not NULL
+ *@post The image's box is recomputed on next use
+ *@return N/A
+ *@param image - a pointer to an SVGimage struct
+ **/
+void invalidateBounds(SVGimage* image);
+
+/** Function to find the shapes whose bounding boxes intersect an area, through a spatial index of the image
+ *@pre image is not NULL
+ *@post The image's spatial index has been built if it did not exist. addComponent and setAttribute keep it current,
+        and it is rebuilt after other changes to the image's lists
+ *@return a new Vector of RTreeEntry pointers, giving each shape's type, pointer and box. The entries belong to the image
+          and are valid until it is next changed. Free the Vector with freeVector
+ *@param image - a pointer to an SVGimage struct
+ *@param area - the area to search
+ **/
+Vector* getComponentsInArea(SVGimage* image, BoundingBox area);
+
+/** Function to find the shapes whose bounding boxes contain a point, through a spatial index of the image
+ *@pre image is not NULL
+ *@post As getComponentsInArea
+ *@return As getComponentsInArea
+ *@param image - a pointer to an SVGimage struct
+ *@param x - the point's x coordinate
+ *@param y - the point's y coordinate
+ **/
+Vector* getComponentsAtPoint(SVGimage* image, float x, float y);
+
+/** Function to export one page of an image's components of a type as JSON, for callers that cannot take every
+    component at once. Area filters are answered through the spatial index
+ *@pre image is not NULL
+ *@return a newly allocated JSON object shaped like fullImageToJSON's, with the title, the description and an array
+          named as in fullImageToJSON holding only the page's components. "total" is how many components of the type
+          pass the filter, "offset" is the page's first position among them and "indices" gives each component's
+          index in fullImageToJSON's array. NULL if type is not RECT, CIRC, PATH or GROUP
+ *@param image - a pointer to an SVGimage struct
+ *@param type - RECT, CIRC, PATH or GROUP. Nested components are included, in the order getRects etc. return them
+ *@param offset - how many components that pass the filter to skip
+ *@param limit - the most components to export
+ *@param filter - the conditions components must meet, or NULL to export all of them
+ **/
+char* componentPageToJSON(SVGimage* image, elementType type, int offset, int limit, const ComponentFilter* filter);
+
 /** Function to converting an Attribute into a JSON string
 *@pre Attribute is not NULL
 *@post Attribute has not been modified in any way
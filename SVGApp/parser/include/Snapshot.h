@@ -0,0 +1,85 @@
+/**
+ * @file Snapshot.h
+ * @brief Binary snapshots of an SVGimage, kept beside the file in its .svgcache directory. A snapshot is the image's
+ * structs and strings laid out as they are in memory, with pointers stored as offsets. Loading one maps the file,
+ * turns the offsets back into pointers in place, and returns an arena image that lives in the mapping, so no XML is
+ * parsed, no schema is checked, and nothing is allocated per element. A snapshot is only used while the file and
+ * schema identity it was written for still match, and only on a machine with the same struct layout.
+ */
+
+#ifndef _SNAPSHOT_API_
+#define _SNAPSHOT_API_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "SummaryCache.h"
+#include "SVGParser.h"
+
+//Bumped whenever the layout of the snapshot or of a struct in it changes
+#define SNAPSHOT_VERSION 1
+
+//What the items of a list are, so the list's functions can be set again after loading
+typedef enum snapshotListKind{
+    SNAPSHOT_RECTANGLES, SNAPSHOT_CIRCLES, SNAPSHOT_PATHS, SNAPSHOT_GROUPS, SNAPSHOT_ATTRIBUTES, SNAPSHOT_LIST_KINDS
+} SnapshotListKind;
+
+/**
+ * Start of a snapshot file. All offsets are from the start of the file, and every table is an array of uint64_t.
+ * The structs come first, then the strings, then the tables.
+ **/
+typedef struct snapshotHeader{
+    char magic[8];
+    uint32_t version;
+    //SNAPSHOT_BYTE_ORDER as written, to reject files from a machine with the other byte order
+    uint32_t byteOrder;
+    //Sizes of the pointer and struct types in the snapshot, to reject files from a different layout
+    uint32_t pointerSize, imageSize, listSize, nodeSize, rectangleSize, circleSize, pathSize, groupSize, attributeSize;
+    //Identity of the file and schema the image was loaded from
+    FileIdentity identity;
+    uint64_t fileSize;
+    //The SVGimage
+    uint64_t image;
+    //Null terminated attribute names and values, each distinct string once
+    uint64_t strings, stringsSize;
+    //Offsets of pointer fields that hold the offset of what they point to
+    uint64_t pointers, pointerCount;
+    //Offsets of attribute fields that hold the offset of their string in the string region
+    uint64_t stringFields, stringFieldCount;
+    //Offsets of attribute name fields that hold an SVGKeyword, to point at the keyword table's string
+    uint64_t keywordFields, keywordFieldCount;
+    //Pairs of a List's offset and its SnapshotListKind
+    uint64_t lists, listCount;
+} SnapshotHeader;
+
+
+/** Function to write a snapshot of an image, replacing any older snapshot of the same file.
+ *@pre image is a valid image
+ *@return True if the snapshot was written. Failures leave the cache as it was
+ *@param image - the image to save
+ *@param fileName - the file the image was loaded from
+ *@param identity - the file's identity when it was loaded, see getFileIdentity
+ **/
+bool saveSVGsnapshot(const SVGimage* image, const char* fileName, const FileIdentity* identity);
+
+/** Function to map an image back from its snapshot.
+ *@return An arena backed image, freed with deleteSVGimage like any other. NULL if there is no snapshot, or it does
+ *        not match identity or this build's layout
+ *@param fileName - the file the image was loaded from
+ *@param identity - the file's current identity
+ **/
+SVGimage* loadSVGsnapshot(const char* fileName, const FileIdentity* identity);
+
+/** Function to check whether a file has a snapshot for its current identity, without loading it. Since snapshots are
+ * only saved for images that passed validation, a match means the file is valid against the identity's schema.
+ *@return True if a snapshot exists and matches identity and this build's layout
+ *@param fileName - the file the snapshot is for
+ *@param identity - the file's current identity
+ **/
+bool matchesSVGsnapshot(const char* fileName, const FileIdentity* identity);
+
+/** Removes a file's snapshot, if it has one. Call after changing the file.
+ *@param fileName - the file the snapshot is for
+ **/
+void invalidateSVGsnapshot(const char* fileName);
+
+#endif
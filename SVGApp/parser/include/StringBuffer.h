@@ -0,0 +1,87 @@
+/**
+ * @file StringBuffer.h
+ * @brief Growable output buffer used to build JSON and text dumps in a single pass. Appends are amortized constant
+ * time, and a buffer can write through to a FILE* instead of keeping the whole output in memory.
+ */
+
+#ifndef _STRING_BUFFER_API_
+#define _STRING_BUFFER_API_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Metadata head of the buffer. data is always null terminated.
+ **/
+typedef struct stringBuffer{
+    char* data;
+    size_t length;
+    size_t capacity;
+    //When set, the buffered text is written here whenever it grows past the flush size, and on bufferFlush
+    FILE* sink;
+    //Set when memory or the sink could not be written. Later appends are ignored.
+    bool failed;
+} StringBuffer;
+
+
+/** Function to create an empty in memory buffer.
+ *@return On success the newly allocated StringBuffer. NULL if malloc fails
+ *@param capacity - number of bytes to reserve up front. 0 uses a default size
+ **/
+StringBuffer* createStringBuffer(size_t capacity);
+
+/** Function to create a buffer that writes through to a file.
+ *@pre file is open for writing
+ *@return On success the newly allocated StringBuffer. NULL if malloc fails
+ *@param file - the file to write to. It is not closed by the buffer
+ **/
+StringBuffer* createFileBuffer(FILE* file);
+
+/** Appends a null terminated string to the buffer.
+ *@pre buffer and string are not NULL
+ *@param buffer - the buffer
+ *@param string - the string to append
+ **/
+void bufferAppend(StringBuffer* buffer, const char* string);
+
+/** Appends the first length bytes of a string to the buffer.
+ *@pre buffer is not NULL, string has at least length bytes
+ *@param buffer - the buffer
+ *@param string - the bytes to append
+ *@param length - the number of bytes to append
+ **/
+void bufferAppendN(StringBuffer* buffer, const char* string, size_t length);
+
+/** Appends one character to the buffer.
+ *@pre buffer is not NULL
+ *@param buffer - the buffer
+ *@param c - the character to append
+ **/
+void bufferAppendChar(StringBuffer* buffer, char c);
+
+/** Appends printf style formatted text to the buffer, without a temporary string.
+ *@pre buffer and format are not NULL
+ *@param buffer - the buffer
+ *@param format - the printf format string
+ **/
+void bufferPrintf(StringBuffer* buffer, const char* format, ...);
+
+/** Writes any buffered text to the buffer's file. Does nothing for in memory buffers.
+ *@return false if the buffer has failed, or the file could not be written
+ *@param buffer - the buffer
+ **/
+bool bufferFlush(StringBuffer* buffer);
+
+/** Frees the buffer and hands its text to the caller. A file buffer is flushed first.
+ *@return The text, which the caller frees. NULL for file buffers, or if the buffer failed
+ *@param buffer - the buffer to release. May be NULL
+ **/
+char* bufferRelease(StringBuffer* buffer);
+
+/** Frees the buffer and its text. A file buffer is flushed first.
+ *@param buffer - the buffer to free. May be NULL
+ **/
+void freeStringBuffer(StringBuffer* buffer);
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * @file StringPool.h
+ * @brief Interning table that keeps one copy of each distinct string. Equal strings interned in the same pool get the
+ * same address, so they can be compared with == and share their storage. The strings live in an arena and are only
+ * released with the pool.
+ */
+
+#ifndef _STRING_POOL_API_
+#define _STRING_POOL_API_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "Arena.h"
+
+/**
+ * Metadata head of the pool. The table is open addressed and kept at most half full.
+ **/
+typedef struct stringPool{
+    //Interned strings by slot, NULL for empty slots
+    const char** strings;
+    //Hash of the string in each slot, so growing does not rehash the text
+    uint32_t* hashes;
+    size_t capacity;
+    size_t count;
+    //Where the strings are copied to
+    Arena* arena;
+    //True if the pool made its own arena and frees it with the pool
+    bool ownsArena;
+} StringPool;
+
+
+/** Function to create an empty pool.
+ *@post If arena is given, the pool is freed along with it and must not be passed to freeStringPool
+ *@return On success the newly allocated StringPool. NULL if malloc fails
+ *@param arena - arena to copy strings into. If NULL the pool makes its own
+ **/
+StringPool* createStringPool(Arena* arena);
+
+/** Function to get the pool's copy of a string, copying it in the first time it is seen.
+ *@pre pool and string are not NULL
+ *@return The interned string, which must not be modified or freed. NULL if malloc fails
+ *@param pool - the pool
+ *@param string - the string to intern
+ **/
+const char* internString(StringPool* pool, const char* string);
+
+/** Function to add a string to the pool without copying it, e.g. one in memory the pool's owner already keeps alive.
+ *@pre pool and string are not NULL, and string stays valid and unchanged for as long as the pool
+ *@return The interned string: string itself, or the pool's existing copy if it already held an equal string. NULL if
+ *        malloc fails
+ *@param pool - the pool
+ *@param string - the string to add
+ **/
+const char* adoptString(StringPool* pool, const char* string);
+
+/** Function to get the pool's copy of a string without adding it.
+ *@return The interned string, or NULL if it has not been interned or pool is NULL
+ *@param pool - the pool
+ *@param string - the string to look for
+ **/
+const char* findString(const StringPool* pool, const char* string);
+
+/** Function to free a pool made without an arena, and every string it holds.
+ *@post Every string interned in the pool is invalid
+ *@param pool - the pool to free. May be NULL
+ **/
+void freeStringPool(StringPool* pool);
+
+#endif
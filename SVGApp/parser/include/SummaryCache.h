@@ -0,0 +1,118 @@
+/**
+ * @file SummaryCache.h
+ * @brief On disk cache of the JSON produced for a file, kept in a .svgcache directory beside it. A record is only
+ * used while the file and the schema it was checked against are unchanged, so repeat requests for the same file
+ * skip parsing and validation. Records are replaced with an atomic rename, so readers never see a partial write.
+ */
+
+#ifndef _SUMMARY_CACHE_API_
+#define _SUMMARY_CACHE_API_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Everything a cached record depends on. Records whose identity differs from the file's current one are ignored.
+ **/
+typedef struct fileIdentity{
+    long long size;
+    long long mtimeSec;
+    long mtimeNsec;
+    //FNV-1a hash of the file's contents
+    uint64_t hash;
+    //FNV-1a hash of the schema's path, and the schema file's size and modification time
+    uint64_t schemaHash;
+    long long schemaSize;
+    long long schemaMtimeSec;
+    long schemaMtimeNsec;
+} FileIdentity;
+
+/**
+ * A cached record. Either JSON string may be missing if it has not been asked for yet.
+ **/
+typedef struct fileSummary{
+    FileIdentity identity;
+    //False if the file did not load or was not valid. Then neither string is needed.
+    bool valid;
+    //The SVGtoJSON counts, or NULL if not cached
+    char* counts;
+    //The fullImageToJSON payload, or NULL if not cached
+    char* full;
+} FileSummary;
+
+
+/** Function to find a file's current identity. Reads the whole file to hash it.
+ *@return True on success. False if either file could not be read
+ *@param path - the file
+ *@param schemaPath - the schema the file is validated against
+ *@param identity - filled in on success
+ **/
+bool getFileIdentity(const char* path, const char* schemaPath, FileIdentity* identity);
+
+/** Function to find a file's identity from contents already in memory, e.g. a MappedFile, without reading it again.
+ *@return True on success. False if contents is NULL or the schema could not be read
+ *@param contents - the file's contents
+ *@param size - number of bytes in contents
+ *@param mtimeSec - the file's modification time, seconds part
+ *@param mtimeNsec - the file's modification time, nanoseconds part
+ *@param schemaPath - the schema the file is validated against
+ *@param identity - filled in on success
+ **/
+bool getContentIdentity(const void* contents, size_t size, long long mtimeSec, long mtimeNsec, const char* schemaPath,
+                        FileIdentity* identity);
+
+/** Function to compare two identities.
+ *@return True if every field matches
+ *@param a - the first identity
+ *@param b - the second identity
+ **/
+bool sameFileIdentity(const FileIdentity* a, const FileIdentity* b);
+
+/** Function to create an empty record for a file.
+ *@return On success the newly allocated FileSummary, with no strings cached. NULL if malloc fails
+ *@param identity - the file's current identity
+ **/
+FileSummary* createFileSummary(const FileIdentity* identity);
+
+/** Function to read a file's cached record.
+ *@return The newly allocated record if one exists and matches identity. NULL otherwise
+ *@param path - the file the record is for, not the record itself
+ *@param identity - the file's current identity
+ **/
+FileSummary* loadFileSummary(const char* path, const FileIdentity* identity);
+
+/** Function to write a file's record, replacing any older one.
+ *@return True if the record was written. Failures leave the cache as it was
+ *@param path - the file the record is for
+ *@param summary - the record to write
+ **/
+bool storeFileSummary(const char* path, const FileSummary* summary);
+
+/** Function to find where another kind of record for a file is kept, in the same directory as its summary.
+ *@return The newly allocated path of the record. NULL if malloc fails
+ *@param path - the file the record is for
+ *@param extension - appended to the file's name to name the record, e.g. ".snap"
+ **/
+char* cacheRecordPath(const char* path, const char* extension);
+
+/** Function to write another kind of record for a file, replacing any older one with an atomic rename.
+ *@return True if the record was written. Failures leave the cache as it was
+ *@param path - the file the record is for
+ *@param extension - as cacheRecordPath
+ *@param data - the record's contents
+ *@param length - number of bytes in data
+ **/
+bool storeCacheRecord(const char* path, const char* extension, const void* data, size_t length);
+
+/** Removes a file's cached record, if it has one. Call after changing the file.
+ *@param path - the file the record is for
+ **/
+void invalidateFileSummary(const char* path);
+
+/** Frees a record and its strings.
+ *@param summary - the record to free. May be NULL
+ **/
+void freeFileSummary(FileSummary* summary);
+
+#endif
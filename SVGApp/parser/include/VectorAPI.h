@@ -0,0 +1,131 @@
+/**
+ * @file VectorAPI.h
+ * @brief Contiguous, array backed alternative to the linked List. It has the same contract for initializing,
+ * inserting at the back, iterating and getting the length, and adds constant time access by index.
+ */
+
+#ifndef _VECTOR_API_
+#define _VECTOR_API_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "LinkedListAPI.h"
+
+/**
+ * Metadata head of the vector. The elements are stored contiguously in data, which grows geometrically.
+ **/
+typedef struct vectorHead{
+    void** data;
+    int length;
+    int capacity;
+    void (*deleteData)(void* toBeDeleted);
+    int (*compare)(const void* first,const void* second);
+    char* (*printData)(void* toBePrinted);
+} Vector;
+
+/**
+ * Vector iterator structure. Works the same way as ListIterator.
+ **/
+typedef struct vectorIter{
+    Vector* vector;
+    int index;
+} VectorIterator;
+
+
+/** Function to initialize the vector metadata head with the appropriate function pointers.
+*@pre function pointer arguments must not be NULL
+*@post Vector structure has been allocated and initialized, with no elements
+*@return On success returns newly allocated Vector struct. Returns NULL if malloc fails
+*@param printFunction - function pointer to print a single element of the vector
+*@param deleteFunction - function pointer to delete a single piece of data from the vector
+*@param compareFunction - function pointer to compare two elements of the vector
+**/
+Vector* initializeVector(char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second));
+
+/** Deletes the entire vector, including the Vector struct, using deleteData on every element.
+*@param vector - pointer to the Vector. May be NULL
+**/
+void freeVector(Vector* vector);
+
+/** Frees the contents of the vector using deleteData, without deleting the Vector struct.
+*@post vector length = 0. The capacity is kept for reuse
+*@param vector - pointer to the Vector. May be NULL
+**/
+void clearVector(Vector* vector);
+
+/** Reserves space for at least capacity elements, so that many insertions do not reallocate.
+*@param vector - pointer to the Vector
+*@param capacity - number of elements to make room for
+**/
+void reserveVector(Vector* vector, int capacity);
+
+/** Adds an element to the back of the vector. Amortized constant time.
+*@pre Vector exists
+*@param vector - pointer to the Vector
+*@param toBeAdded - a pointer to data that is to be added to the vector. NULL is ignored, the same as insertBack
+**/
+void insertBackVector(Vector* vector, void* toBeAdded);
+
+/** Returns the element at an index in constant time. Does not alter the vector.
+*@return the data at index, or NULL if index is out of range
+*@param vector - pointer to the Vector
+*@param index - 0 based index of the element
+**/
+void* getVectorElement(Vector* vector, int index);
+
+/** Replaces the element at an index. The old element is not deleted.
+*@return the data that was at index, or NULL if index is out of range
+*@param vector - pointer to the Vector
+*@param index - 0 based index of the element
+*@param data - the new data
+**/
+void* setVectorElement(Vector* vector, int index, void* data);
+
+/** Returns the number of elements in the vector.
+*@return number of elements in the vector (0 or more). -1 if vector is NULL
+*@param vector - pointer to the Vector
+**/
+int getVectorLength(Vector* vector);
+
+/** Returns a string that contains a string representation of the vector, from the first to the last element.
+*@return the string, which must be freed by the caller
+*@param vector - pointer to the Vector
+**/
+char* vectorToString(Vector* vector);
+
+/** Function for creating an iterator for the vector. The iterator starts at the first element.
+*@return The newly created iterator object.
+*@param vector - pointer to the Vector to iterate over.
+**/
+VectorIterator createVectorIterator(Vector* vector);
+
+/** Returns the element the iterator points to and advances the iterator.
+*@return The element, or NULL when the end of the vector is reached.
+*@param iter - a pointer to an iterator for a Vector.
+**/
+void* nextVectorElement(VectorIterator* iter);
+
+/** Searches the vector using a comparator function, the same as findElement.
+*@return The first element that matches, or NULL if none does.
+*@param vector - pointer to the Vector
+*@param customCompare - a pointer to comparator function for customizing the search
+*@param searchRecord - a pointer to search data, which contains seach criteria
+**/
+void* findVectorElement(Vector* vector, bool (*customCompare)(const void* first,const void* second), const void* searchRecord);
+
+/** Delete function for vectors that only borrow their data, e.g. views into a list. Does nothing.
+*@param toBeDeleted - the data, which is not freed
+**/
+void borrowedVectorData(void* toBeDeleted);
+
+/** Creates a vector holding the same pointers as a list, in the same order. The data is shared, not copied,
+ * so the vector's deleteData does nothing.
+*@return The new vector
+*@param list - the list to copy
+**/
+Vector* listToVector(List* list);
+
+#endif
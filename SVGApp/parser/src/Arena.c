@@ -0,0 +1,84 @@
+#include "Arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+
+#define ARENA_DEFAULT_SLAB_SIZE 65536
+#define ARENA_ALIGNMENT alignof(max_align_t)
+
+/** Rounds a size up to the arena alignment **/
+static size_t alignSize(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
+
+Arena* createArena(size_t slabSize) {
+    Arena* arena = calloc(1, sizeof(Arena));
+    if (arena == NULL) return NULL;
+
+    arena->slabSize = (slabSize == 0 ? ARENA_DEFAULT_SLAB_SIZE : slabSize);
+    return arena;
+}
+
+void* arenaAlloc(Arena* arena, size_t size) {
+    size = alignSize(size == 0 ? 1 : size);
+    size_t header = alignSize(sizeof(ArenaSlab));
+
+    //Start a new slab when the current one is full. Big requests get a slab of their own behind the current one,
+    //so the space left in the current slab is not wasted.
+    ArenaSlab* slab = arena->slabs;
+    if (slab == NULL || slab->size - slab->used < size) {
+        size_t slabSize = (size > arena->slabSize / 4 ? size : arena->slabSize);
+        ArenaSlab* newSlab = malloc(header + slabSize);
+        if (newSlab == NULL) return NULL;
+        newSlab->size = slabSize;
+        newSlab->used = 0;
+
+        if (slab != NULL && slabSize != arena->slabSize) {
+            newSlab->next = slab->next;
+            slab->next = newSlab;
+        } else {
+            newSlab->next = slab;
+            arena->slabs = newSlab;
+        }
+        slab = newSlab;
+    }
+
+    void* memory = (char*)slab + header + slab->used;
+    slab->used += size;
+    memset(memory, 0, size);
+    return memory;
+}
+
+char* arenaStrdup(Arena* arena, const char* string) {
+    size_t length = strlen(string) + 1;
+    char* copy = arenaAlloc(arena, length);
+    if (copy != NULL) memcpy(copy, string, length);
+    return copy;
+}
+
+void arenaAddCleanup(Arena* arena, void* data, void (*cleanup)(void* data)) {
+    ArenaCleanup* record = arenaAlloc(arena, sizeof(ArenaCleanup));
+    if (record == NULL) return;
+
+    record->data = data;
+    record->cleanup = cleanup;
+    record->next = arena->cleanups;
+    arena->cleanups = record;
+}
+
+void freeArena(Arena* arena) {
+    if (arena == NULL) return;
+
+    //Cleanup records live in the slabs, so run them all before any slab is freed
+    for (ArenaCleanup* record = arena->cleanups; record != NULL; record = record->next) {
+        record->cleanup(record->data);
+    }
+
+    ArenaSlab* slab = arena->slabs;
+    while (slab != NULL) {
+        ArenaSlab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    free(arena);
+}
@@ -0,0 +1,91 @@
+#include "BoundingBox.h"
+#include <float.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+BoundingBox emptyBounds() {
+    BoundingBox box = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+    return box;
+}
+
+bool boundsIsEmpty(BoundingBox box) {
+    return box.minX > box.maxX || box.minY > box.maxY;
+}
+
+bool boundsIntersect(BoundingBox a, BoundingBox b) {
+    return a.minX <= b.maxX && a.maxX >= b.minX && a.minY <= b.maxY && a.maxY >= b.minY;
+}
+
+void boundsAddPoint(BoundingBox* box, float x, float y) {
+    if (x < box->minX) box->minX = x;
+    if (x > box->maxX) box->maxX = x;
+    if (y < box->minY) box->minY = y;
+    if (y > box->maxY) box->maxY = y;
+}
+
+void boundsAddPoints(BoundingBox* box, const float* x, const float* y, int count) {
+    int i = 0;
+
+#if defined(__AVX__)
+    //8 points per step, then reduce the lanes
+    if (count >= 8) {
+        __m256 minX = _mm256_loadu_ps(x), maxX = minX;
+        __m256 minY = _mm256_loadu_ps(y), maxY = minY;
+        for (i = 8; i + 8 <= count; i += 8) {
+            __m256 vx = _mm256_loadu_ps(x + i);
+            __m256 vy = _mm256_loadu_ps(y + i);
+            minX = _mm256_min_ps(minX, vx);
+            maxX = _mm256_max_ps(maxX, vx);
+            minY = _mm256_min_ps(minY, vy);
+            maxY = _mm256_max_ps(maxY, vy);
+        }
+        float lanes[4][8];
+        _mm256_storeu_ps(lanes[0], minX);
+        _mm256_storeu_ps(lanes[1], minY);
+        _mm256_storeu_ps(lanes[2], maxX);
+        _mm256_storeu_ps(lanes[3], maxY);
+        for (int lane = 0; lane < 8; lane++) {
+            boundsAddPoint(box, lanes[0][lane], lanes[1][lane]);
+            boundsAddPoint(box, lanes[2][lane], lanes[3][lane]);
+        }
+    }
+#elif defined(__SSE__)
+    //4 points per step, then reduce the lanes
+    if (count >= 4) {
+        __m128 minX = _mm_loadu_ps(x), maxX = minX;
+        __m128 minY = _mm_loadu_ps(y), maxY = minY;
+        for (i = 4; i + 4 <= count; i += 4) {
+            __m128 vx = _mm_loadu_ps(x + i);
+            __m128 vy = _mm_loadu_ps(y + i);
+            minX = _mm_min_ps(minX, vx);
+            maxX = _mm_max_ps(maxX, vx);
+            minY = _mm_min_ps(minY, vy);
+            maxY = _mm_max_ps(maxY, vy);
+        }
+        float lanes[4][4];
+        _mm_storeu_ps(lanes[0], minX);
+        _mm_storeu_ps(lanes[1], minY);
+        _mm_storeu_ps(lanes[2], maxX);
+        _mm_storeu_ps(lanes[3], maxY);
+        for (int lane = 0; lane < 4; lane++) {
+            boundsAddPoint(box, lanes[0][lane], lanes[1][lane]);
+            boundsAddPoint(box, lanes[2][lane], lanes[3][lane]);
+        }
+    }
+#endif
+
+    //Scalar fallback, and the points left over after the vector loop
+    for (; i < count; i++) {
+        boundsAddPoint(box, x[i], y[i]);
+    }
+}
+
+void boundsAddBox(BoundingBox* box, BoundingBox other) {
+    if (boundsIsEmpty(other)) return;
+    boundsAddPoint(box, other.minX, other.minY);
+    boundsAddPoint(box, other.maxX, other.maxY);
+}
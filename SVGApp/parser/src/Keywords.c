@@ -0,0 +1,94 @@
+#include "Keywords.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <pthread.h>
+
+//log2 of the number of slots. Keep the table at most about a third full when adding keywords.
+#define KEYWORD_TABLE_BITS 8
+#define KEYWORD_TABLE_SIZE (1 << KEYWORD_TABLE_BITS)
+/*Multiplier found by trying odd constants until every keyword got its own slot. Lookups probe on to the next slot
+  after a collision, so a keyword added without searching again still works, it just costs an extra memcmp.*/
+#define KEYWORD_SEED 0xd6be33592be1a7bbULL
+//Slots a KeywordCache tries for a name before giving up on caching it
+#define KEYWORD_CACHE_PROBES 4
+
+//Indexed by SVGKeyword
+static const char* const keywordNames[NUM_KEYWORDS] = {
+    NULL,
+    "svg", "g", "rect", "circle", "ellipse", "line", "polyline", "polygon", "path", "text", "tspan", "title",
+    "desc", "defs", "use", "image", "symbol", "style", "clipPath", "mask", "linearGradient", "radialGradient",
+    "stop", "pattern", "marker", "a", "metadata",
+    "x", "y", "width", "height", "cx", "cy", "r", "rx", "ry", "d", "x1", "y1", "x2", "y2", "points", "fill",
+    "fill-opacity", "fill-rule", "stroke", "stroke-width", "stroke-opacity", "stroke-linecap", "stroke-linejoin",
+    "stroke-dasharray", "stroke-miterlimit", "opacity", "transform", "id", "class", "viewBox", "version",
+    "font-size", "font-family", "font-weight", "text-anchor", "visibility", "display", "color", "clip-path",
+    "filter", "offset", "stop-color", "preserveAspectRatio"
+};
+
+static unsigned char keywordLengths[NUM_KEYWORDS];
+//Keyword in each slot, KEYWORD_UNKNOWN for empty slots
+static unsigned char keywordTable[KEYWORD_TABLE_SIZE];
+static pthread_once_t keywordTableOnce = PTHREAD_ONCE_INIT;
+//Set once the table is built, so lookups after that skip pthread_once
+static atomic_bool keywordTableBuilt;
+
+/** Slot for a name, from its length and its first, second, middle and last characters. These are distinct for every
+ * keyword, e.g. fill-rule and font-size differ only in the second. **/
+static unsigned int keywordSlot(const char* name, size_t length) {
+    const unsigned char* text = (const unsigned char*)name;
+    uint64_t key = (uint64_t)length | (uint64_t)text[0] << 8 | (uint64_t)text[length > 1 ? 1 : 0] << 16 |
+                   (uint64_t)text[length / 2] << 24 | (uint64_t)text[length - 1] << 32;
+    return (unsigned int)((key * KEYWORD_SEED) >> (64 - KEYWORD_TABLE_BITS));
+}
+
+static void buildKeywordTable(void) {
+    for (int keyword = 1; keyword < NUM_KEYWORDS; keyword++) {
+        size_t length = strlen(keywordNames[keyword]);
+        keywordLengths[keyword] = (unsigned char)length;
+        unsigned int slot = keywordSlot(keywordNames[keyword], length);
+        while (keywordTable[slot] != KEYWORD_UNKNOWN) slot = (slot + 1) & (KEYWORD_TABLE_SIZE - 1);
+        keywordTable[slot] = (unsigned char)keyword;
+    }
+    atomic_store_explicit(&keywordTableBuilt, true, memory_order_release);
+}
+
+SVGKeyword lookupKeywordN(const char* name, size_t length) {
+    if (name == NULL || length == 0 || length > UINT8_MAX) return KEYWORD_UNKNOWN;
+    if (!atomic_load_explicit(&keywordTableBuilt, memory_order_acquire)) pthread_once(&keywordTableOnce, buildKeywordTable);
+
+    unsigned int slot = keywordSlot(name, length);
+    for (SVGKeyword keyword; (keyword = keywordTable[slot]) != KEYWORD_UNKNOWN; slot = (slot + 1) & (KEYWORD_TABLE_SIZE - 1)) {
+        const char* candidate = keywordNames[keyword];
+        if (keywordLengths[keyword] == length && candidate[0] == name[0] && memcmp(candidate, name, length) == 0) return keyword;
+    }
+    return KEYWORD_UNKNOWN;
+}
+
+SVGKeyword lookupKeyword(const char* name) {
+    return (name == NULL ? KEYWORD_UNKNOWN : lookupKeywordN(name, strlen(name)));
+}
+
+void initKeywordCache(KeywordCache* cache) {
+    memset(cache, 0, sizeof(KeywordCache));
+}
+
+SVGKeyword lookupCachedKeyword(KeywordCache* cache, const char* name) {
+    if (name == NULL) return KEYWORD_UNKNOWN;
+    unsigned int slot = (unsigned int)(((uintptr_t)name >> 3) * 0x9E3779B1u) >> (32 - KEYWORD_CACHE_BITS);
+    for (int probe = 0; probe < KEYWORD_CACHE_PROBES; probe++, slot = (slot + 1) & (KEYWORD_CACHE_SIZE - 1)) {
+        if (cache->names[slot] == name) return cache->keywords[slot];
+        if (cache->names[slot] == NULL) {
+            cache->names[slot] = name;
+            cache->keywords[slot] = (unsigned char)lookupKeyword(name);
+            return cache->keywords[slot];
+        }
+    }
+    //Only documents with unusually many distinct names get here
+    return lookupKeyword(name);
+}
+
+const char* keywordName(SVGKeyword keyword) {
+    return (keyword > KEYWORD_UNKNOWN && keyword < NUM_KEYWORDS ? keywordNames[keyword] : NULL);
+}
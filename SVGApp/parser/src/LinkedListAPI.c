@@ -1,5 +1,16 @@
 #include "LinkedListAPI.h"
+#include "StringBuffer.h"
 #include "assert.h"
+#include <stdatomic.h>
+
+static atomic_ulong lastListVersion;
+
+/** Gets a list version no list has had before
+*@return the new version
+**/
+static unsigned long nextListVersion(void){
+	return atomic_fetch_add(&lastListVersion, 1) + 1;
+}
 
 /** Function to initialize the list metadata head to the appropriate function pointers. Allocates memory to the struct.
 *@return pointer to the list head
@@ -23,10 +34,39 @@ List * initializeList(char* (*printFunction)(void* toBePrinted),void (*deleteFun
 	tmpList->deleteData = deleteFunction;
 	tmpList->compare = compareFunction;
 	tmpList->printData = printFunction;
+	tmpList->arena = NULL;
+	tmpList->version = nextListVersion();
 	
 	return tmpList;
 }
 
+/** Function to initialize a list whose List struct and nodes are allocated from an arena.
+*@return pointer to the list head
+*@param printFunction function pointer to print a single node of the list
+*@param deleteFunction function pointer to delete a single piece of data from the list
+*@param compareFunction function pointer to compare two nodes of the list in order to test for equality or order
+*@param arena arena to allocate from, or NULL for the heap
+**/
+List * initializeListInArena(char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second), Arena* arena){
+    if (arena == NULL){
+        return initializeList(printFunction, deleteFunction, compareFunction);
+    }
+
+    assert(printFunction != NULL);
+    assert(deleteFunction != NULL);
+    assert(compareFunction != NULL);
+
+    List * tmpList = arenaAlloc(arena, sizeof(List));
+
+	tmpList->deleteData = deleteFunction;
+	tmpList->compare = compareFunction;
+	tmpList->printData = printFunction;
+	tmpList->arena = arena;
+	tmpList->version = nextListVersion();
+
+	return tmpList;
+}
+
 
 /** Deletes the entire linked list, freeing all memory.
 * uses the supplied function pointer to release allocated memory for the data
@@ -35,6 +75,10 @@ List * initializeList(char* (*printFunction)(void* toBePrinted),void (*deleteFun
 *@return  on success: NULL, on failure: head of list
 **/
 void freeList(List* list){	
+    //Arena lists are released with their arena
+    if (list == NULL || list->arena != NULL){
+		return;
+	}
 
     clearList(list);
 	free(list);
@@ -59,7 +103,8 @@ void clearList(List* list){
 	
 	Node* tmp;
 	
-	while (list->head != NULL){
+	//Arena lists only forget their contents, the memory is released with the arena
+	while (list->arena == NULL && list->head != NULL){
 		list->deleteData(list->head->data);
 		tmp = list->head;
 		list->head = list->head->next;
@@ -69,6 +114,7 @@ void clearList(List* list){
 	list->head = NULL;
 	list->tail = NULL;
 	list->length = 0;
+	list->version = nextListVersion();
 }
 
 /**Function for creating a node for the linked list. 
@@ -94,6 +140,23 @@ Node* initializeNode(void* data){
 	return tmpNode;
 }
 
+/**Function for creating a node that belongs to a list, allocated from the list's arena if it has one.
+* @return On success returns a node that can be added to the list. On failure, returns NULL.
+* @param list - the list the node will be added to
+* @param data - is a void * pointer to any data type.
+**/
+Node* initializeListNode(List* list, void* data){
+	if (list->arena == NULL){
+		return initializeNode(data);
+	}
+
+	Node* tmpNode = arenaAlloc(list->arena, sizeof(Node));
+	if (tmpNode != NULL){
+		tmpNode->data = data;
+	}
+	return tmpNode;
+}
+
 /**Inserts a Node at the front of a linked list.  List metadata is updated
 * so that head and tail pointers are correct.
 *@pre 'List' type must exist and be used in order to keep track of the linked list.
@@ -106,8 +169,9 @@ void insertBack(List* list, void* toBeAdded){
 	}
 	
 	(list->length)++;
+	list->version = nextListVersion();
 
-	Node* newNode = initializeNode(toBeAdded);
+	Node* newNode = initializeListNode(list, toBeAdded);
 	
     if (list->head == NULL && list->tail == NULL){
         list->head = newNode;
@@ -131,8 +195,9 @@ void insertFront(List* list, void* toBeAdded){
 	}
 	
 	(list->length)++;
+	list->version = nextListVersion();
 
-	Node* newNode = initializeNode(toBeAdded);
+	Node* newNode = initializeListNode(list, toBeAdded);
 	
     if (list->head == NULL && list->tail == NULL){
         list->head = newNode;
@@ -195,9 +260,12 @@ void* deleteDataFromList(List* list, void* toBeDeleted){
 			}
 			
 			void* data = delNode->data;
-			free(delNode);
+			if (list->arena == NULL){
+				free(delNode);
+			}
 			
 			(list->length)--;
+			list->version = nextListVersion();
 
 			return data;
 			
@@ -252,12 +320,13 @@ void insertSorted(List *list, void *toBeAdded){
 			free(currDescr);
 			free(newDescr);
 		
-			Node* newNode = initializeNode(toBeAdded);
+			Node* newNode = initializeListNode(list, toBeAdded);
 			newNode->next = currNode;
 			newNode->previous = currNode->previous;
 			currNode->previous->next = newNode;
 			currNode->previous = newNode;
 			(list->length)++;
+			list->version = nextListVersion();
 
 			return;
 		}
@@ -277,23 +346,19 @@ returned string must be freed by the calling function.
  **/
 char* toString(List * list){
 	ListIterator iter = createIterator(list);
-	char* str;
-		
-	str = (char*)malloc(sizeof(char));
-	strcpy(str, "");
+	//One growing buffer, so each description is copied once instead of rescanning the string for every element
+	StringBuffer* str = createStringBuffer(0);
 	
 	void* elem;
 	while((elem = nextElement(&iter)) != NULL){
 		char* currDescr = list->printData(elem);
-		int newLen = strlen(str)+50+strlen(currDescr);
-		str = (char*)realloc(str, newLen);
-		strcat(str, "\n");
-		strcat(str, currDescr);
+		bufferAppendChar(str, '\n');
+		bufferAppend(str, currDescr);
 		
 		free(currDescr);
 	}
 	
-	return str;
+	return bufferRelease(str);
 }
 
 ListIterator createIterator(List* list){
@@ -0,0 +1,63 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "MappedFile.h"
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/** Reads a whole file into memory, for files that cannot be mapped. NULL on failure **/
+static char* readWholeFile(int descriptor, size_t size) {
+    char* data = malloc(size == 0 ? 1 : size);
+    size_t done = 0;
+    while (data != NULL && done < size) {
+        ssize_t count = read(descriptor, data + done, size - done);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) {
+            free(data);
+            return NULL;
+        }
+        done += count;
+    }
+    return data;
+}
+
+MappedFile* openMappedFile(const char* path) {
+    if (path == NULL) return NULL;
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) return NULL;
+
+    struct stat info;
+    MappedFile* file = NULL;
+    if (fstat(descriptor, &info) == 0 && S_ISREG(info.st_mode) && (file = calloc(1, sizeof(MappedFile))) != NULL) {
+        file->size = info.st_size;
+        file->mtimeSec = info.st_mtim.tv_sec;
+        file->mtimeNsec = info.st_mtim.tv_nsec;
+
+        //Empty files cannot be mapped, and are given a buffer like any file that fails to map
+        void* data = (file->size == 0 ? MAP_FAILED : mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, descriptor, 0));
+        if (data != MAP_FAILED) {
+            //The parsers read it once from start to end
+            posix_madvise(data, file->size, POSIX_MADV_SEQUENTIAL);
+            file->data = data;
+            file->mapped = true;
+        } else if ((file->data = readWholeFile(descriptor, file->size)) == NULL) {
+            free(file);
+            file = NULL;
+        }
+    }
+    close(descriptor);
+    return file;
+}
+
+void closeMappedFile(MappedFile* file) {
+    if (file == NULL) return;
+    if (file->mapped) {
+        munmap((void*)file->data, file->size);
+    } else {
+        free((void*)file->data);
+    }
+    free(file);
+}
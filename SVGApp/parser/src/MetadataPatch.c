@@ -0,0 +1,433 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "MetadataPatch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <libxml/xmlstring.h>
+
+#define NOT_FOUND ((size_t)-1)
+
+//How a span of the document is replaced
+typedef enum patchEditKind{
+    //Drop the span
+    EDIT_REMOVE,
+    //Replace an element's content with its new text
+    EDIT_CONTENT,
+    //Replace the "/>" of an empty element with its new text and an end tag
+    EDIT_FILL_EMPTY,
+    //Add a new element
+    EDIT_INSERT,
+    //Replace the "/>" of an empty root, and add its end tag, so elements can be inserted into it
+    EDIT_OPEN_ROOT, EDIT_CLOSE_ROOT
+} PatchEditKind;
+
+typedef struct patchEdit{
+    size_t from, to;
+    PatchEditKind kind;
+    //New text, and the local name of the element it is for
+    const char* text;
+    const char* name;
+    //Order the edit was made in, to keep edits at the same place in order
+    int sequence;
+} PatchEdit;
+
+//A start tag, as offsets into the document
+typedef struct patchTag{
+    size_t start, nameStart, nameEnd, end;
+    bool selfClosing;
+} PatchTag;
+
+//The first <title> or <desc> child of the root
+typedef struct metadataElement{
+    bool found;
+    //Start of the whitespace before it, and the bounds of the element, its start tag and its content
+    size_t before, start, end, contentStart, contentEnd;
+    PatchTag tag;
+} MetadataElement;
+
+typedef struct documentPatch{
+    const char* data;
+    size_t size;
+    PatchTag root;
+    //Length of the root's prefix including the ':', so new elements are put in its namespace
+    size_t prefixLength;
+    //Whitespace after the root's start tag, put before new elements so they line up with the existing ones
+    size_t indentStart, indentEnd;
+    MetadataElement title, description;
+    PatchEdit* edits;
+    int editCount, editCapacity;
+} DocumentPatch;
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool startsWith(const DocumentPatch* patch, size_t pos, const char* text) {
+    size_t length = strlen(text);
+    return pos <= patch->size && patch->size - pos >= length && memcmp(patch->data + pos, text, length) == 0;
+}
+
+/** Offset just past the next occurrence of text at or after pos **/
+static size_t skipPast(const DocumentPatch* patch, size_t pos, const char* text) {
+    for (; pos < patch->size; pos++) {
+        if (startsWith(patch, pos, text)) return pos + strlen(text);
+    }
+    return NOT_FOUND;
+}
+
+/** Reads the start tag at pos, which holds a '<'. False if it does not end **/
+static bool scanTag(const DocumentPatch* patch, size_t pos, PatchTag* tag) {
+    const char* data = patch->data;
+    tag->start = pos;
+    tag->nameStart = ++pos;
+    while (pos < patch->size && !isSpace(data[pos]) && data[pos] != '/' && data[pos] != '>') pos++;
+    tag->nameEnd = pos;
+    if (tag->nameEnd == tag->nameStart) return false;
+
+    //Attribute values may hold '>' and '/', so skip them whole
+    for (; pos < patch->size; pos++) {
+        if (data[pos] == '"' || data[pos] == '\'') {
+            const char* close = memchr(data + pos + 1, data[pos], patch->size - pos - 1);
+            if (close == NULL) return false;
+            pos = close - data;
+        } else if (data[pos] == '>') {
+            tag->end = pos + 1;
+            tag->selfClosing = (data[pos - 1] == '/');
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Checks the encoding named by an XML declaration at pos, if any. Only UTF-8 documents can be patched, since the
+ * new text is copied in as it is **/
+static bool isUTF8Declaration(const DocumentPatch* patch, size_t pos, size_t end) {
+    if (!startsWith(patch, pos, "<?xml") || !isSpace(patch->data[pos + 5])) return true;
+    for (; pos + 8 < end; pos++) {
+        if (memcmp(patch->data + pos, "encoding", 8) != 0) continue;
+        for (pos += 8; pos < end && (isSpace(patch->data[pos]) || patch->data[pos] == '='); pos++);
+        if (pos >= end || (patch->data[pos] != '"' && patch->data[pos] != '\'')) return false;
+        const char* value = patch->data + pos + 1;
+        return (pos + 7 <= end && strncasecmp(value, "UTF-8", 5) == 0 && value[5] == patch->data[pos]) ||
+               (pos + 6 <= end && strncasecmp(value, "UTF8", 4) == 0 && value[4] == patch->data[pos]);
+    }
+    return true;
+}
+
+/** Skips the declaration, processing instructions, comments and doctype before the root. Offset of the root's start
+ * tag, or NOT_FOUND **/
+static size_t skipProlog(const DocumentPatch* patch) {
+    size_t pos = (startsWith(patch, 0, "\xEF\xBB\xBF") ? 3 : 0);
+    while (pos != NOT_FOUND && pos < patch->size) {
+        if (isSpace(patch->data[pos])) {
+            pos++;
+        } else if (startsWith(patch, pos, "<?")) {
+            size_t end = skipPast(patch, pos, "?>");
+            if (end == NOT_FOUND || !isUTF8Declaration(patch, pos, end)) return NOT_FOUND;
+            pos = end;
+        } else if (startsWith(patch, pos, "<!--")) {
+            pos = skipPast(patch, pos + 4, "-->");
+        } else if (startsWith(patch, pos, "<!")) {
+            //A doctype ends at the first '>' outside its quotes, comments and internal subset
+            int brackets = 0;
+            for (pos += 2; pos < patch->size && (patch->data[pos] != '>' || brackets > 0); pos++) {
+                char c = patch->data[pos];
+                if (c == '[') brackets++;
+                if (c == ']') brackets--;
+                if (startsWith(patch, pos, "<!--")) {
+                    if ((pos = skipPast(patch, pos + 4, "-->")) == NOT_FOUND) return NOT_FOUND;
+                    pos--;
+                } else if (c == '"' || c == '\'') {
+                    const char* close = memchr(patch->data + pos + 1, c, patch->size - pos - 1);
+                    if (close == NULL) return NOT_FOUND;
+                    pos = close - patch->data;
+                }
+            }
+            pos = (pos < patch->size ? pos + 1 : NOT_FOUND);
+        } else {
+            return (patch->data[pos] == '<' ? pos : NOT_FOUND);
+        }
+    }
+    return NOT_FOUND;
+}
+
+static bool addEdit(DocumentPatch* patch, size_t from, size_t to, PatchEditKind kind, const char* text, const char* name) {
+    if (patch->editCount == patch->editCapacity) {
+        int capacity = (patch->editCapacity == 0 ? 8 : patch->editCapacity * 2);
+        PatchEdit* edits = realloc(patch->edits, capacity * sizeof(PatchEdit));
+        if (edits == NULL) return false;
+        patch->edits = edits;
+        patch->editCapacity = capacity;
+    }
+    patch->edits[patch->editCount] = (PatchEdit){from, to, kind, text, name, patch->editCount};
+    patch->editCount++;
+    return true;
+}
+
+/** True if a start tag is for the root's <name> child, written with the root's prefix **/
+static bool isMetadataTag(const DocumentPatch* patch, const PatchTag* tag, const char* name) {
+    size_t length = tag->nameEnd - tag->nameStart;
+    return length == patch->prefixLength + strlen(name) &&
+           memcmp(patch->data + tag->nameStart, patch->data + patch->root.nameStart, patch->prefixLength) == 0 &&
+           memcmp(patch->data + tag->nameStart + patch->prefixLength, name, strlen(name)) == 0;
+}
+
+/** Records a finished child of the root. The first <title> and <desc> are kept to be edited, later ones are removed
+ * when their text is being replaced, since a reader takes the last one **/
+static bool finishChild(DocumentPatch* patch, MetadataElement* element, const char* title, const char* description) {
+    const char* text = NULL;
+    MetadataElement* first = NULL;
+    if (isMetadataTag(patch, &element->tag, "title")) {
+        first = &patch->title;
+        text = title;
+    } else if (isMetadataTag(patch, &element->tag, "desc")) {
+        first = &patch->description;
+        text = description;
+    } else {
+        //One written with another prefix might be in the same namespace, and would be missed
+        const char* colon = memchr(patch->data + element->tag.nameStart, ':', element->tag.nameEnd - element->tag.nameStart);
+        size_t localStart = (colon == NULL ? element->tag.nameStart : (size_t)(colon - patch->data) + 1);
+        size_t localLength = element->tag.nameEnd - localStart;
+        return !((localLength == 5 && memcmp(patch->data + localStart, "title", 5) == 0) ||
+                 (localLength == 4 && memcmp(patch->data + localStart, "desc", 4) == 0));
+    }
+
+    if (!first->found) {
+        *first = *element;
+        first->found = true;
+        return true;
+    }
+    return text == NULL || addEdit(patch, element->before, element->end, EDIT_REMOVE, NULL, NULL);
+}
+
+/** Walks the root's content to find its <title> and <desc> children and its end tag. False if the markup could not be
+ * followed **/
+static bool scanRootContent(DocumentPatch* patch, const char* title, const char* description) {
+    const char* data = patch->data;
+    MetadataElement child = {0};
+    int depth = 1;
+    size_t pos = patch->root.end;
+    while (depth > 0) {
+        const char* next = (pos < patch->size ? memchr(data + pos, '<', patch->size - pos) : NULL);
+        if (next == NULL) return false;
+        pos = next - data;
+
+        if (startsWith(patch, pos, "<!--")) {
+            pos = skipPast(patch, pos + 4, "-->");
+        } else if (startsWith(patch, pos, "<![CDATA[")) {
+            pos = skipPast(patch, pos + 9, "]]>");
+        } else if (startsWith(patch, pos, "<?")) {
+            pos = skipPast(patch, pos + 2, "?>");
+        } else if (startsWith(patch, pos, "<!")) {
+            return false;
+        } else if (startsWith(patch, pos, "</")) {
+            size_t end = skipPast(patch, pos + 2, ">");
+            if (end == NOT_FOUND) return false;
+            if (--depth == 1) {
+                child.contentEnd = pos;
+                child.end = end;
+                if (!finishChild(patch, &child, title, description)) return false;
+            }
+            pos = end;
+        } else {
+            PatchTag tag;
+            if (!scanTag(patch, pos, &tag)) return false;
+            if (depth == 1) {
+                child.tag = tag;
+                child.start = child.before = tag.start;
+                while (child.before > patch->root.end && isSpace(data[child.before - 1])) child.before--;
+                child.contentStart = child.contentEnd = child.end = tag.end;
+                if (tag.selfClosing && !finishChild(patch, &child, title, description)) return false;
+            }
+            if (!tag.selfClosing) depth++;
+            pos = tag.end;
+        }
+        if (pos == NOT_FOUND) return false;
+    }
+    return true;
+}
+
+/** Adds the edits that give the first <name> child its new text, or a new child if there is none **/
+static bool editMetadata(DocumentPatch* patch, MetadataElement* element, const char* name, const char* text, size_t insertAt) {
+    if (text == NULL) return true;
+    if (!element->found) return text[0] == '\0' || addEdit(patch, insertAt, insertAt, EDIT_INSERT, text, name);
+    if (text[0] == '\0') {
+        element->found = false;
+        return addEdit(patch, element->before, element->end, EDIT_REMOVE, NULL, NULL);
+    }
+    if (element->tag.selfClosing) return addEdit(patch, element->tag.end - 2, element->tag.end, EDIT_FILL_EMPTY, text, name);
+    return addEdit(patch, element->contentStart, element->contentEnd, EDIT_CONTENT, text, name);
+}
+
+/** Sorts edits by position. Insertions go before a removal that starts at the same place **/
+static int compareEdits(const void* first, const void* second) {
+    const PatchEdit* a = first;
+    const PatchEdit* b = second;
+    if (a->from != b->from) return (a->from < b->from ? -1 : 1);
+    bool aEmpty = (a->from == a->to), bEmpty = (b->from == b->to);
+    if (aEmpty != bEmpty) return (aEmpty ? -1 : 1);
+    return a->sequence - b->sequence;
+}
+
+/** True if a new string can be written as character data **/
+static bool isXmlText(const char* text) {
+    if (text == NULL) return true;
+    for (const unsigned char* c = (const unsigned char*)text; *c != '\0'; c++) {
+        if (*c < 0x20 && *c != '\t' && *c != '\n' && *c != '\r') return false;
+    }
+    return xmlCheckUTF8((const xmlChar*)text) != 0;
+}
+
+static void writeEscaped(FILE* out, const char* text) {
+    for (; *text != '\0'; text++) {
+        switch (*text) {
+            case '&': fputs("&amp;", out); break;
+            case '<': fputs("&lt;", out); break;
+            case '>': fputs("&gt;", out); break;
+            case '\r': fputs("&#13;", out); break;
+            default: fputc(*text, out); break;
+        }
+    }
+}
+
+/** Writes the root's prefix and a local name, e.g. "svg:title" **/
+static void writeName(FILE* out, const DocumentPatch* patch, const char* name) {
+    fwrite(patch->data + patch->root.nameStart, 1, patch->prefixLength, out);
+    fputs(name, out);
+}
+
+/** Writes an element's new text and its end tag **/
+static void writeText(FILE* out, const DocumentPatch* patch, const PatchEdit* edit) {
+    writeEscaped(out, edit->text);
+    fputs("</", out);
+    writeName(out, patch, edit->name);
+    fputc('>', out);
+}
+
+static void writeEdit(FILE* out, const DocumentPatch* patch, const PatchEdit* edit) {
+    switch (edit->kind) {
+        case EDIT_REMOVE:
+            break;
+        case EDIT_CONTENT:
+            writeEscaped(out, edit->text);
+            break;
+        case EDIT_FILL_EMPTY:
+            fputc('>', out);
+            writeText(out, patch, edit);
+            break;
+        case EDIT_INSERT:
+            fwrite(patch->data + patch->indentStart, 1, patch->indentEnd - patch->indentStart, out);
+            fputc('<', out);
+            writeName(out, patch, edit->name);
+            fputc('>', out);
+            writeText(out, patch, edit);
+            break;
+        case EDIT_OPEN_ROOT:
+            fputc('>', out);
+            break;
+        case EDIT_CLOSE_ROOT:
+            fputs("</", out);
+            fwrite(patch->data + patch->root.nameStart, 1, patch->root.nameEnd - patch->root.nameStart, out);
+            fputc('>', out);
+            break;
+    }
+}
+
+/** Finds everything that has to change. False if the document cannot be patched **/
+static bool planPatch(DocumentPatch* patch, const char* title, const char* description) {
+    size_t rootStart = skipProlog(patch);
+    if (rootStart == NOT_FOUND || !scanTag(patch, rootStart, &patch->root)) return false;
+    const char* colon = memchr(patch->data + patch->root.nameStart, ':', patch->root.nameEnd - patch->root.nameStart);
+    patch->prefixLength = (colon == NULL ? 0 : (size_t)(colon - (patch->data + patch->root.nameStart)) + 1);
+    patch->indentStart = patch->indentEnd = patch->root.end;
+    if (!patch->root.selfClosing) {
+        while (patch->indentEnd < patch->size && isSpace(patch->data[patch->indentEnd])) patch->indentEnd++;
+        if (!scanRootContent(patch, title, description)) return false;
+    }
+
+    //A new title is the root's first child, and a new description follows the title
+    int before = patch->editCount;
+    size_t start = patch->root.end;
+    if (patch->root.selfClosing && !addEdit(patch, start - 2, start, EDIT_OPEN_ROOT, NULL, NULL)) return false;
+    if (!editMetadata(patch, &patch->title, "title", title, start)) return false;
+    size_t afterTitle = (patch->title.found ? patch->title.end : start);
+    if (!editMetadata(patch, &patch->description, "desc", description, afterTitle)) return false;
+    if (patch->root.selfClosing) {
+        if (patch->editCount == before + 1) {
+            //Nothing to put in the root, so leave it empty
+            patch->editCount = before;
+        } else if (!addEdit(patch, start, start, EDIT_CLOSE_ROOT, NULL, NULL)) {
+            return false;
+        }
+    }
+
+    qsort(patch->edits, patch->editCount, sizeof(PatchEdit), compareEdits);
+    for (int i = 1; i < patch->editCount; i++) {
+        if (patch->edits[i].from < patch->edits[i - 1].to) return false;
+    }
+    return true;
+}
+
+size_t metadataTextLength(const char* text) {
+    size_t length = strnlen(text, METADATA_TEXT_LIMIT + 1);
+    if (length <= METADATA_TEXT_LIMIT) return length;
+    //Back up over continuation bytes to the start of the character that did not fit
+    length = METADATA_TEXT_LIMIT;
+    while (length > 0 && ((unsigned char)text[length] & 0xC0) == 0x80) length--;
+    return length;
+}
+
+bool writePatchedSVG(FILE* out, const char* data, size_t size, const char* title, const char* description) {
+    if (out == NULL || data == NULL || !isXmlText(title) || !isXmlText(description)) return false;
+
+    char* keptTitle = (title == NULL ? NULL : strndup(title, metadataTextLength(title)));
+    char* keptDescription = (description == NULL ? NULL : strndup(description, metadataTextLength(description)));
+    DocumentPatch patch = {0};
+    patch.data = data;
+    patch.size = size;
+    bool planned = (title == NULL || keptTitle != NULL) && (description == NULL || keptDescription != NULL) &&
+                   planPatch(&patch, keptTitle, keptDescription);
+    if (planned) {
+        //Copy the document, writing each edit in place of the span it covers
+        size_t pos = 0;
+        for (int i = 0; i < patch.editCount; i++) {
+            fwrite(data + pos, 1, patch.edits[i].from - pos, out);
+            writeEdit(out, &patch, &patch.edits[i]);
+            pos = patch.edits[i].to;
+        }
+        fwrite(data + pos, 1, size - pos, out);
+    }
+    free(patch.edits);
+    free(keptTitle);
+    free(keptDescription);
+    return planned && !ferror(out);
+}
+
+bool patchSVGfile(const char* path, const char* data, size_t size, const char* title, const char* description) {
+    struct stat info;
+    if (path == NULL || data == NULL || stat(path, &info) != 0) return false;
+
+    //The new file is written beside the old one, hidden so a directory listing does not pick it up, and renamed over it
+    const char* slash = strrchr(path, '/');
+    int directoryLength = (slash == NULL ? 0 : (int)(slash - path) + 1);
+    char* tempPath = malloc(strlen(path) + 9);
+    if (tempPath == NULL) return false;
+    sprintf(tempPath, "%.*s.%s.XXXXXX", directoryLength, path, path + directoryLength);
+
+    int descriptor = mkstemp(tempPath);
+    FILE* file = (descriptor < 0 ? NULL : fdopen(descriptor, "wb"));
+    bool written = false;
+    if (file != NULL) {
+        written = (fchmod(descriptor, info.st_mode & 07777) == 0 && writePatchedSVG(file, data, size, title, description));
+        written = (fclose(file) == 0 && written);
+        written = (written && rename(tempPath, path) == 0);
+    } else if (descriptor >= 0) {
+        close(descriptor);
+    }
+    if (!written && descriptor >= 0) unlink(tempPath);
+    free(tempPath);
+    return written;
+}
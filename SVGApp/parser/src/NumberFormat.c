@@ -0,0 +1,296 @@
+#include "NumberFormat.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#define FLOAT_MANTISSA_BITS 23
+#define FLOAT_BIAS 127
+#define POW5_INV_BITCOUNT 59
+#define POW5_BITCOUNT 61
+//Longest run of digits written without an exponent, as JavaScript does
+#define MAX_PLAIN_DIGITS 21
+
+//floor(2^k / 5^i) + 1 for k = bitlength(5^i) - 1 + POW5_INV_BITCOUNT
+static const uint64_t POW5_INV_SPLIT[32] = {
+    0x0800000000000001u, 0x0666666666666667u, 0x051eb851eb851eb9u, 0x04189374bc6a7efau, 0x068db8bac710cb2au,
+    0x053e2d6238da3c22u, 0x0431bde82d7b634eu, 0x06b5fca6af2bd216u, 0x055e63b88c230e78u, 0x044b82fa09b5a52du,
+    0x06df37f675ef6eaeu, 0x057f5ff85e592558u, 0x0465e6604b7a8447u, 0x0709709a125da071u, 0x05a126e1a84ae6c1u,
+    0x0480ebe7b9d58567u, 0x0734aca5f6226f0bu, 0x05c3bd5191b525a3u, 0x049c97747490eae9u, 0x0760f253edb4ab0eu,
+    0x05e72843249088d8u, 0x04b8ed0283a6d3e0u, 0x078e480405d7b966u, 0x060b6cd004ac9452u, 0x04d5f0a66a23a9dbu,
+    0x07bcb43d769f762bu, 0x063090312bb2c4efu, 0x04f3a68dbc8f03f3u, 0x07ec3daf94180651u, 0x065697bfa9acd1dau,
+    0x051212ffbaf0a7e2u, 0x040e7599625a1fe8u
+};
+
+//The top POW5_BITCOUNT bits of 5^i
+static const uint64_t POW5_SPLIT[48] = {
+    0x1000000000000000u, 0x1400000000000000u, 0x1900000000000000u, 0x1f40000000000000u, 0x1388000000000000u,
+    0x186a000000000000u, 0x1e84800000000000u, 0x1312d00000000000u, 0x17d7840000000000u, 0x1dcd650000000000u,
+    0x12a05f2000000000u, 0x174876e800000000u, 0x1d1a94a200000000u, 0x12309ce540000000u, 0x16bcc41e90000000u,
+    0x1c6bf52634000000u, 0x11c37937e0800000u, 0x16345785d8a00000u, 0x1bc16d674ec80000u, 0x1158e460913d0000u,
+    0x15af1d78b58c4000u, 0x1b1ae4d6e2ef5000u, 0x10f0cf064dd59200u, 0x152d02c7e14af680u, 0x1a784379d99db420u,
+    0x108b2a2c28029094u, 0x14adf4b7320334b9u, 0x19d971e4fe8401e7u, 0x1027e72f1f128130u, 0x1431e0fae6d7217cu,
+    0x193e5939a08ce9dbu, 0x1f8def8808b02452u, 0x13b8b5b5056e16b3u, 0x18a6e32246c99c60u, 0x1ed09bead87c0378u,
+    0x13426172c74d822bu, 0x1812f9cf7920e2b6u, 0x1e17b84357691b64u, 0x12ced32a16a1b11eu, 0x178287f49c4a1d66u,
+    0x1d6329f1c35ca4bfu, 0x125dfa371a19e6f7u, 0x16f578c4e0a060b5u, 0x1cb2d6f618c878e3u, 0x11efc659cf7d4b8du,
+    0x166bb7f0435c9e71u, 0x1c06a5ec5433c60du, 0x118427b3b4a05bc8u
+};
+
+//A number as decimal digits, mantissa * 10^exponent
+typedef struct decimalNumber{
+    uint32_t mantissa;
+    int32_t exponent;
+} DecimalNumber;
+
+/** Number of bits in 5^e, for e >= 0 **/
+static int32_t pow5bits(int32_t e) {
+    return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+/** floor(log10(2^e)) **/
+static uint32_t log10Pow2(int32_t e) {
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+/** floor(log10(5^e)) **/
+static uint32_t log10Pow5(int32_t e) {
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+static bool multipleOfPowerOf5(uint32_t value, uint32_t p) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count >= p;
+}
+
+static bool multipleOfPowerOf2(uint32_t value, uint32_t p) {
+    return (value & ((1u << p) - 1)) == 0;
+}
+
+/** (m * factor) >> shift, for shift > 32 **/
+static uint32_t mulShift(uint32_t m, uint64_t factor, int32_t shift) {
+    uint64_t low = (uint64_t)m * (uint32_t)factor;
+    uint64_t high = (uint64_t)m * (uint32_t)(factor >> 32);
+    return (uint32_t)(((low >> 32) + high) >> (shift - 32));
+}
+
+/** Finds the shortest decimal in the interval of numbers that round to a finite float, following Ryu's f2s. When
+ * several are as short, the one nearest the float is taken. See Ulf Adams, "Ryu: fast float-to-string conversion",
+ * PLDI 2018 **/
+static DecimalNumber shortestDecimal(uint32_t ieeeMantissa, uint32_t ieeeExponent) {
+    int32_t e2;
+    uint32_t m2;
+    if (ieeeExponent == 0) {
+        e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = ieeeMantissa;
+    } else {
+        e2 = (int32_t)ieeeExponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+    }
+    //Ties go to the even float, so an even float owns the bounds of its interval
+    bool acceptBounds = (m2 & 1) == 0;
+
+    //The float and the bounds of its interval, scaled by 4 so the bounds are integers
+    uint32_t mv = 4 * m2;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mmShift = (ieeeMantissa != 0 || ieeeExponent <= 1);
+    uint32_t mm = 4 * m2 - 1 - mmShift;
+
+    //Convert all three to decimal, keeping track of whether the digits dropped so far were all zeros
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vmIsTrailingZeros = false, vrIsTrailingZeros = false;
+    uint8_t lastRemovedDigit = 0;
+    if (e2 >= 0) {
+        uint32_t q = log10Pow2(e2);
+        e10 = (int32_t)q;
+        int32_t k = POW5_INV_BITCOUNT + pow5bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+        vr = mulShift(mv, POW5_INV_SPLIT[q], i);
+        vp = mulShift(mp, POW5_INV_SPLIT[q], i);
+        vm = mulShift(mm, POW5_INV_SPLIT[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            //The loop below will not run, but the digit after vr is still needed to round it
+            int32_t l = POW5_INV_BITCOUNT + pow5bits((int32_t)(q - 1)) - 1;
+            lastRemovedDigit = (uint8_t)(mulShift(mv, POW5_INV_SPLIT[q - 1], -e2 + (int32_t)q - 1 + l) % 10);
+        }
+        if (q <= 9) {
+            //Only one of mp, mv and mm can be a multiple of 5
+            if (mv % 5 == 0) {
+                vrIsTrailingZeros = multipleOfPowerOf5(mv, q);
+            } else if (acceptBounds) {
+                vmIsTrailingZeros = multipleOfPowerOf5(mm, q);
+            } else {
+                vp -= multipleOfPowerOf5(mp, q);
+            }
+        }
+    } else {
+        uint32_t q = log10Pow5(-e2);
+        e10 = (int32_t)q + e2;
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = pow5bits(i) - POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+        vr = mulShift(mv, POW5_SPLIT[i], j);
+        vp = mulShift(mp, POW5_SPLIT[i], j);
+        vm = mulShift(mm, POW5_SPLIT[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t)q - 1 - (pow5bits(i + 1) - POW5_BITCOUNT);
+            lastRemovedDigit = (uint8_t)(mulShift(mv, POW5_SPLIT[i + 1], j) % 10);
+        }
+        if (q <= 1) {
+            //mv = 4 * m2 always has two trailing zero bits, mp = mv + 2 has one, and mm has one if mmShift is set
+            vrIsTrailingZeros = true;
+            if (acceptBounds) {
+                vmIsTrailingZeros = (mmShift == 1);
+            } else {
+                vp--;
+            }
+        } else if (q < 31) {
+            vrIsTrailingZeros = multipleOfPowerOf2(mv, q - 1);
+        }
+    }
+
+    //Drop digits while the bounds still differ, then round what is left of vr
+    int32_t removed = 0;
+    uint32_t output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        while (vp / 10 > vm / 10) {
+            vmIsTrailingZeros &= (vm % 10 == 0);
+            vrIsTrailingZeros &= (lastRemovedDigit == 0);
+            lastRemovedDigit = (uint8_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm % 10 == 0) {
+                vrIsTrailingZeros &= (lastRemovedDigit == 0);
+                lastRemovedDigit = (uint8_t)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        //Round half to even when the dropped digits are exactly 50...0
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) lastRemovedDigit = 4;
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    } else {
+        //The common case, where nothing can be exactly on a bound
+        while (vp / 10 > vm / 10) {
+            lastRemovedDigit = (uint8_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || lastRemovedDigit >= 5);
+    }
+    return (DecimalNumber){output, e10 + removed};
+}
+
+/** Rounds a decimal to at most precision digits after the point, half away from zero **/
+static DecimalNumber roundDecimal(DecimalNumber number, int precision) {
+    if (number.exponent >= -precision) return number;
+
+    //The last digit dropped is the most significant one, and decides the rounding
+    uint8_t lastRemovedDigit = 0;
+    for (int32_t drop = -precision - number.exponent; drop > 0; drop--) {
+        lastRemovedDigit = number.mantissa % 10;
+        number.mantissa /= 10;
+        number.exponent++;
+        if (number.mantissa == 0 && drop > 1) {
+            //Every remaining digit is a leading zero
+            lastRemovedDigit = 0;
+            number.exponent += drop - 1;
+            break;
+        }
+    }
+    number.mantissa += (lastRemovedDigit >= 5);
+    return number;
+}
+
+/** Writes a decimal the way JavaScript's Number.prototype.toString does, with no '+' in exponents **/
+static int writeDecimal(char* buffer, bool negative, DecimalNumber number) {
+    //Trailing zeros are written as part of the exponent, or not at all
+    if (number.mantissa == 0) {
+        number.exponent = 0;
+    } else {
+        while (number.mantissa % 10 == 0) {
+            number.mantissa /= 10;
+            number.exponent++;
+        }
+    }
+
+    char digits[10];
+    int count = 0;
+    char reversed[10];
+    for (uint32_t m = number.mantissa; count == 0 || m > 0; m /= 10) reversed[count++] = '0' + m % 10;
+    for (int i = 0; i < count; i++) digits[i] = reversed[count - 1 - i];
+
+    //Position of the decimal point relative to the first digit
+    int point = number.exponent + count;
+    int length = 0;
+    if (negative) buffer[length++] = '-';
+    if (count <= point && point <= MAX_PLAIN_DIGITS) {
+        memcpy(buffer + length, digits, count);
+        length += count;
+        memset(buffer + length, '0', point - count);
+        length += point - count;
+    } else if (0 < point && point <= MAX_PLAIN_DIGITS) {
+        memcpy(buffer + length, digits, point);
+        length += point;
+        buffer[length++] = '.';
+        memcpy(buffer + length, digits + point, count - point);
+        length += count - point;
+    } else if (-6 < point && point <= 0) {
+        buffer[length++] = '0';
+        buffer[length++] = '.';
+        memset(buffer + length, '0', -point);
+        length += -point;
+        memcpy(buffer + length, digits, count);
+        length += count;
+    } else {
+        buffer[length++] = digits[0];
+        if (count > 1) {
+            buffer[length++] = '.';
+            memcpy(buffer + length, digits + 1, count - 1);
+            length += count - 1;
+        }
+        int exponent = point - 1;
+        buffer[length++] = 'e';
+        if (exponent < 0) {
+            buffer[length++] = '-';
+            exponent = -exponent;
+        }
+        if (exponent >= 10) buffer[length++] = '0' + exponent / 10;
+        buffer[length++] = '0' + exponent % 10;
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+int formatNumber(char* buffer, float value, int precision) {
+    if (isnan(value)) value = 0;
+    if (isinf(value)) value = (value < 0 ? -FLT_MAX : FLT_MAX);
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bool negative = (bits >> 31) != 0;
+    uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+    uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & 0xff;
+
+    DecimalNumber number = {0, 0};
+    if (ieeeExponent != 0 || ieeeMantissa != 0) number = shortestDecimal(ieeeMantissa, ieeeExponent);
+    if (precision >= 0) {
+        number = roundDecimal(number, precision);
+        //A number that rounds to zero is written without its sign
+        if (number.mantissa == 0) negative = false;
+    }
+    return writeDecimal(buffer, negative, number);
+}
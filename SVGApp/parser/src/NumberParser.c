@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "NumberParser.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <locale.h>
+#include <pthread.h>
+
+//Digits past this are only counted in the exponent. Any number this long takes the slow path anyway.
+#define MANTISSA_LIMIT 100000000000000000ULL
+//Every integer up to 2^53, and every power of ten up to 10^22, is exact in a double
+#define EXACT_MANTISSA (1ULL << 53)
+#define EXACT_POWER 22
+//Numbers whose text is longer than this are copied to the heap for strtof
+#define SHORT_NUMBER 64
+
+static const double powersOfTen[EXACT_POWER + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static locale_t cLocale = (locale_t)0;
+static pthread_once_t cLocaleOnce = PTHREAD_ONCE_INIT;
+
+static void createCLocale(void) {
+    cLocale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/** strtof on exactly the text of one number, in the C locale whatever the caller's locale is **/
+static float slowParse(const char* start, size_t length) {
+    char shortCopy[SHORT_NUMBER];
+    char* copy = (length < SHORT_NUMBER ? shortCopy : malloc(length + 1));
+    if (copy == NULL) return 0;
+    memcpy(copy, start, length);
+    copy[length] = '\0';
+
+    pthread_once(&cLocaleOnce, createCLocale);
+    locale_t previous = (cLocale == (locale_t)0 ? (locale_t)0 : uselocale(cLocale));
+    float value = strtof(copy, NULL);
+    if (previous != (locale_t)0) uselocale(previous);
+
+    if (copy != shortCopy) free(copy);
+    return value;
+}
+
+float parseSVGNumber(const char* string, char** end) {
+    const char* p = string;
+    while (isSpace(*p)) p++;
+    const char* start = p;
+
+    bool negative = (*p == '-');
+    if (*p == '+' || *p == '-') p++;
+
+    //The digits as an integer, and the power of ten it is scaled by
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    bool digits = false, truncated = false;
+    for (; isDigit(*p); p++) {
+        digits = true;
+        if (mantissa < MANTISSA_LIMIT) {
+            mantissa = mantissa * 10 + (*p - '0');
+        } else {
+            exponent++;
+            truncated = truncated || *p != '0';
+        }
+    }
+    if (*p == '.') {
+        for (p++; isDigit(*p); p++) {
+            digits = true;
+            if (mantissa < MANTISSA_LIMIT) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            } else {
+                truncated = truncated || *p != '0';
+            }
+        }
+    }
+    if (!digits) {
+        if (end != NULL) *end = (char*)string;
+        return 0;
+    }
+
+    //An 'e' only starts an exponent if digits follow it, so "2em" is 2 with units "em"
+    if (*p == 'e' || *p == 'E') {
+        const char* q = p + 1;
+        bool negativeExponent = (*q == '-');
+        if (*q == '+' || *q == '-') q++;
+        if (isDigit(*q)) {
+            int value = 0;
+            for (; isDigit(*q); q++) {
+                if (value < 100000) value = value * 10 + (*q - '0');
+            }
+            exponent += (negativeExponent ? -value : value);
+            p = q;
+        }
+    }
+    if (end != NULL) *end = (char*)p;
+
+    //Clinger's fast path: both operands are exact, so the double result is correctly rounded. It is in float's normal
+    //range, so converting it is only wrong if it landed exactly halfway between two floats, which strtof settles.
+    if (!truncated && mantissa <= EXACT_MANTISSA && exponent >= -EXACT_POWER && exponent <= EXACT_POWER) {
+        double value = (double)mantissa;
+        value = (exponent < 0 ? value / powersOfTen[-exponent] : value * powersOfTen[exponent]);
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        if ((bits & 0x1FFFFFFFULL) != 0x10000000ULL) {
+            float result = (float)value;
+            return (negative ? -result : result);
+        }
+    }
+    return slowParse(start, p - start);
+}
+
+float parseSVGLength(const char* string, char* units, size_t size) {
+    char* end = NULL;
+    float value = parseSVGNumber(string, &end);
+    if (units != NULL && size > 0) {
+        strncpy(units, end, size - 1);
+        units[size - 1] = '\0';
+    }
+    return value;
+}
@@ -0,0 +1,388 @@
+#include "PathGeometry.h"
+#include "StringBuffer.h"
+#include "NumberParser.h"
+#include "NumberFormat.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#define PATH_PI 3.14159265358979323846
+//Slots in a new geometry cache. Must be a power of two.
+#define GEOMETRY_CACHE_INITIAL_CAPACITY 64
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+/** Number of points each command adds to the x and y arrays. S and T add the control point they imply as well. **/
+static int pathCommandPointCount(unsigned char command) {
+    switch (toupper(command)) {
+        case 'C':
+        case 'S':
+            return 3;
+        case 'Q':
+        case 'T':
+            return 2;
+        case 'Z':
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+int pathCommandArgCount(unsigned char command) {
+    switch (toupper(command)) {
+        case 'M':
+        case 'L':
+        case 'T':
+            return 2;
+        case 'H':
+        case 'V':
+            return 1;
+        case 'C':
+            return 6;
+        case 'S':
+        case 'Q':
+            return 4;
+        case 'A':
+            return 7;
+        case 'Z':
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+/** Skips whitespace and commas **/
+static const char* skipSeparators(const char* p) {
+    while (isspace((unsigned char)*p) || *p == ',') p++;
+    return p;
+}
+
+/** True if p is at the start of a number **/
+static bool startsNumber(const char* p) {
+    return isdigit((unsigned char)*p) || *p == '.' || *p == '-' || *p == '+';
+}
+
+/** Reads one command's arguments into args. Arc flags may be written without separators, e.g. "a1 1 0 11 5 5".
+ * @return Position after the arguments, or NULL if they are malformed **/
+static const char* readPathArgs(const char* p, unsigned char command, float* args) {
+    int count = pathCommandArgCount(command);
+    bool arc = (toupper(command) == 'A');
+    for (int i = 0; i < count; i++) {
+        p = skipSeparators(p);
+        if (arc && (i == 3 || i == 4)) {
+            if (*p != '0' && *p != '1') return NULL;
+            args[i] = (float)(*p - '0');
+            p++;
+            continue;
+        }
+        char* end = NULL;
+        args[i] = parseSVGNumber(p, &end);
+        if (end == p) return NULL;
+        p = end;
+    }
+    return p;
+}
+
+/** Walks the path data once. With an empty geometry it only counts commands and args, otherwise it also stores them
+ * into the arrays, which must be big enough for the counts.
+ * @return -1 if the whole string was read, otherwise the offset of the token it stopped at **/
+static long tokenizePath(const char* data, PathGeometry* geometry) {
+    bool store = (geometry->commands != NULL);
+    float args[7];
+    unsigned char command = 0;
+    const char* p = data;
+    geometry->numCommands = 0;
+    geometry->numArgs = 0;
+    geometry->numPoints = 0;
+
+    while (*(p = skipSeparators(p)) != '\0') {
+        const char* token = p;
+        if (isalpha((unsigned char)*p)) {
+            command = *p;
+            if (pathCommandArgCount(command) < 0) return token - data;
+            p++;
+        } else if (command != 0 && pathCommandArgCount(command) > 0 && startsNumber(p)) {
+            //Numbers after a command repeat it, except that a moveto is followed by implicit linetos
+            if (command == 'M') command = 'L';
+            if (command == 'm') command = 'l';
+        } else {
+            return token - data;
+        }
+        //A path has to start with a moveto
+        if (geometry->numCommands == 0 && toupper(command) != 'M') return token - data;
+
+        int count = pathCommandArgCount(command);
+        if ((p = readPathArgs(p, command, args)) == NULL) return token - data;
+        if (store) {
+            geometry->commands[geometry->numCommands] = command;
+            memcpy(geometry->args + geometry->numArgs, args, count * sizeof(float));
+        }
+        geometry->numCommands++;
+        geometry->numArgs += count;
+        geometry->numPoints += pathCommandPointCount(command);
+    }
+    return -1;
+}
+
+PathGeometry* parsePathGeometry(const char* data, Arena* arena) {
+    PathGeometry counts = {0};
+    tokenizePath(data, &counts);
+
+    PathGeometry* geometry = NULL;
+    if (arena == NULL) {
+        geometry = calloc(1, sizeof(PathGeometry));
+        if (geometry == NULL) return NULL;
+        //+1 so that empty paths still get non NULL arrays
+        geometry->commands = malloc(counts.numCommands + 1);
+        geometry->args = malloc((counts.numArgs + 1) * sizeof(float));
+        geometry->x = malloc((counts.numPoints + 1) * sizeof(float));
+        geometry->y = malloc((counts.numPoints + 1) * sizeof(float));
+        if (geometry->commands == NULL || geometry->args == NULL || geometry->x == NULL || geometry->y == NULL) {
+            deletePathGeometry(geometry);
+            return NULL;
+        }
+    } else {
+        geometry = arenaAlloc(arena, sizeof(PathGeometry));
+        if (geometry == NULL) return NULL;
+        geometry->commands = arenaAlloc(arena, counts.numCommands + 1);
+        geometry->args = arenaAlloc(arena, (counts.numArgs + 1) * sizeof(float));
+        geometry->x = arenaAlloc(arena, (counts.numPoints + 1) * sizeof(float));
+        geometry->y = arenaAlloc(arena, (counts.numPoints + 1) * sizeof(float));
+        if (geometry->commands == NULL || geometry->args == NULL || geometry->x == NULL || geometry->y == NULL) return NULL;
+    }
+
+    geometry->errorOffset = tokenizePath(data, geometry);
+    computePathPoints(geometry);
+    return geometry;
+}
+
+/** True if angle is on the arc that starts at start and turns by sweep radians **/
+static bool angleOnArc(double angle, double start, double sweep) {
+    double offset = fmod((sweep >= 0 ? angle - start : start - angle), 2 * PATH_PI);
+    if (offset < 0) offset += 2 * PATH_PI;
+    return offset <= fabs(sweep);
+}
+
+/** Grows a box to contain an elliptical arc, converting it to center form as in the SVG spec's implementation notes.
+ * args are the arc command's rx, ry, x axis rotation, large arc flag and sweep flag. **/
+static void addArcBounds(BoundingBox* box, double x0, double y0, const float* args, double x1, double y1) {
+    double rx = fabs(args[0]), ry = fabs(args[1]);
+    if (rx == 0 || ry == 0 || (x0 == x1 && y0 == y1)) return;
+    double phi = args[2] * PATH_PI / 180.0, cosPhi = cos(phi), sinPhi = sin(phi);
+
+    //Midpoint in the ellipse's rotated frame
+    double px = cosPhi * (x0 - x1) / 2 + sinPhi * (y0 - y1) / 2;
+    double py = -sinPhi * (x0 - x1) / 2 + cosPhi * (y0 - y1) / 2;
+
+    //Radii too small to reach both ends are scaled up until they just do
+    double lambda = (px * px) / (rx * rx) + (py * py) / (ry * ry);
+    if (lambda > 1) {
+        rx *= sqrt(lambda);
+        ry *= sqrt(lambda);
+    }
+    double numerator = rx * rx * ry * ry - rx * rx * py * py - ry * ry * px * px;
+    double denominator = rx * rx * py * py + ry * ry * px * px;
+    double coefficient = sqrt(fmax(0, numerator / denominator)) * (args[3] == args[4] ? -1 : 1);
+    double centerPx = coefficient * rx * py / ry;
+    double centerPy = -coefficient * ry * px / rx;
+    double cx = cosPhi * centerPx - sinPhi * centerPy + (x0 + x1) / 2;
+    double cy = sinPhi * centerPx + cosPhi * centerPy + (y0 + y1) / 2;
+
+    double start = atan2((py - centerPy) / ry, (px - centerPx) / rx);
+    double sweep = atan2((-py - centerPy) / ry, (-px - centerPx) / rx) - start;
+    if (args[4] == 0 && sweep > 0) sweep -= 2 * PATH_PI;
+    if (args[4] != 0 && sweep < 0) sweep += 2 * PATH_PI;
+
+    //The ellipse is widest and tallest at these angles and the ones opposite them
+    double extremes[4];
+    extremes[0] = atan2(-ry * sinPhi, rx * cosPhi);
+    extremes[1] = extremes[0] + PATH_PI;
+    extremes[2] = atan2(ry * cosPhi, rx * sinPhi);
+    extremes[3] = extremes[2] + PATH_PI;
+    for (int i = 0; i < 4; i++) {
+        if (!angleOnArc(extremes[i], start, sweep)) continue;
+        double t = extremes[i];
+        boundsAddPoint(box, cx + rx * cosPhi * cos(t) - ry * sinPhi * sin(t), cy + rx * sinPhi * cos(t) + ry * cosPhi * sin(t));
+    }
+}
+
+void computePathPoints(PathGeometry* geometry) {
+    //Current point, and the start of the current subpath that closepath returns to
+    float currentX = 0, currentY = 0, startX = 0, startY = 0;
+    //Last control point of the previous command, which S and T reflect, and that command in upper case
+    float controlX = 0, controlY = 0;
+    unsigned char previous = 0;
+    const float* args = geometry->args;
+    int point = 0;
+    geometry->bounds = emptyBounds();
+
+    for (int i = 0; i < geometry->numCommands; i++) {
+        unsigned char command = geometry->commands[i];
+        bool relative = islower(command);
+        float baseX = (relative ? currentX : 0);
+        float baseY = (relative ? currentY : 0);
+        //S and T start with the reflection of the previous curve's last control point, or the current point if the
+        //previous command was not a curve of the same kind
+        int implied = 0;
+        if (toupper(command) == 'S' || toupper(command) == 'T') {
+            bool follows = (toupper(command) == 'S' ? previous == 'C' || previous == 'S' : previous == 'Q' || previous == 'T');
+            geometry->x[point] = (follows ? 2 * currentX - controlX : currentX);
+            geometry->y[point] = (follows ? 2 * currentY - controlY : currentY);
+            implied = 1;
+        }
+
+        switch (toupper(command)) {
+            case 'H':
+                currentX = baseX + args[0];
+                break;
+            case 'V':
+                currentY = baseY + args[0];
+                break;
+            case 'A':
+                addArcBounds(&geometry->bounds, currentX, currentY, args, baseX + args[5], baseY + args[6]);
+                currentX = baseX + args[5];
+                currentY = baseY + args[6];
+                break;
+            case 'Z':
+                currentX = startX;
+                currentY = startY;
+                break;
+            default:
+                //Control points then the end point, all relative to the point the command started from
+                for (int j = implied; j < pathCommandPointCount(command); j++) {
+                    geometry->x[point + j] = baseX + args[2 * (j - implied)];
+                    geometry->y[point + j] = baseY + args[2 * (j - implied) + 1];
+                }
+                point += pathCommandPointCount(command) - 1;
+                currentX = geometry->x[point];
+                currentY = geometry->y[point];
+                if (point > 0) {
+                    controlX = geometry->x[point - 1];
+                    controlY = geometry->y[point - 1];
+                }
+                break;
+        }
+        previous = toupper(command);
+        if (toupper(command) != 'Z') {
+            geometry->x[point] = currentX;
+            geometry->y[point] = currentY;
+            point++;
+        }
+        if (toupper(command) == 'M') {
+            startX = currentX;
+            startY = currentY;
+        }
+        args += pathCommandArgCount(command);
+    }
+    boundsAddPoints(&geometry->bounds, geometry->x, geometry->y, geometry->numPoints);
+}
+
+/** Writes a float with as few digits as still read back as the same value **/
+static void appendPathNumber(StringBuffer* buffer, float value) {
+    char text[NUMBER_FORMAT_SIZE];
+    formatNumber(text, value, NUMBER_SHORTEST);
+    bufferAppend(buffer, text);
+}
+
+char* pathGeometryToString(const PathGeometry* geometry) {
+    StringBuffer* buffer = createStringBuffer(0);
+    const float* args = geometry->args;
+
+    for (int i = 0; i < geometry->numCommands; i++) {
+        if (i > 0) bufferAppendChar(buffer, ' ');
+        bufferAppendChar(buffer, geometry->commands[i]);
+        int count = pathCommandArgCount(geometry->commands[i]);
+        for (int j = 0; j < count; j++) {
+            if (j > 0) bufferAppendChar(buffer, ' ');
+            appendPathNumber(buffer, args[j]);
+        }
+        args += count;
+    }
+    return bufferRelease(buffer);
+}
+
+void deletePathGeometry(PathGeometry* geometry) {
+    if (geometry == NULL) return;
+    free(geometry->commands);
+    free(geometry->args);
+    free(geometry->x);
+    free(geometry->y);
+    free(geometry);
+}
+
+static uint64_t hashPathData(const char* data, size_t* length) {
+    uint64_t hash = FNV_OFFSET;
+    const unsigned char* p = (const unsigned char*)data;
+    for (; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= FNV_PRIME;
+    }
+    *length = (size_t)(p - (const unsigned char*)data);
+    return hash;
+}
+
+/** Slot holding owner's entry, or the empty slot it belongs in **/
+static size_t findGeometrySlot(const PathGeometryCache* cache, const void* owner) {
+    size_t mask = cache->capacity - 1;
+    size_t slot = (size_t)((((uintptr_t)owner >> 4) * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+    while (cache->entries[slot].owner != NULL && cache->entries[slot].owner != owner) slot = (slot + 1) & mask;
+    return slot;
+}
+
+/** Doubles the table. False if malloc fails, leaving the cache as it was **/
+static bool growGeometryCache(PathGeometryCache* cache) {
+    PathGeometryCache grown = {calloc(cache->capacity * 2, sizeof(PathGeometryEntry)), cache->capacity * 2, cache->count};
+    if (grown.entries == NULL) return false;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        if (cache->entries[i].owner != NULL) grown.entries[findGeometrySlot(&grown, cache->entries[i].owner)] = cache->entries[i];
+    }
+    free(cache->entries);
+    *cache = grown;
+    return true;
+}
+
+PathGeometryCache* createPathGeometryCache(void) {
+    PathGeometryCache* cache = calloc(1, sizeof(PathGeometryCache));
+    if (cache == NULL) return NULL;
+    cache->capacity = GEOMETRY_CACHE_INITIAL_CAPACITY;
+    cache->entries = calloc(cache->capacity, sizeof(PathGeometryEntry));
+    if (cache->entries == NULL) {
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+PathGeometry* getCachedPathGeometry(PathGeometryCache* cache, const void* owner, const char* data) {
+    size_t length = 0;
+    uint64_t hash = hashPathData(data, &length);
+    PathGeometryEntry* entry = &cache->entries[findGeometrySlot(cache, owner)];
+    if (entry->owner == owner) {
+        if (entry->length == length && entry->hash == hash) return entry->geometry;
+    } else {
+        if (2 * (cache->count + 1) > cache->capacity) {
+            if (!growGeometryCache(cache)) return NULL;
+            entry = &cache->entries[findGeometrySlot(cache, owner)];
+        }
+    }
+
+    PathGeometry* geometry = parsePathGeometry(data, NULL);
+    if (geometry == NULL) return NULL;
+    if (entry->owner == NULL) cache->count++;
+    deletePathGeometry(entry->geometry);
+    *entry = (PathGeometryEntry){owner, geometry, length, hash};
+    return geometry;
+}
+
+void updateCachedPathData(PathGeometryCache* cache, const void* owner, const char* data) {
+    PathGeometryEntry* entry = &cache->entries[findGeometrySlot(cache, owner)];
+    if (entry->owner == owner) entry->hash = hashPathData(data, &entry->length);
+}
+
+void freePathGeometryCache(PathGeometryCache* cache) {
+    if (cache == NULL) return;
+    for (size_t i = 0; i < cache->capacity; i++) deletePathGeometry(cache->entries[i].geometry);
+    free(cache->entries);
+    free(cache);
+}
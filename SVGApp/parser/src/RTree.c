@@ -0,0 +1,250 @@
+#include "RTree.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+//Children per node
+#define RTREE_NODE_SIZE 16
+//The overflow list may hold this many entries, or an eighth of the tree if that is more, before a repack
+#define RTREE_MIN_OVERFLOW 64
+//Deep enough for any tree that fits in memory: each level visited adds at most RTREE_NODE_SIZE nodes
+#define RTREE_STACK_SIZE (RTREE_NODE_SIZE * 32)
+
+static int compareCenterX(const BoundingBox* a, const BoundingBox* b) {
+    float first = a->minX + a->maxX, second = b->minX + b->maxX;
+    return (first > second) - (first < second);
+}
+
+static int compareCenterY(const BoundingBox* a, const BoundingBox* b) {
+    float first = a->minY + a->maxY, second = b->minY + b->maxY;
+    return (first > second) - (first < second);
+}
+
+//qsort callbacks. bounds is the first member of both entries and nodes.
+static int compareEntriesX(const void* a, const void* b) {
+    return compareCenterX(&((const RTreeEntry*)a)->bounds, &((const RTreeEntry*)b)->bounds);
+}
+
+static int compareEntriesY(const void* a, const void* b) {
+    return compareCenterY(&((const RTreeEntry*)a)->bounds, &((const RTreeEntry*)b)->bounds);
+}
+
+static int compareNodesX(const void* a, const void* b) {
+    return compareCenterX(&((const RTreeNode*)a)->bounds, &((const RTreeNode*)b)->bounds);
+}
+
+static int compareNodesY(const void* a, const void* b) {
+    return compareCenterY(&((const RTreeNode*)a)->bounds, &((const RTreeNode*)b)->bounds);
+}
+
+/** Sort-Tile-Recursive ordering: sort by x, cut into vertical slices of whole nodes, and sort each slice by y,
+ * so that every run of RTREE_NODE_SIZE items is spatially compact **/
+static void sortTiles(void* items, int count, size_t size, int (*byX)(const void*, const void*),
+                      int (*byY)(const void*, const void*)) {
+    qsort(items, count, size, byX);
+    int parents = (count + RTREE_NODE_SIZE - 1) / RTREE_NODE_SIZE;
+    int slices = (int)ceil(sqrt((double)parents));
+    int sliceSize = slices * RTREE_NODE_SIZE;
+    for (int start = 0; start < count; start += sliceSize) {
+        int length = (count - start < sliceSize ? count - start : sliceSize);
+        qsort((char*)items + start * size, length, size, byY);
+    }
+}
+
+/** Appends a node whose children are children[first, first + count) **/
+static bool addNode(RTree* tree, int* nodeCapacity, int first, int count, bool leaf) {
+    if (tree->numNodes == *nodeCapacity) {
+        int capacity = (*nodeCapacity == 0 ? 16 : *nodeCapacity * 2);
+        RTreeNode* nodes = realloc(tree->nodes, capacity * sizeof(RTreeNode));
+        if (nodes == NULL) return false;
+        tree->nodes = nodes;
+        *nodeCapacity = capacity;
+    }
+
+    RTreeNode* node = &tree->nodes[tree->numNodes++];
+    node->first = first;
+    node->count = count;
+    node->leaf = leaf;
+    node->bounds = emptyBounds();
+    for (int i = first; i < first + count; i++) {
+        boundsAddBox(&node->bounds, leaf ? tree->entries[i].bounds : tree->nodes[i].bounds);
+    }
+    return true;
+}
+
+/** Rebuilds the hash table from the current entries **/
+static bool rebuildTable(RTree* tree);
+
+/** Bulk loads every live entry, emptying the overflow list **/
+static bool packTree(RTree* tree) {
+    //Drop stale entries
+    int live = 0;
+    for (int i = 0; i < tree->numEntries; i++) {
+        if (!tree->entries[i].stale) tree->entries[live++] = tree->entries[i];
+    }
+    tree->numEntries = live;
+    tree->numPacked = live;
+    tree->numStale = 0;
+
+    free(tree->nodes);
+    tree->nodes = NULL;
+    tree->numNodes = 0;
+    int nodeCapacity = 0;
+
+    if (live > 0) {
+        //Leaves over the entries, then each level over the one below until a single root is left
+        sortTiles(tree->entries, live, sizeof(RTreeEntry), compareEntriesX, compareEntriesY);
+        for (int i = 0; i < live; i += RTREE_NODE_SIZE) {
+            if (!addNode(tree, &nodeCapacity, i, (live - i < RTREE_NODE_SIZE ? live - i : RTREE_NODE_SIZE), true)) return false;
+        }
+        int levelStart = 0;
+        while (tree->numNodes - levelStart > 1) {
+            int levelEnd = tree->numNodes;
+            sortTiles(tree->nodes + levelStart, levelEnd - levelStart, sizeof(RTreeNode), compareNodesX, compareNodesY);
+            for (int i = levelStart; i < levelEnd; i += RTREE_NODE_SIZE) {
+                if (!addNode(tree, &nodeCapacity, i, (levelEnd - i < RTREE_NODE_SIZE ? levelEnd - i : RTREE_NODE_SIZE), false)) return false;
+            }
+            levelStart = levelEnd;
+        }
+    }
+    return rebuildTable(tree);
+}
+
+/** Table slot for a data pointer: where it is, or the empty slot it would go in **/
+static int findSlot(const RTree* tree, const void* data) {
+    uintptr_t hash = ((uintptr_t)data >> 4) * (uintptr_t)0x9E3779B97F4A7C15ULL;
+    int mask = tree->tableSize - 1;
+    int slot = (int)(hash & mask);
+    while (tree->keys[slot] != NULL && tree->keys[slot] != data) slot = (slot + 1) & mask;
+    return slot;
+}
+
+static bool rebuildTable(RTree* tree) {
+    int size = 16;
+    while (size < 2 * tree->capacity) size *= 2;
+
+    void** keys = calloc(size, sizeof(void*));
+    int* slots = malloc(size * sizeof(int));
+    if (keys == NULL || slots == NULL) {
+        free(keys);
+        free(slots);
+        return false;
+    }
+    free(tree->keys);
+    free(tree->slots);
+    tree->keys = keys;
+    tree->slots = slots;
+    tree->tableSize = size;
+
+    for (int i = 0; i < tree->numEntries; i++) {
+        int slot = findSlot(tree, tree->entries[i].data);
+        tree->keys[slot] = tree->entries[i].data;
+        tree->slots[slot] = i;
+    }
+    return true;
+}
+
+/** Appends an entry to the overflow list, repacking the tree if the list has grown too long **/
+static void appendEntry(RTree* tree, int type, void* data, BoundingBox bounds) {
+    if (tree->numEntries == tree->capacity) {
+        int capacity = (tree->capacity == 0 ? 16 : tree->capacity * 2);
+        RTreeEntry* entries = realloc(tree->entries, capacity * sizeof(RTreeEntry));
+        if (entries == NULL) return;
+        tree->entries = entries;
+        tree->capacity = capacity;
+        //Keep the table at most half full
+        if (!rebuildTable(tree)) return;
+    }
+
+    RTreeEntry* entry = &tree->entries[tree->numEntries];
+    entry->bounds = bounds;
+    entry->type = type;
+    entry->data = data;
+    entry->stale = false;
+    int slot = findSlot(tree, data);
+    tree->keys[slot] = data;
+    tree->slots[slot] = tree->numEntries++;
+
+    int overflow = tree->numEntries - tree->numPacked;
+    int limit = (tree->numPacked / 8 > RTREE_MIN_OVERFLOW ? tree->numPacked / 8 : RTREE_MIN_OVERFLOW);
+    if (overflow > limit) packTree(tree);
+}
+
+RTree* createRTree(const RTreeEntry* entries, int count) {
+    RTree* tree = calloc(1, sizeof(RTree));
+    if (tree == NULL) return NULL;
+
+    tree->capacity = (count < 16 ? 16 : count);
+    tree->entries = malloc(tree->capacity * sizeof(RTreeEntry));
+    if (tree->entries == NULL) {
+        free(tree);
+        return NULL;
+    }
+    if (count > 0) memcpy(tree->entries, entries, count * sizeof(RTreeEntry));
+    tree->numEntries = count;
+
+    if (!packTree(tree)) {
+        freeRTree(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+void rtreeInsert(RTree* tree, int type, void* data, BoundingBox bounds) {
+    appendEntry(tree, type, data, bounds);
+}
+
+void rtreeUpdate(RTree* tree, void* data, BoundingBox bounds) {
+    int slot = findSlot(tree, data);
+    if (tree->keys[slot] == NULL) return;
+
+    RTreeEntry* entry = &tree->entries[tree->slots[slot]];
+    if (tree->slots[slot] >= tree->numPacked) {
+        //Overflow entries are not in any node, so they can just be changed
+        entry->bounds = bounds;
+        return;
+    }
+    //Node boxes are not shrunk, the old entry is hidden and a new one goes in the overflow list
+    entry->stale = true;
+    tree->numStale++;
+    appendEntry(tree, entry->type, data, bounds);
+}
+
+void rtreeSearch(RTree* tree, BoundingBox area, Vector* results) {
+    if (tree->numNodes > 0) {
+        int stack[RTREE_STACK_SIZE];
+        int depth = 0;
+        stack[depth++] = tree->numNodes - 1;
+        while (depth > 0) {
+            RTreeNode* node = &tree->nodes[stack[--depth]];
+            if (!boundsIntersect(node->bounds, area)) continue;
+
+            for (int i = node->first; i < node->first + node->count; i++) {
+                if (!node->leaf) {
+                    stack[depth++] = i;
+                } else if (!tree->entries[i].stale && boundsIntersect(tree->entries[i].bounds, area)) {
+                    insertBackVector(results, &tree->entries[i]);
+                }
+            }
+        }
+    }
+
+    for (int i = tree->numPacked; i < tree->numEntries; i++) {
+        if (boundsIntersect(tree->entries[i].bounds, area)) insertBackVector(results, &tree->entries[i]);
+    }
+}
+
+void rtreeSearchPoint(RTree* tree, float x, float y, Vector* results) {
+    BoundingBox point = {x, y, x, y};
+    rtreeSearch(tree, point, results);
+}
+
+void freeRTree(RTree* tree) {
+    if (tree == NULL) return;
+    free(tree->entries);
+    free(tree->nodes);
+    free(tree->keys);
+    free(tree->slots);
+    free(tree);
+}
@@ -2,9 +2,47 @@
  * Student ID: 1037025
  * Email: nrosati@uoguelph.ca*/
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "SVGParser.h"
 #include "Helper.h"
 #include <math.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <limits.h>
+#include <ctype.h>
+#include <stdint.h>
+
+/*Compiled schemas, kept between calls so each XSD is only parsed once. See acquireSchema.
+  The built in schema types these depend on are only released by xmlCleanupParser, so that must not be called per request.*/
+List* schemaCache = NULL;
+pthread_mutex_t schemaCacheLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_once_t libraryInitOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Initializes libxml2 once for the whole process. Every public entry point calls this, so calling it is optional,
+ * but a multithreaded caller should call it from the main thread before starting other threads.
+ * @post libxml2 global state is initialized and stays alive until cleanupSVGParser.
+ */
+void initSVGParser() {
+    pthread_once(&libraryInitOnce, initLibraries);
+}
+
+/**pthread_once callback for initSVGParser*/
+void initLibraries() {
+    xmlInitParser();
+}
+
+/**
+ * Releases the schema cache and libxml2 global state. Call once at shutdown, when no other thread is using the library.
+ * @post The library must not be used again in this process.
+ */
+void cleanupSVGParser() {
+    clearSchemaCache();
+    xmlCleanupParser();
+}
 
 /**
  * Creates an SVGimage from a SVG file.
@@ -13,49 +51,246 @@
  * @return A fully populated SVGimage struct.
  */
 SVGimage* createSVGimage(char* fileName) {
-    xmlDoc* document = xmlReadFile(fileName, NULL, 0);
-    //Return NULL if the parsing failed
-    if (document == NULL) {
-        xmlCleanupParser();
-        return NULL;
+    return loadSVGimage(fileName, NULL, false);
+}
+
+/**
+ * Creates an SVGimage from a SVG file, with the image and all its components allocated from one arena.
+ * @post A SVGimage struct is created and returned if the given file was valid XML. NULL otherwise.
+ * @param fileName A path to a svg file.
+ * @return A fully populated SVGimage struct.
+ */
+SVGimage* createSVGimageInArena(char* fileName) {
+    return loadSVGimage(fileName, NULL, true);
+}
+
+/**
+ * Loads an SVGimage by streaming a file, optionally validating it in the same pass.
+ * @param fileName A path to a svg file.
+ * @param schemaFile A path to the schema to validate against, or NULL to skip validation.
+ * @param useArena True to allocate the image from an arena, false to allocate each struct on the heap.
+ * @return A fully populated SVGimage struct, or NULL if the file could not be parsed or was not valid.
+ */
+SVGimage* loadSVGimage(char* fileName, char* schemaFile, bool useArena) {
+    initSVGParser();
+    //The file is mapped once, and the identity hash, the parser and the validator all read the mapping
+    MappedFile* input = openMappedFile(fileName);
+    if (input == NULL) return NULL;
+
+    FileIdentity identity;
+    bool identified = (schemaFile != NULL &&
+                       getContentIdentity(input->data, input->size, input->mtimeSec, input->mtimeNsec, schemaFile, &identity));
+    SVGimage* image = loadMappedSVGimage(input, fileName, schemaFile, NULL, identified ? &identity : NULL, useArena);
+    closeMappedFile(input);
+    return image;
+}
+
+/**
+ * Loads an SVGimage from a file that is already mapped. A validated file that is unchanged since its last load is
+ * mapped back from its snapshot when an arena image was asked for, otherwise it is streamed and a snapshot is saved
+ * for next time if there is none for its current contents. A snapshot image lives in an arena, so heap images are
+ * always streamed.
+ * @param input The mapped file.
+ * @param fileName The path input was mapped from, used for error messages and to find the snapshot.
+ * @param schemaFile A path to the schema to validate against, or NULL to skip validation.
+ * @param schema The compiled schemaFile if the caller already holds it, or NULL to acquire it only when needed.
+ * @param identity The identity of input and schemaFile, or NULL to neither use nor save a snapshot.
+ * @param useArena True to allocate the image from an arena, false to allocate each struct on the heap.
+ * @return A fully populated SVGimage struct, or NULL if the file could not be parsed or was not valid.
+ */
+SVGimage* loadMappedSVGimage(MappedFile* input, char* fileName, char* schemaFile, SchemaCacheEntry* schema,
+                             const FileIdentity* identity, bool useArena) {
+    SVGimage* image = (identity != NULL && useArena ? loadSVGsnapshot(fileName, identity) : NULL);
+    if (image != NULL) return image;
+
+    SchemaCacheEntry* acquired = NULL;
+    if (schema == NULL && schemaFile != NULL && (schema = acquired = acquireSchema(schemaFile)) == NULL) return NULL;
+
+    image = streamSVGimage(input, fileName, schema, useArena);
+    releaseSchema(acquired);
+    //Only the first validated load of a file writes its snapshot, so repeated heap loads do not rewrite it
+    if (image != NULL && identity != NULL && !matchesSVGsnapshot(fileName, identity)) saveSVGsnapshot(image, fileName, identity);
+    return image;
+}
+
+/**
+ * Streams a mapped file into an SVGimage, validating it against an already compiled schema.
+ * Safe to call from several threads with the same schema, since each call makes its own validation context.
+ * @param input The mapped file.
+ * @param fileName The path input was mapped from, used as the document's URL.
+ * @param schema The schema to validate against, or NULL to skip validation. It is not released.
+ * @param useArena True to allocate the image from an arena, false to allocate each struct on the heap.
+ * @return A fully populated SVGimage struct, or NULL if the file could not be parsed or was not valid.
+ */
+SVGimage* streamSVGimage(MappedFile* input, char* fileName, SchemaCacheEntry* schema, bool useArena) {
+    //Stream the mapping instead of building a DOM, so only the current element is held in memory
+    SVGimage* image = NULL;
+    xmlTextReader* reader = readerForMappedFile(input, fileName);
+    xmlSchemaValidCtxt* validator = (schema == NULL ? NULL : xmlSchemaNewValidCtxt(schema->schema));
+
+    //Validation happens while streaming, in the same pass that builds the image
+    if (reader != NULL && (schema == NULL || (validator != NULL && xmlTextReaderSchemaValidateCtxt(reader, validator, 0) == 0))) {
+        image = readSVGimage(reader, useArena ? createArena(0) : NULL);
+        if (image != NULL && schema != NULL && xmlTextReaderIsValid(reader) != 1) {
+            //SVG file is not valid
+            deleteSVGimage(image);
+            image = NULL;
+        }
+    }
+
+    if (reader != NULL) xmlFreeTextReader(reader);
+    if (validator != NULL) xmlSchemaFreeValidCtxt(validator);
+    return image;
+}
+
+/**
+ * Counts the components of a mapped file. A file with a snapshot is counted from the snapshot, which is already
+ * validated and cheaper to map back than to parse. Otherwise the file is streamed through without building an
+ * SVGimage, validating it in the same pass.
+ * @param input The mapped file.
+ * @param fileName The path input was mapped from, used as the document's URL and to find the snapshot.
+ * @param schemaFile A path to the schema to validate against.
+ * @param schema The compiled schemaFile if the caller already holds it, or NULL to acquire it only when needed.
+ * @param identity The identity of input and schemaFile, or NULL to not use a snapshot.
+ * @param counts Set to the counts SVGtoJSON would report for the file's image.
+ * @return True if the file was counted, false if it could not be parsed or was not valid.
+ */
+bool countMappedSVGcomponents(MappedFile* input, char* fileName, char* schemaFile, SchemaCacheEntry* schema,
+                              const FileIdentity* identity, ComponentCounts* counts) {
+    SVGimage* snapshot = (identity != NULL ? loadSVGsnapshot(fileName, identity) : NULL);
+    if (snapshot != NULL) {
+        countImageComponents(snapshot, counts);
+        deleteSVGimage(snapshot);
+        return true;
+    }
+
+    SchemaCacheEntry* acquired = NULL;
+    if (schema == NULL && (schema = acquired = acquireSchema(schemaFile)) == NULL) return false;
+    bool counted = streamSVGcounts(input, fileName, schema, counts);
+    releaseSchema(acquired);
+    return counted;
+}
+
+/**
+ * Streams a mapped file, counting its components and validating it against an already compiled schema.
+ * Safe to call from several threads with the same schema, since each call makes its own validation context.
+ * @param input The mapped file.
+ * @param fileName The path input was mapped from, used as the document's URL.
+ * @param schema The schema to validate against, or NULL to skip validation. It is not released.
+ * @param counts Set to the counts SVGtoJSON would report for the file's image.
+ * @return True if the file was counted, false if it could not be parsed or was not valid.
+ */
+bool streamSVGcounts(MappedFile* input, char* fileName, SchemaCacheEntry* schema, ComponentCounts* counts) {
+    bool counted = false;
+    xmlTextReader* reader = readerForMappedFile(input, fileName);
+    xmlSchemaValidCtxt* validator = (schema == NULL ? NULL : xmlSchemaNewValidCtxt(schema->schema));
+
+    if (reader != NULL && (schema == NULL || (validator != NULL && xmlTextReaderSchemaValidateCtxt(reader, validator, 0) == 0))) {
+        counted = readSVGcounts(reader, counts) && (schema == NULL || xmlTextReaderIsValid(reader) == 1);
+    }
+
+    if (reader != NULL) xmlFreeTextReader(reader);
+    if (validator != NULL) xmlSchemaFreeValidCtxt(validator);
+    return counted;
+}
+
+/**
+ * Creates a streaming reader over a mapped file.
+ * @param input The mapped file.
+ * @param fileName The path input was mapped from, used as the document's URL.
+ * @return The reader, or NULL if it could not be created.
+ */
+xmlTextReader* readerForMappedFile(MappedFile* input, char* fileName) {
+    //Gzip compressed files, e.g. from writeSVGimageCompressed, are decompressed by libxml2 as it reads the file itself
+    if (input->size >= 2 && (unsigned char)input->data[0] == 0x1f && (unsigned char)input->data[1] == 0x8b) {
+        return xmlReaderForFile(fileName, NULL, 0);
+    }
+    //libxml2 takes the length as an int
+    if (input->size > INT_MAX) return NULL;
+    return xmlReaderForMemory(input->data, (int)input->size, fileName, NULL, 0);
+}
+
+/**
+ * Checks a mapped file against a schema in one streaming pass, without building an image.
+ * @param input The mapped file.
+ * @param fileName The path input was mapped from, used as the document's URL.
+ * @param schemaFile Schema file to validate the xml file against.
+ * @return True if the file is well formed and valid, false otherwise.
+ */
+bool validateMappedSVG(MappedFile* input, char* fileName, char* schemaFile) {
+    SchemaCacheEntry* schema = acquireSchema(schemaFile);
+    xmlTextReader* reader = (schema == NULL ? NULL : readerForMappedFile(input, fileName));
+    xmlSchemaValidCtxt* validator = (schema == NULL ? NULL : xmlSchemaNewValidCtxt(schema->schema));
+
+    int status = -1;
+    if (reader != NULL && validator != NULL && xmlTextReaderSchemaValidateCtxt(reader, validator, 0) == 0) {
+        while ((status = xmlTextReaderRead(reader)) == 1);
     }
+    bool valid = (status == 0 && xmlTextReaderIsValid(reader) == 1);
+
+    if (reader != NULL) xmlFreeTextReader(reader);
+    if (validator != NULL) xmlSchemaFreeValidCtxt(validator);
+    releaseSchema(schema);
+    return valid;
+}
+
+/**
+ * Creates an SVGimage from an already parsed XML document. The document is not freed.
+ * @pre document should not be NULL.
+ * @post A SVGimage struct is created from the root node of the document.
+ * @param document A parsed SVG XML document.
+ * @return A fully populated SVGimage struct, or NULL if the document has no root element.
+ */
+SVGimage* createSVGimageFromDoc(xmlDoc* document) {
+    if (document == NULL) return NULL;
 
     xmlNode* rootNode = xmlDocGetRootElement(document);
+    if (rootNode == NULL) return NULL;
     SVGimage* image = calloc(1, sizeof(SVGimage));
 
     //Use strncpy to leave the null terminator
-    strncpy(image->namespace, (char*)rootNode->ns->href, 255);
+    if (rootNode->ns != NULL) strncpy(image->namespace, (char*)rootNode->ns->href, 255);
 
     image->rectangles = initializeList(rectangleToString, deleteRectangle, compareRectangles);
     image->circles = initializeList(circleToString, deleteCircle, compareCircles);
     image->paths = initializeList(pathToString, deletePath, comparePaths);
     image->groups = initializeList(groupToString, deleteGroup, compareGroups);
-    image->otherAttributes = initializeList(attributeToString, deleteAttribute, compareAttributes);
+    image->otherAttributes = initializeAttributeList(NULL, image->strings);
 
+    //The document's names stay where they are until it is freed, so they can be looked up by address
+    KeywordCache names;
+    initKeywordCache(&names);
     for (xmlNode* currNode = rootNode->children; currNode != NULL; currNode = currNode->next) {
-        if (strcmp((char*)currNode->name, "rect") == 0) {
-            addRectangle(currNode, image->rectangles);
-        } else if (strcmp((char*)currNode->name, "circle") == 0) {
-            addCircle(currNode, image->circles);
-        } else if (strcmp((char*)currNode->name, "path") == 0) {
-            addPath(currNode, image->paths);
-        } else if (strcmp((char*)currNode->name, "g") == 0) {
-            addGroup(currNode, image->groups);
-        } else if (strcmp((char*)currNode->name, "title") == 0) {
-            //Use strncpy to leave the null terminator
-            strncpy(image->title, (char*)currNode->children->content, 255);
-        } else if (strcmp((char*)currNode->name, "desc") == 0) {
-            //Use strncpy to leave the null terminator
-            strncpy(image->description, (char*)currNode->children->content, 255);
+        switch (lookupCachedKeyword(&names, (char*)currNode->name)) {
+            case KEYWORD_RECT:
+                addRectangle(currNode, image->rectangles, &names, image->strings);
+                break;
+            case KEYWORD_CIRCLE:
+                addCircle(currNode, image->circles, &names, image->strings);
+                break;
+            case KEYWORD_PATH:
+                addPath(currNode, image->paths, &names, image->strings);
+                break;
+            case KEYWORD_G:
+                addGroup(currNode, image->groups, &names, image->strings);
+                break;
+            case KEYWORD_TITLE:
+                //Use strncpy to leave the null terminator
+                strncpy(image->title, (char*)currNode->children->content, 255);
+                break;
+            case KEYWORD_DESC:
+                //Use strncpy to leave the null terminator
+                strncpy(image->description, (char*)currNode->children->content, 255);
+                break;
+            default:
+                break;
         }
     }
 
     for (xmlAttr* attrNode = rootNode->properties; attrNode != NULL; attrNode = attrNode->next) {
-        insertBack(image->otherAttributes, makeAttribute(attrNode));
+        insertBack(image->otherAttributes, makeAttribute(attrNode, &names, image->strings));
     }
 
-    xmlFreeDoc(document);
-    xmlCleanupParser();
     return image;
 }
 
@@ -67,55 +302,128 @@ SVGimage* createSVGimage(char* fileName) {
  * @return A string describing the image.
  */
 char* SVGimageToString(SVGimage* img) {
-    char* desc = calloc(strlen(img->namespace) + strlen(img->title) + strlen(img->description) + 512,
-                        sizeof(char)); //Extra bytes for \0's and extra words in the next line
-    sprintf(desc, "[BEGIN SVG]\n[NAMESPACE]\n%s\n[TITLE]\n%s\n[DESCRIPTION]\n%s", img->namespace, img->title,
-            img->description);
+    StringBuffer* buffer = createStringBuffer(0);
+    writeSVGimageText(buffer, img);
+    return bufferRelease(buffer);
+}
 
-    char* listDesc = NULL;
-    //Get description of the root node attributes (the svg node)
-    if (img->otherAttributes->length > 0) {
-        listDesc = toString(img->otherAttributes);
-        desc = realloc(desc, strlen(desc) + strlen(listDesc) + 8);
-        strcat(desc, listDesc);
-        free(listDesc);
-    }
+/**
+ * Writes the same description as SVGimageToString to a file, without building the whole string in memory.
+ * @pre img should not be NULL. file should be open for writing.
+ * @param img A pointer to a SVGimage struct.
+ * @param file The file to write to.
+ * @return true if the description was written, false on a write or memory error.
+ */
+bool SVGimageToFile(SVGimage* img, FILE* file) {
+    StringBuffer* buffer = createFileBuffer(file);
+    if (buffer == NULL) return false;
+    writeSVGimageText(buffer, img);
+    bool written = bufferFlush(buffer);
+    freeStringBuffer(buffer);
+    return written;
+}
 
-    //Get description for the rectangles in the base image
-    if (img->rectangles->length > 0) {
-        listDesc = toString(img->rectangles);
-        desc = realloc(desc, strlen(desc) + strlen(listDesc) + 8);
-        strcat(desc, listDesc);
-        free(listDesc);
-    }
+/**
+ * Appends the description of an image to a buffer, walking every component once.
+ * @param out The buffer to append to.
+ * @param img The image.
+ */
+void writeSVGimageText(StringBuffer* out, SVGimage* img) {
+    bufferAppend(out, "[BEGIN SVG]\n[NAMESPACE]\n");
+    bufferAppend(out, img->namespace);
+    bufferAppend(out, "\n[TITLE]\n");
+    bufferAppend(out, img->title);
+    bufferAppend(out, "\n[DESCRIPTION]\n");
+    bufferAppend(out, img->description);
+
+    //Root node attributes (the svg node), then the components in the base image. Groups recurse into their children.
+    writeListText(out, img->otherAttributes, writeAttributeText);
+    writeListText(out, img->rectangles, writeRectangleText);
+    writeListText(out, img->circles, writeCircleText);
+    writeListText(out, img->paths, writePathText);
+    writeListText(out, img->groups, writeGroupText);
+    bufferAppend(out, "[END SVG]\n");
+}
 
-    //Get description for the circles in the base image
-    if (img->circles->length > 0) {
-        listDesc = toString(img->circles);
-        desc = realloc(desc, strlen(desc) + strlen(listDesc) + 8);
-        strcat(desc, listDesc);
-        free(listDesc);
+/**
+ * Appends the descriptions of every element in a list to a buffer, each after a newline, like toString.
+ * @param out The buffer to append to.
+ * @param list The list.
+ * @param writeElement Function that appends one element's description to the buffer.
+ */
+void writeListText(StringBuffer* out, List* list, void (*writeElement)(StringBuffer* out, const void* data)) {
+    for (Node* node = list->head; node != NULL; node = node->next) {
+        bufferAppendChar(out, '\n');
+        writeElement(out, node->data);
     }
+}
 
-    //Get description for the paths in the base image
-    if (img->paths->length > 0) {
-        listDesc = toString(img->paths);
-        desc = realloc(desc, strlen(desc) + strlen(listDesc) + 8);
-        strcat(desc, listDesc);
-        free(listDesc);
-    }
+/**
+ * Appends the description of an Attribute to a buffer.
+ * @param out The buffer to append to.
+ * @param data void pointer to an Attribute struct.
+ */
+void writeAttributeText(StringBuffer* out, const void* data) {
+    const Attribute* attribute = data;
+    bufferAppend(out, "[BEGIN ATTRIBUTE]\nname: ");
+    bufferAppend(out, attribute->name);
+    bufferAppend(out, "\nvalue: ");
+    bufferAppend(out, attribute->value);
+    bufferAppend(out, "\n[END ATTRIBUTE]\n");
+}
 
-    //Get description for the groups. This is recursive to groups in groups.
-    if (img->groups->length > 0) {
-        listDesc = toString(img->groups);
-        desc = realloc(desc, strlen(desc) + strlen(listDesc) + 8);
-        strcat(desc, listDesc);
-        free(listDesc);
-    }
+/**
+ * Appends the description of a Rectangle to a buffer.
+ * @param out The buffer to append to.
+ * @param data void pointer to a Rectangle struct.
+ */
+void writeRectangleText(StringBuffer* out, const void* data) {
+    const Rectangle* rectangle = data;
+    bufferPrintf(out, "[BEGIN RECTANGLE]\nx: %.2f\ny: %.2f\nwidth: %.2f\nheight: %.2f\nunits: %s\n",
+                 rectangle->x, rectangle->y, rectangle->width, rectangle->height, rectangle->units);
+    writeListText(out, rectangle->otherAttributes, writeAttributeText);
+    bufferAppend(out, "[END RECTANGLE]\n");
+}
 
-    desc = realloc(desc, strlen(desc) + 16);
-    strcat(desc, "[END SVG]\n");
-    return desc;
+/**
+ * Appends the description of a Circle to a buffer.
+ * @param out The buffer to append to.
+ * @param data void pointer to a Circle struct.
+ */
+void writeCircleText(StringBuffer* out, const void* data) {
+    const Circle* circle = data;
+    bufferPrintf(out, "[BEGIN CIRCLE]\ncx: %.2f\ncy: %.2f\nr: %.2f\nunits: %s\n", circle->cx, circle->cy, circle->r,
+                 circle->units);
+    writeListText(out, circle->otherAttributes, writeAttributeText);
+    bufferAppend(out, "[END CIRCLE]\n");
+}
+
+/**
+ * Appends the description of a Path to a buffer.
+ * @param out The buffer to append to.
+ * @param data void pointer to a Path struct.
+ */
+void writePathText(StringBuffer* out, const void* data) {
+    const Path* path = data;
+    bufferAppend(out, "[BEGIN PATH]\nd: ");
+    bufferAppend(out, path->data);
+    writeListText(out, path->otherAttributes, writeAttributeText);
+    bufferAppend(out, "[END PATH]\n");
+}
+
+/**
+ * Appends the description of a Group and everything in it to a buffer.
+ * @param out The buffer to append to.
+ * @param data void pointer to a Group struct.
+ */
+void writeGroupText(StringBuffer* out, const void* data) {
+    const Group* group = data;
+    bufferAppend(out, "[BEGIN GROUP]");
+    writeListText(out, group->rectangles, writeRectangleText);
+    writeListText(out, group->circles, writeCircleText);
+    writeListText(out, group->paths, writePathText);
+    writeListText(out, group->groups, writeGroupText);
+    bufferAppend(out, "[END GROUP]\n");
 }
 
 /**
@@ -126,43 +434,32 @@ char* SVGimageToString(SVGimage* img) {
  */
 void deleteSVGimage(SVGimage* img) {
     if (img == NULL) return;
+    deleteImageIndex(img->index);
+    //The image struct itself lives in its arena, everything goes at once
+    if (img->arena != NULL) {
+        freeArena(img->arena);
+        return;
+    }
     freeList(img->rectangles);
     freeList(img->circles);
     freeList(img->paths);
     freeList(img->groups);
     freeList(img->otherAttributes);
+    //After the lists, since the attributes in them point into the pool
+    freeStringPool(img->strings);
     free(img);
 }
 
 /**
- * Creates a list of ALL the circles in the image.
+ * Creates a list of ALL the rectangles in the image.
  * @pre img can be NULL or point to a SVGimage struct.
- * @post A list containing 0 or more Nodes of all the circles in the image.
+ * @post A list containing 0 or more Nodes of all the rectangles in the image.
  * @param img pointer to a SVGimage struct.
- * @return A list containing all of the circles in the image.
+ * @return A list containing all of the rectangles in the image.
  */
 List* getRects(SVGimage* img) {
     if (img == NULL) return NULL;
-
-    List* allRectangles = initializeList(rectangleToString, dummy, compareRectangles);
-
-    //Start with the circles in the img
-    for (Node* node = img->rectangles->head; node != NULL; node = node->next) {
-        insertBack(allRectangles, node->data);
-    }
-
-    //Go through the groups and add their rectangles
-    List* groups = getGroups(img);
-    for (Node* node = groups->head; node != NULL; node = node->next) {
-        if (((Group*)(node->data))->rectangles->length > 0) {
-            for (Node* rectangleNode = ((Group*)(node->data))->rectangles->head; rectangleNode !=
-                                                                                 NULL; rectangleNode = rectangleNode->next) {
-                insertBack(allRectangles, rectangleNode->data);
-            }
-        }
-    }
-    freeList(groups);
-    return allRectangles;
+    return flatViewToList(img, RECT);
 }
 
 /**
@@ -174,30 +471,12 @@ List* getRects(SVGimage* img) {
  */
 List* getCircles(SVGimage* img) {
     if (img == NULL) return NULL;
-
-    List* allCircles = initializeList(circleToString, dummy, compareCircles);
-
-    //Start with the circles in the img
-    for (Node* node = img->circles->head; node != NULL; node = node->next) {
-        insertBack(allCircles, node->data);
-    }
-
-    //Go through the groups and add their circles
-    List* groups = getGroups(img);
-    for (Node* node = groups->head; node != NULL; node = node->next) {
-        if (((Group*)(node->data))->circles->length > 0) {
-            for (Node* circleNode = ((Group*)(node->data))->circles->head; circleNode !=
-                                                                           NULL; circleNode = circleNode->next) {
-                insertBack(allCircles, circleNode->data);
-            }
-        }
-    }
-    freeList(groups);
-    return allCircles;
+    return flatViewToList(img, CIRC);
 }
 
 /**
- * Creates a list of ALL the groups in the image. This function calls a recursive function to get groups that are in groups.
+ * Creates a list of ALL the groups in the image, including groups that are in groups.
+ * Nested groups come before the group that contains them.
  * @pre img can be NULL or point to a SVGimage struct.
  * @post A list containing 0 or more Nodes of all the Groups in the image.
  * @param img A SVGimage struct.
@@ -205,32 +484,7 @@ List* getCircles(SVGimage* img) {
  */
 List* getGroups(SVGimage* img) {
     if (img == NULL) return NULL;
-
-    List* allGroups = initializeList(groupToString, dummy, compareGroups);
-    //Starts with the groups in the img
-    ListIterator iterator = createIterator(img->groups);
-    Group* g = nextElement(&iterator);
-    while (g != NULL) {
-        getGroupsHelper(allGroups, g);
-        insertBack(allGroups, g);
-        g = nextElement(&iterator);
-    }
-    return allGroups;
-}
-
-/**
- * Helper to the above getGroups function. This function is recursive to get groups in groups [...].
- * @param masterList Main Groups list to add more groups to.
- * @param groupRoot Node in a list to act as a root node. Other groups nodes will become a groupNode when called recursively.
- */
-void getGroupsHelper(List* masterList, Group* groupRoot) {
-    ListIterator iterator = createIterator(groupRoot->groups);
-    Group* g = nextElement(&iterator);
-    while (g != NULL) {
-        getGroupsHelper(masterList, g);
-        insertBack(masterList, g);
-        g = nextElement(&iterator);
-    }
+    return flatViewToList(img, GROUP);
 }
 
 /**
@@ -242,25 +496,7 @@ void getGroupsHelper(List* masterList, Group* groupRoot) {
  */
 List* getPaths(SVGimage* img) {
     if (img == NULL) return NULL;
-
-    List* allPaths = initializeList(pathToString, dummy, comparePaths);
-
-    //Start by adding paths in the img
-    for (Node* node = img->paths->head; node != NULL; node = node->next) {
-        insertBack(allPaths, node->data);
-    }
-
-    //Go through the groups and add their paths
-    List* groups = getGroups(img);
-    for (Node* node = groups->head; node != NULL; node = node->next) {
-        if (((Group*)(node->data))->paths->length > 0) {
-            for (Node* pathNode = ((Group*)(node->data))->paths->head; pathNode != NULL; pathNode = pathNode->next) {
-                insertBack(allPaths, pathNode->data);
-            }
-        }
-    }
-    freeList(groups);
-    return allPaths;
+    return flatViewToList(img, PATH);
 }
 
 /**
@@ -275,13 +511,14 @@ int numRectsWithArea(SVGimage* img, float area) {
     if (img == NULL) return 0;
 
     int count = 0;
-    List* allRectangles = getRects(img);
-    for (Node* currentRect = allRectangles->head; currentRect != NULL; currentRect = currentRect->next) {
-        if (ceilf(((Rectangle*)currentRect->data)->width * ((Rectangle*)currentRect->data)->height) == ceilf(area)) {
+    const ComponentViews* views = getComponentViews(img);
+    if (views == NULL) return 0;
+    for (int i = 0; i < views->rectangles->length; i++) {
+        Rectangle* rectangle = views->rectangles->data[i];
+        if (ceilf(rectangle->width * rectangle->height) == ceilf(area)) {
             count++;
         }
     }
-    freeList(allRectangles);
     return count;
 }
 
@@ -297,16 +534,17 @@ int numCirclesWithArea(SVGimage* img, float area) {
     if (img == NULL) return 0;
 
     int count = 0;
-    List* allCircles = getCircles(img);
 
     //This feels gross but its the only way I could get it to work
     //Gets the ceiling of the given area and area of a circle, then rounded to ints because floats are weird.
     int areaRound = ceilf(area);
-    for (Node* currentCircle = allCircles->head; currentCircle != NULL; currentCircle = currentCircle->next) {
-        int radSquareRound = ceilf(((Circle*)currentCircle->data)->r * ((Circle*)currentCircle->data)->r * PI);
+    const ComponentViews* views = getComponentViews(img);
+    if (views == NULL) return 0;
+    for (int i = 0; i < views->circles->length; i++) {
+        Circle* circle = views->circles->data[i];
+        int radSquareRound = ceilf(circle->r * circle->r * PI);
         if (radSquareRound == areaRound) count++;
     }
-    freeList(allCircles);
     return count;
 }
 
@@ -322,13 +560,13 @@ int numPathsWithdata(SVGimage* img, char* data) {
     if (img == NULL) return 0;
 
     int count = 0;
-    List* allPaths = getPaths(img);
-    for (Node* currentPath = allPaths->head; currentPath != NULL; currentPath = currentPath->next) {
-        if (strcmp(((Path*)(currentPath->data))->data, data) == 0) {
+    const ComponentViews* views = getComponentViews(img);
+    if (views == NULL) return 0;
+    for (int i = 0; i < views->paths->length; i++) {
+        if (strcmp(((Path*)views->paths->data[i])->data, data) == 0) {
             count++;
         }
     }
-    freeList(allPaths);
     return count;
 }
 
@@ -344,17 +582,18 @@ int numGroupsWithLen(SVGimage* img, int len) {
     if (img == NULL) return 0;
 
     int count = 0;
-    List* allGroups = getGroups(img);
-    for (Node* currentGroup = allGroups->head; currentGroup != NULL; currentGroup = currentGroup->next) {
+    const ComponentViews* views = getComponentViews(img);
+    if (views == NULL) return 0;
+    for (int i = 0; i < views->groups->length; i++) {
+        Group* group = views->groups->data[i];
         //Add the number of rectangles, circles, paths, and groups of the node.
-        int currentGroupLength = ((Group*)currentGroup->data)->rectangles->length +
-                                 ((Group*)currentGroup->data)->circles->length +
-                                 ((Group*)currentGroup->data)->paths->length +
-                                 ((Group*)currentGroup->data)->groups->length;
+        int currentGroupLength = group->rectangles->length +
+                                 group->circles->length +
+                                 group->paths->length +
+                                 group->groups->length;
 
         if (currentGroupLength == len) count++;
     }
-    freeList(allGroups);
     return count;
 }
 
@@ -371,34 +610,28 @@ int numAttr(SVGimage* img) {
     //Start the count of attributes with the number in the base image.
     int count = img->otherAttributes->length;
 
+    const ComponentViews* views = getComponentViews(img);
+    if (views == NULL) return 0;
+
     //Add the number of attributes in the rectangles
-    List* list = getRects(img);
-    for (Node* node = list->head; node != NULL; node = node->next) {
-        count += ((Rectangle*)(node->data))->otherAttributes->length;
+    for (int i = 0; i < views->rectangles->length; i++) {
+        count += ((Rectangle*)views->rectangles->data[i])->otherAttributes->length;
     }
-    freeList(list);
 
     //Add the number of attributes in the circles
-    list = getCircles(img);
-    for (Node* node = list->head; node != NULL; node = node->next) {
-        count += ((Circle*)(node->data))->otherAttributes->length;
+    for (int i = 0; i < views->circles->length; i++) {
+        count += ((Circle*)views->circles->data[i])->otherAttributes->length;
     }
-    freeList(list);
 
     //Add the number of attributes in the paths
-    list = getPaths(img);
-    for (Node* node = list->head; node != NULL; node = node->next) {
-        count += ((Path*)(node->data))->otherAttributes->length;
+    for (int i = 0; i < views->paths->length; i++) {
+        count += ((Path*)views->paths->data[i])->otherAttributes->length;
     }
-    freeList(list);
 
     //Add the number of attributes in the groups (and their subgroups)
-    list = getGroups(img);
-    for (Node* node = list->head; node != NULL; node = node->next) {
-        count += ((Group*)(node->data))->otherAttributes->length;
+    for (int i = 0; i < views->groups->length; i++) {
+        count += ((Group*)views->groups->data[i])->otherAttributes->length;
     }
-
-    freeList(list);
     return count;
 }
 
@@ -422,10 +655,9 @@ void deleteAttribute(void* data) {
  * @return A string representation of the given Attribute.
  */
 char* attributeToString(void* data) {
-    char* tmpDesc = calloc(strlen(((Attribute*)data)->name) + strlen(((Attribute*)data)->value) + 64, sizeof(char));
-    sprintf(tmpDesc, "[BEGIN ATTRIBUTE]\nname: %s\nvalue: %s\n[END ATTRIBUTE]\n", ((Attribute*)data)->name,
-            ((Attribute*)data)->value);
-    return tmpDesc;
+    StringBuffer* buffer = createStringBuffer(0);
+    writeAttributeText(buffer, data);
+    return bufferRelease(buffer);
 }
 
 /**Unused Attribute compare*/
@@ -456,45 +688,9 @@ void deleteGroup(void* data) {
  * @return A string representation of the given Group.
  */
 char* groupToString(void* data) {
-    char* desc = calloc(32, sizeof(char));
-    sprintf(desc, "[BEGIN GROUP]");
-    char* listDesc = NULL;
-
-    //Do toString for rectangles
-    if (((Group*)data)->rectangles->length > 0) {
-        listDesc = toString(((Group*)data)->rectangles);
-        desc = realloc(desc, strlen(desc) + strlen(listDesc) + 8);
-        strcat(desc, listDesc);
-        free(listDesc);
-    }
-
-    //Do toString for circles
-    if (((Group*)data)->circles->length > 0) {
-        listDesc = toString(((Group*)data)->circles);
-        desc = realloc(desc, strlen(desc) + strlen(listDesc) + 8);
-        strcat(desc, listDesc);
-        free(listDesc);
-    }
-
-    //Do toString for paths
-    if (((Group*)data)->paths->length > 0) {
-        listDesc = toString(((Group*)data)->paths);
-        desc = realloc(desc, strlen(desc) + strlen(listDesc) + 8);
-        strcat(desc, listDesc);
-        free(listDesc);
-    }
-
-    //Do toString for nested groups
-    if (((Group*)data)->groups->length > 0) {
-        listDesc = toString(((Group*)data)->groups);
-        desc = realloc(desc, strlen(desc) + strlen(listDesc) + 8);
-        strcat(desc, listDesc);
-        free(listDesc);
-    }
-
-    desc = realloc(desc, strlen(desc) + 16);
-    strcat(desc, "[END GROUP]\n");
-    return desc;
+    StringBuffer* buffer = createStringBuffer(0);
+    writeGroupText(buffer, data);
+    return bufferRelease(buffer);
 }
 
 /**Unused Group compare*/
@@ -521,20 +717,9 @@ void deleteRectangle(void* data) {
  * @return A string representation of the given Rectangle.
  */
 char* rectangleToString(void* data) {
-    char* tmpDesc = calloc(128, sizeof(char));
-    sprintf(tmpDesc, "[BEGIN RECTANGLE]\nx: %.2f\ny: %.2f\nwidth: %.2f\nheight: %.2f\nunits: %s\n",
-            ((Rectangle*)data)->x, ((Rectangle*)data)->y, ((Rectangle*)data)->width, ((Rectangle*)data)->height,
-            ((Rectangle*)data)->units);
-
-    //Get string descriptions for other attributes, dynamic sizing
-    if (((Rectangle*)data)->otherAttributes->length > 0) {
-        char* listDesc = toString(((Rectangle*)data)->otherAttributes);
-        tmpDesc = realloc(tmpDesc, sizeof(char) * (strlen(tmpDesc) + strlen(listDesc) + 32));
-        strcat(tmpDesc, listDesc);
-        free(listDesc);
-    }
-    strcat(tmpDesc, "[END RECTANGLE]\n");
-    return tmpDesc;
+    StringBuffer* buffer = createStringBuffer(0);
+    writeRectangleText(buffer, data);
+    return bufferRelease(buffer);
 }
 
 /**Unused rectablge compare*/
@@ -561,19 +746,9 @@ void deleteCircle(void* data) {
  * @return A string representation of the given Circle.
  */
 char* circleToString(void* data) {
-    char* tmpDesc = calloc(128, sizeof(char));
-    sprintf(tmpDesc, "[BEGIN CIRCLE]\ncx: %.2f\ncy: %.2f\nr: %.2f\nunits: %s\n", ((Circle*)data)->cx,
-            ((Circle*)data)->cy, ((Circle*)data)->r, ((Circle*)data)->units);
-
-    //Get string descriptions for other attributes, dynamic sizing
-    if (((Circle*)data)->otherAttributes->length > 0) {
-        char* listDesc = toString(((Circle*)data)->otherAttributes);
-        tmpDesc = realloc(tmpDesc, sizeof(char) * (strlen(tmpDesc) + strlen(listDesc) + 32));
-        strcat(tmpDesc, listDesc);
-        free(listDesc);
-    }
-    strcat(tmpDesc, "[END CIRCLE]\n");
-    return tmpDesc;
+    StringBuffer* buffer = createStringBuffer(0);
+    writeCircleText(buffer, data);
+    return bufferRelease(buffer);
 }
 
 /**Unused circle compare*/
@@ -593,6 +768,40 @@ void deletePath(void* data) {
     free(data);
 }
 
+/**
+ * Gets the parsed form of a path's data, parsing it on first use. The geometry is kept in the image, not the path,
+ * and is parsed again whenever the path's data no longer hashes to what it was parsed from.
+ * @param image The image the path is in.
+ * @param path The path.
+ * @return The path's geometry, owned by the image. NULL if memory could not be allocated.
+ */
+PathGeometry* getPathGeometry(SVGimage* image, Path* path) {
+    if (image == NULL || path == NULL) return NULL;
+    if (image->index == NULL && (image->index = calloc(1, sizeof(SVGindex))) == NULL) return NULL;
+    if (image->index->geometry == NULL && (image->index->geometry = createPathGeometryCache()) == NULL) return NULL;
+    return getCachedPathGeometry(image->index->geometry, path, path->data);
+}
+
+/**
+ * Records that a path's geometry args were edited in place. The points are recomputed and the d string is
+ * regenerated now, so writing or validating the image never has to change it.
+ * @param image The image the path is in.
+ * @param path The path.
+ */
+void pathGeometryChanged(SVGimage* image, Path* path) {
+    PathGeometry* geometry = getPathGeometry(image, path);
+    if (geometry == NULL) return;
+    computePathPoints(geometry);
+    char* data = pathGeometryToString(geometry);
+    if (data == NULL) return;
+    path->data = replaceString(path->otherAttributes->arena, path->data, data);
+    free(data);
+    updateCachedPathData(image->index->geometry, path, path->data);
+
+    image->index->boundsValid = false;
+    if (image->index->spatial != NULL) rtreeUpdate(image->index->spatial, path, geometry->bounds);
+}
+
 /**
  * C equivalent of a Java toString, but for Paths
  * @pre data should point to a Path struct.
@@ -601,18 +810,9 @@ void deletePath(void* data) {
  * @return A string representation of the given Path.
  */
 char* pathToString(void* data) {
-    char* tmpDesc = calloc(strlen(((Path*)data)->data) + 64, sizeof(char));
-    sprintf(tmpDesc, "[BEGIN PATH]\nd: %s", ((Path*)data)->data);
-
-    //Get string descriptions for other attributes, dynamic sizing
-    if (((Path*)data)->otherAttributes->length > 0) {
-        char* listDesc = toString(((Path*)data)->otherAttributes);
-        tmpDesc = realloc(tmpDesc, sizeof(char) * (strlen(tmpDesc) + strlen(listDesc) + 32));
-        strcat(tmpDesc, listDesc);
-        free(listDesc);
-    }
-    strcat(tmpDesc, "[END PATH]\n");
-    return tmpDesc;
+    StringBuffer* buffer = createStringBuffer(0);
+    writePathText(buffer, data);
+    return bufferRelease(buffer);
 }
 
 /**Unused path compare*/
@@ -625,31 +825,34 @@ int comparePaths(const void* first, const void* second) {
  * @post A Rectangle is created, filled, and appended to the list.
  * @param node xmlNode of a path element.
  * @param list List of rectangles to add the new Path to.
+ * @param names Keyword cache for the document's names, shared by the whole conversion.
+ * @param strings The image's string pool, which the new attributes are interned in, or NULL to copy them.
  */
-void addRectangle(xmlNode* node, List* list) {
+void addRectangle(xmlNode* node, List* list, KeywordCache* names, StringPool* strings) {
     Rectangle* rectToAdd = calloc(1, sizeof(Rectangle));
-    rectToAdd->otherAttributes = initializeList(attributeToString, deleteAttribute, compareAttributes);
-    //Needed for strtof
-    char* units = NULL;
+    rectToAdd->otherAttributes = initializeAttributeList(NULL, strings);
 
     for (xmlAttr* attrNode = node->properties; attrNode != NULL; attrNode = attrNode->next) {
-        if (strcmp((char*)attrNode->name, "x") == 0) {
-            /*This first case gives strtof the `units` field because we only care about the first element having units.
-              If the fist has no units, we assume none do. And if the first has units, we assume the same for all elements.*/
-            rectToAdd->x = strtof((char*)attrNode->children->content, &units);
-        } else if (strcmp((char*)attrNode->name, "y") == 0) {
-            rectToAdd->y = strtof((char*)attrNode->children->content, NULL);
-        } else if (strcmp((char*)attrNode->name, "width") == 0) {
-            rectToAdd->width = strtof((char*)attrNode->children->content, NULL);
-        } else if (strcmp((char*)attrNode->name, "height") == 0) {
-            rectToAdd->height = strtof((char*)attrNode->children->content, NULL);
-        } else {
-            insertBack(rectToAdd->otherAttributes, makeAttribute(attrNode));
+        switch (lookupCachedKeyword(names, (char*)attrNode->name)) {
+            case KEYWORD_X:
+                /*This first case keeps the units because we only care about the first element having units.
+                  If the fist has no units, we assume none do. And if the first has units, we assume the same for all elements.*/
+                rectToAdd->x = parseSVGLength((char*)attrNode->children->content, rectToAdd->units, sizeof(rectToAdd->units));
+                break;
+            case KEYWORD_Y:
+                rectToAdd->y = parseSVGNumber((char*)attrNode->children->content, NULL);
+                break;
+            case KEYWORD_WIDTH:
+                rectToAdd->width = parseSVGNumber((char*)attrNode->children->content, NULL);
+                break;
+            case KEYWORD_HEIGHT:
+                rectToAdd->height = parseSVGNumber((char*)attrNode->children->content, NULL);
+                break;
+            default:
+                insertBack(rectToAdd->otherAttributes, makeAttribute(attrNode, names, strings));
+                break;
         }
     }
-    //Use strncpy to leave the null terminator
-    if (units != NULL) strncpy(rectToAdd->units, units, 49);
-
     insertBack(list, rectToAdd);
 }
 
@@ -659,29 +862,31 @@ void addRectangle(xmlNode* node, List* list) {
  * @post A Circle is created, filled, and appended to the list.
  * @param node xmlNode of a circle element.
  * @param list List of circles to add the new Path to.
+ * @param names Keyword cache for the document's names, shared by the whole conversion.
+ * @param strings The image's string pool, which the new attributes are interned in, or NULL to copy them.
  */
-void addCircle(xmlNode* node, List* list) {
+void addCircle(xmlNode* node, List* list, KeywordCache* names, StringPool* strings) {
     Circle* circleToAdd = calloc(1, sizeof(Circle));
-    circleToAdd->otherAttributes = initializeList(attributeToString, deleteAttribute, compareAttributes);
-    //Needed for strtof
-    char* units = NULL;
+    circleToAdd->otherAttributes = initializeAttributeList(NULL, strings);
 
     for (xmlAttr* attrNode = node->properties; attrNode != NULL; attrNode = attrNode->next) {
-        if (strcmp((char*)attrNode->name, "cx") == 0) {
-            /*This first case gives strtof the `units` field because we only care about the first element having units.
-              If the fist has no units, we assume none do. And if the first has units, we assume the same for all elements.*/
-            circleToAdd->cx = strtof((char*)attrNode->children->content, &units);
-        } else if (strcmp((char*)attrNode->name, "cy") == 0) {
-            circleToAdd->cy = strtof((char*)attrNode->children->content, NULL);
-        } else if (strcmp((char*)attrNode->name, "r") == 0) {
-            circleToAdd->r = strtof((char*)attrNode->children->content, NULL);
-        } else {
-            insertBack(circleToAdd->otherAttributes, makeAttribute(attrNode));
+        switch (lookupCachedKeyword(names, (char*)attrNode->name)) {
+            case KEYWORD_CX:
+                /*This first case keeps the units because we only care about the first element having units.
+                  If the fist has no units, we assume none do. And if the first has units, we assume the same for all elements.*/
+                circleToAdd->cx = parseSVGLength((char*)attrNode->children->content, circleToAdd->units, sizeof(circleToAdd->units));
+                break;
+            case KEYWORD_CY:
+                circleToAdd->cy = parseSVGNumber((char*)attrNode->children->content, NULL);
+                break;
+            case KEYWORD_R:
+                circleToAdd->r = parseSVGNumber((char*)attrNode->children->content, NULL);
+                break;
+            default:
+                insertBack(circleToAdd->otherAttributes, makeAttribute(attrNode, names, strings));
+                break;
         }
     }
-    //Use strncpy to leave the null terminator
-    if (units != NULL) strncpy(circleToAdd->units, units, 49);
-
     insertBack(list, circleToAdd);
 }
 
@@ -691,17 +896,19 @@ void addCircle(xmlNode* node, List* list) {
  * @post A Path is created, filled, and appended to the list.
  * @param node xmlNode of a path element.
  * @param list List of paths to add the new Path to.
+ * @param names Keyword cache for the document's names, shared by the whole conversion.
+ * @param strings The image's string pool, which the new attributes are interned in, or NULL to copy them.
  */
-void addPath(xmlNode* node, List* list) {
+void addPath(xmlNode* node, List* list, KeywordCache* names, StringPool* strings) {
     Path* pathToAdd = calloc(1, sizeof(Path));
-    pathToAdd->otherAttributes = initializeList(attributeToString, deleteAttribute, compareAttributes);
+    pathToAdd->otherAttributes = initializeAttributeList(NULL, strings);
 
     for (xmlAttr* attrNode = node->properties; attrNode != NULL; attrNode = attrNode->next) {
-        if (strcmp((char*)attrNode->name, "d") == 0) {
+        if (lookupCachedKeyword(names, (char*)attrNode->name) == KEYWORD_D) {
             pathToAdd->data = calloc(strlen((char*)attrNode->children->content) + 1, sizeof(char));
             strcpy(pathToAdd->data, (char*)attrNode->children->content);
         } else {
-            insertBack(pathToAdd->otherAttributes, makeAttribute(attrNode));
+            insertBack(pathToAdd->otherAttributes, makeAttribute(attrNode, names, strings));
         }
     }
 
@@ -714,36 +921,45 @@ void addPath(xmlNode* node, List* list) {
  * @post A Group struct is created, filled, and appended to the list.
  * @param node xmlNode of a group element.
  * @param list List of groups to add the new Group to.
+ * @param names Keyword cache for the document's names, shared by the whole conversion.
+ * @param strings The image's string pool, which the new attributes are interned in, or NULL to copy them.
  */
-void addGroup(xmlNode* node, List* list) {
+void addGroup(xmlNode* node, List* list, KeywordCache* names, StringPool* strings) {
     Group* groupToAdd = calloc(1, sizeof(Group));
     groupToAdd->rectangles = initializeList(rectangleToString, deleteRectangle, compareRectangles);
     groupToAdd->circles = initializeList(circleToString, deleteCircle, compareCircles);
     groupToAdd->paths = initializeList(pathToString, deletePath, comparePaths);
     groupToAdd->groups = initializeList(groupToString, deleteGroup, compareGroups);
-    groupToAdd->otherAttributes = initializeList(attributeToString, deleteAttribute, compareAttributes);
+    groupToAdd->otherAttributes = initializeAttributeList(NULL, strings);
 
     for (xmlNode* currNode = node->children; currNode != NULL; currNode = currNode->next) {
-        if (strcmp((char*)currNode->name, "rect") == 0) {
-            addRectangle(currNode, groupToAdd->rectangles);
-        } else if (strcmp((char*)currNode->name, "circle") == 0) {
-            addCircle(currNode, groupToAdd->circles);
-        } else if (strcmp((char*)currNode->name, "path") == 0) {
-            addPath(currNode, groupToAdd->paths);
-        } else if (strcmp((char*)currNode->name, "g") == 0) {
-            addGroup(currNode, groupToAdd->groups);
-        } else if (strcmp((char*)currNode->name, "title") == 0) {
-            /*currNode casted to xmlAttr to avoid compiler warnings.
-              Both xmlAttr and xmlNode have a `name` and `children` field though,
-              making it perfectly fine to do this.*/
-            insertBack(groupToAdd->otherAttributes, makeAttribute((xmlAttr*)currNode));
-        } else if (strcmp((char*)currNode->name, "desc") == 0) {
-            insertBack(groupToAdd->otherAttributes, makeAttribute((xmlAttr*)currNode));
+        switch (lookupCachedKeyword(names, (char*)currNode->name)) {
+            case KEYWORD_RECT:
+                addRectangle(currNode, groupToAdd->rectangles, names, strings);
+                break;
+            case KEYWORD_CIRCLE:
+                addCircle(currNode, groupToAdd->circles, names, strings);
+                break;
+            case KEYWORD_PATH:
+                addPath(currNode, groupToAdd->paths, names, strings);
+                break;
+            case KEYWORD_G:
+                addGroup(currNode, groupToAdd->groups, names, strings);
+                break;
+            case KEYWORD_TITLE:
+            case KEYWORD_DESC:
+                /*currNode casted to xmlAttr to avoid compiler warnings.
+                  Both xmlAttr and xmlNode have a `name` and `children` field though,
+                  making it perfectly fine to do this.*/
+                insertBack(groupToAdd->otherAttributes, makeAttribute((xmlAttr*)currNode, names, strings));
+                break;
+            default:
+                break;
         }
     }
 
     for (xmlAttr* attrNode = node->properties; attrNode != NULL; attrNode = attrNode->next) {
-        insertBack(groupToAdd->otherAttributes, makeAttribute(attrNode));
+        insertBack(groupToAdd->otherAttributes, makeAttribute(attrNode, names, strings));
     }
 
     insertBack(list, groupToAdd);
@@ -752,107 +968,634 @@ void addGroup(xmlNode* node, List* list) {
 /**
  * Fully populates an Attribute struct, given the associated xmlAttr node.
  * @pre attrNode cannot be NULL.
- * @post Attribute struct allocated and populated.
+ * @post Attribute struct allocated and populated, with its name and value interned.
  * @param attrNode xmlAttr node.
+ * @param names Keyword cache for the document's names.
+ * @param strings The image's string pool.
  * @return Populated Attribute struct.
  */
-Attribute* makeAttribute(xmlAttr* attrNode) {
-    Attribute* attrToAdd = calloc(1, sizeof(Attribute));
-    attrToAdd->name = calloc(strlen((char*)attrNode->name) + 1, sizeof(char));
-    attrToAdd->value = calloc(strlen((char*)attrNode->children->content) + 1, sizeof(char));
-    strcpy(attrToAdd->name, (char*)attrNode->name);
-    strcpy(attrToAdd->value, (char*)attrNode->children->content);
-    return attrToAdd;
+Attribute* makeAttribute(xmlAttr* attrNode, KeywordCache* names, StringPool* strings) {
+    const char* name = (char*)attrNode->name;
+    return newInternedAttribute(NULL, strings, lookupCachedKeyword(names, name), name, (char*)attrNode->children->content);
 }
 
 /**
- * Dummy function, used in getter delete list initializers.
+ * Creates an Attribute struct from a name and value, copying both strings.
+ * @pre name and value cannot be NULL.
+ * @param name Attribute name.
+ * @param value Attribute value.
+ * @return Populated Attribute struct.
  */
-void dummy() {}
+Attribute* newAttribute(const char* name, const char* value) {
+    return newAttributeIn(NULL, name, value);
+}
 
 /**
- * Creates a valid SVG image struct.
- * @param fileName File name for the XML document.
- * @param schemaFile Schema file to validate the xml file against. Expected to be an SVG schema file.
- * @return A valid SVGimage struct if the given XML document is valid SVG, NULL otherwise.
+ * Creates an Attribute struct from a name and value, allocating the struct and both strings from an arena.
+ * @pre name and value cannot be NULL.
+ * @param arena Arena to allocate from, or NULL for the heap.
+ * @param name Attribute name.
+ * @param value Attribute value.
+ * @return Populated Attribute struct.
  */
-SVGimage* createValidSVGimage(char* fileName, char* schemaFile) {
-    /*Return NULL if:
-        -fileName or schemaFile is NULL
-        -fileName does not have a .svg extension
-        -schemaFile does not have a .xsd extension*/
-    if ((fileName == NULL || schemaFile == NULL) ||
-        (strcmp(".xsd", schemaFile + (strlen(schemaFile) - 4)) != 0) ||
-        (strcmp(".svg", fileName + (strlen(fileName) - 4)) != 0) ||
-        !fileExists(fileName) || !fileExists(schemaFile)) return NULL;
-
-    SVGimage* image = NULL;
-    xmlDoc* doc = xmlReadFile(fileName, NULL, 0);
-    if (doc == NULL) {
-        xmlCleanupParser();
-        return NULL;
-    }
-    int ret = validateXMLwithXSD(doc, schemaFile);
-    xmlCleanupParser();
-    xmlFreeDoc(doc);
-    if (ret == 0) /*SVG file is valid*/ image = createSVGimage(fileName);
-    return image;
+Attribute* newAttributeIn(Arena* arena, const char* name, const char* value) {
+    Attribute* attrToAdd = allocateIn(arena, sizeof(Attribute));
+    attrToAdd->name = copyStringIn(arena, name);
+    attrToAdd->value = copyStringIn(arena, value);
+    return attrToAdd;
 }
 
 /**
- * Validate an SVGimage against a XSD file.
- * @param image The SVGimage to validate.
- * @param schemaFile File name for the XML XSD file to use.
- * @return True is the SVGimage is valid, false otherwise
+ * Creates an Attribute whose name and value are shared through an image's string pool instead of copied.
+ * Without a pool it is an ordinary Attribute with its own copies, as newAttributeIn makes.
+ * @pre name and value cannot be NULL.
+ * @param arena Arena to allocate the struct from, or NULL for the heap.
+ * @param strings The image's string pool, or NULL to copy the strings.
+ * @param keyword The name's keyword, or KEYWORD_UNKNOWN.
+ * @param name Attribute name.
+ * @param value Attribute value.
+ * @return Populated Attribute struct, to go in a list made by initializeAttributeList with the same pool.
  */
-bool validateSVGimage(SVGimage* image, char* schemaFile) {
-    if (schemaFile == NULL || image == NULL) return false;
+Attribute* newInternedAttribute(Arena* arena, StringPool* strings, SVGKeyword keyword, const char* name, const char* value) {
+    if (strings == NULL) return newAttributeIn(arena, name, value);
+    Attribute* attrToAdd = allocateIn(arena, sizeof(Attribute));
+    attrToAdd->name = (char*)internName(strings, keyword, name);
+    attrToAdd->value = (char*)internString(strings, value);
+    return attrToAdd;
+}
 
-    //Header constraint checks
-    if (!validateRects(image->rectangles) ||
-        !validateCircles(image->circles) ||
-        !validatePaths(image->paths) ||
-        !validateGroups(image->groups) ||
-        !validateAttributes(image->otherAttributes)) return false;
+/**
+ * Interns an attribute name. Names in the keyword table use the table's own string, so they cost no memory and
+ * every image agrees on their address.
+ * @param strings The image's string pool, for names that are not keywords.
+ * @param keyword The name's keyword, or KEYWORD_UNKNOWN.
+ * @param name The name.
+ * @return The shared copy of the name.
+ */
+const char* internName(StringPool* strings, SVGKeyword keyword, const char* name) {
+    return (keyword != KEYWORD_UNKNOWN ? keywordName(keyword) : internString(strings, name));
+}
 
-    //XSD checking
-    xmlDoc* imageDoc = imageToXML(image);
-    int ret = validateXMLwithXSD(imageDoc, schemaFile);
-    xmlFreeDoc(imageDoc);
+/**
+ * Creates an empty list of Attributes for a component.
+ * @param arena The arena the component is allocated from, or NULL for the heap.
+ * @param strings The image's string pool if its attributes are interned, or NULL if each owns its strings.
+ * @return The list.
+ */
+List* initializeAttributeList(Arena* arena, StringPool* strings) {
+    void (*deleteFunction)(void* toBeDeleted) = (strings != NULL ? deleteInternedAttribute : deleteAttribute);
+    return initializeListInArena(attributeToString, deleteFunction, compareAttributes, arena);
+}
 
-    return (ret == 0 ? true : false);
+/**
+ * Frees an Attribute made by newInternedAttribute. Its strings belong to the image's pool, so only the struct is freed.
+ * @param data void pointer to a Attribute struct.
+ */
+void deleteInternedAttribute(void* data) {
+    free(data);
 }
 
 /**
- * Validate the given rectangles list against constraints outlined in the header.
- * @param list List of elements.
- * @return True if the list elements are valid, false otherwise.
+ * Checks if a list holds interned attributes, i.e. it was made by the parser rather than by the caller.
+ * @param list List of Attributes.
+ * @return True if the names and values in the list are in the image's string pool.
  */
-bool validateRects (List* list) {
-    if (list == NULL) return false;
+bool isInternedList(const List* list) {
+    return list->deleteData == deleteInternedAttribute;
+}
 
-    ListIterator iter = createIterator(list);
-    Rectangle* rect = NULL;
-    while ((rect = nextElement(&iter)) != NULL) {
-        if (rect->units == NULL || rect->otherAttributes == NULL || !validateAttributes(rect->otherAttributes)) return false;
+/**
+ * Replaces the value of an attribute in a list. In an interned list the pool's copy is shared if it has one.
+ * @param list The list the attribute is in.
+ * @param strings The image's string pool.
+ * @param attribute The attribute to change.
+ * @param value The new value, which is copied.
+ */
+void setAttributeValue(List* list, StringPool* strings, Attribute* attribute, const char* value) {
+    if (isInternedList(list)) {
+        attribute->value = shareString(list->arena, strings, value);
+    } else {
+        attribute->value = replaceString(list->arena, attribute->value, value);
     }
-    return true;
 }
 
 /**
- * Validate the given circles list against constraints outlined in the header.
- * @param list List of elements.
- * @return True if the list elements are valid, false otherwise.
+ * Allocates zeroed memory from an arena, or from the heap like calloc if there is no arena.
+ * @param arena Arena to allocate from, or NULL for the heap.
+ * @param size Number of bytes.
+ * @return The zeroed memory.
  */
-bool validateCircles (List* list) {
-    if (list == NULL) return false;
-
-    ListIterator iter = createIterator(list);
-    Circle* circle = NULL;
-    while ((circle = nextElement(&iter)) != NULL) {
-        if (circle->units == NULL || circle->otherAttributes == NULL || !validateAttributes(circle->otherAttributes) || circle->r < 0) return false;
-    }
-    return true;
+void* allocateIn(Arena* arena, size_t size) {
+    return (arena == NULL ? calloc(1, size) : arenaAlloc(arena, size));
+}
+
+/**
+ * Copies a string into an arena, or onto the heap if there is no arena.
+ * @param arena Arena to allocate from, or NULL for the heap.
+ * @param string The string to copy.
+ * @return The copy.
+ */
+char* copyStringIn(Arena* arena, const char* string) {
+    if (arena != NULL) return arenaStrdup(arena, string);
+    char* copy = calloc(strlen(string) + 1, sizeof(char));
+    strcpy(copy, string);
+    return copy;
+}
+
+/**
+ * Replaces a string owned by a component. Heap strings are freed, arena strings are left for the arena to release.
+ * @param arena The arena the owner allocates from, or NULL for the heap.
+ * @param oldString The string being replaced.
+ * @param newString The new contents, which are copied.
+ * @return The copy of newString to store in place of oldString.
+ */
+char* replaceString(Arena* arena, char* oldString, const char* newString) {
+    if (arena == NULL) free(oldString);
+    return copyStringIn(arena, newString);
+}
+
+/**
+ * Gets the copy of a string an interned list's new attribute should use: the pool's if it has one, otherwise a copy in
+ * the list's arena. Edits never add to the pool, so it only holds the strings of the file the image was loaded from.
+ * @param arena The list's arena.
+ * @param strings The image's string pool.
+ * @param string The string.
+ * @return The string to store, which belongs to the pool or the arena.
+ */
+char* shareString(Arena* arena, StringPool* strings, const char* string) {
+    const char* shared = findString(strings, string);
+    return (shared != NULL ? (char*)shared : copyStringIn(arena, string));
+}
+
+/**
+ * Adds a caller allocated Attribute to a list. Interned lists and lists in an arena take a copy and free the
+ * caller's Attribute, so that the list's strings are all shared or all released together.
+ * @param list List of Attributes to add to.
+ * @param strings The image's string pool, used if the list is interned.
+ * @param attribute Heap allocated Attribute. The list takes ownership of it.
+ */
+void insertAttribute(List* list, StringPool* strings, Attribute* attribute) {
+    if (isInternedList(list)) {
+        SVGKeyword keyword = lookupKeyword(attribute->name);
+        Attribute* shared = allocateIn(list->arena, sizeof(Attribute));
+        shared->name = (keyword != KEYWORD_UNKNOWN ? (char*)keywordName(keyword) : shareString(list->arena, strings, attribute->name));
+        shared->value = shareString(list->arena, strings, attribute->value);
+        insertBack(list, shared);
+    } else if (list->arena != NULL) {
+        insertBack(list, newAttributeIn(list->arena, attribute->name, attribute->value));
+    } else {
+        insertBack(list, attribute);
+        return;
+    }
+    deleteAttribute(attribute);
+}
+
+/**
+ * Creates an SVGimage by streaming through a text reader, without building a DOM.
+ * Peak memory depends on how deeply elements are nested, not on the size of the file.
+ * @pre reader is positioned before the root element. Any validation must be set up on the reader before this is called.
+ * @post The reader has consumed the whole document.
+ * @param reader Reader for an SVG document.
+ * @param arena Arena to allocate the image from, or NULL for the heap. The image owns the arena, even on failure.
+ * @return A fully populated SVGimage struct, or NULL if the document is not well formed.
+ */
+SVGimage* readSVGimage(xmlTextReader* reader, Arena* arena) {
+    //Find the root element
+    int ret = 0;
+    while ((ret = xmlTextReaderRead(reader)) == 1 && xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT);
+    if (ret != 1) {
+        freeArena(arena);
+        return NULL;
+    }
+
+    SVGimage* image = allocateIn(arena, sizeof(SVGimage));
+    image->arena = arena;
+    //Heap images give each attribute its own strings, so callers may free or replace them
+    image->strings = (arena != NULL ? createStringPool(arena) : NULL);
+    //The reader's names all come from its dictionary, so they can be looked up by address for the rest of the parse
+    KeywordCache names;
+    initKeywordCache(&names);
+    const xmlChar* namespace = xmlTextReaderConstNamespaceUri(reader);
+    //Use strncpy to leave the null terminator
+    if (namespace != NULL) strncpy(image->namespace, (char*)namespace, 255);
+
+    image->rectangles = initializeListInArena(rectangleToString, deleteRectangle, compareRectangles, arena);
+    image->circles = initializeListInArena(circleToString, deleteCircle, compareCircles, arena);
+    image->paths = initializeListInArena(pathToString, deletePath, comparePaths, arena);
+    image->groups = initializeListInArena(groupToString, deleteGroup, compareGroups, arena);
+    image->otherAttributes = initializeAttributeList(arena, image->strings);
+
+    int depth = xmlTextReaderDepth(reader);
+    bool empty = xmlTextReaderIsEmptyElement(reader);
+    readAttributes(reader, image->otherAttributes, &names, image->strings);
+
+    ret = (empty ? 1 : xmlTextReaderRead(reader));
+    while (!empty && ret == 1) {
+        int type = xmlTextReaderNodeType(reader);
+        if (type == XML_READER_TYPE_END_ELEMENT && xmlTextReaderDepth(reader) == depth) break;
+        if (type != XML_READER_TYPE_ELEMENT) {
+            ret = xmlTextReaderRead(reader);
+            continue;
+        }
+
+        SVGKeyword keyword = lookupCachedKeyword(&names, (char*)xmlTextReaderConstLocalName(reader));
+        switch (keyword) {
+            case KEYWORD_RECT:
+                readRectangle(reader, image->rectangles, &names, image->strings);
+                break;
+            case KEYWORD_CIRCLE:
+                readCircle(reader, image->circles, &names, image->strings);
+                break;
+            case KEYWORD_PATH:
+                readPath(reader, image->paths, &names, image->strings);
+                break;
+            case KEYWORD_G:
+                readGroup(reader, image->groups, &names, image->strings);
+                break;
+            case KEYWORD_TITLE:
+            case KEYWORD_DESC: {
+                xmlChar* content = readFirstChildContent(reader);
+                //Use strncpy to leave the null terminator
+                if (content != NULL) strncpy(keyword == KEYWORD_TITLE ? image->title : image->description, (char*)content, 255);
+                xmlFree(content);
+                break;
+            }
+            default:
+                break;
+        }
+        //Move past the element and anything inside it that was not consumed above
+        ret = xmlTextReaderNext(reader);
+    }
+
+    //Read the rest of the document so that parsing and validation errors are caught
+    while (ret == 1) ret = xmlTextReaderRead(reader);
+    if (ret != 0) {
+        deleteSVGimage(image);
+        return NULL;
+    }
+    return image;
+}
+
+/**
+ * Counts the components readSVGimage would load from a document, nested ones included, without allocating any.
+ * @pre reader is positioned before the root element. Any validation must be set up on the reader before this is called.
+ * @post The reader has consumed the whole document.
+ * @param reader Reader for an SVG document.
+ * @param counts Set to the counts SVGtoJSON would report for the image.
+ * @return True if the document was counted, false if it is not well formed.
+ */
+bool readSVGcounts(xmlTextReader* reader, ComponentCounts* counts) {
+    memset(counts, 0, sizeof(ComponentCounts));
+
+    //Find the root element
+    int ret = 0;
+    while ((ret = xmlTextReaderRead(reader)) == 1 && xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT);
+    if (ret != 1) return false;
+
+    KeywordCache names;
+    initKeywordCache(&names);
+    //Only the root and groups are entered, the same as readSVGimage, so every element reached is a child of one of them
+    ret = xmlTextReaderRead(reader);
+    while (ret == 1) {
+        if (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) {
+            ret = xmlTextReaderRead(reader);
+            continue;
+        }
+
+        switch (lookupCachedKeyword(&names, (char*)xmlTextReaderConstLocalName(reader))) {
+            case KEYWORD_RECT:
+                counts->rectangles++;
+                break;
+            case KEYWORD_CIRCLE:
+                counts->circles++;
+                break;
+            case KEYWORD_PATH:
+                counts->paths++;
+                break;
+            case KEYWORD_G:
+                counts->groups++;
+                ret = xmlTextReaderRead(reader);
+                continue;
+            default:
+                break;
+        }
+        //Move past the element and anything inside it
+        ret = xmlTextReaderNext(reader);
+    }
+    return ret == 0;
+}
+
+/**
+ * Adds the attributes of the reader's current element to a list, skipping namespace declarations.
+ * @pre reader is positioned on an element.
+ * @post reader is positioned back on the element.
+ * @param reader Reader positioned on an element.
+ * @param list List of Attributes to append to.
+ * @param names Keyword cache for the reader's names, shared by the whole parse.
+ * @param strings The image's string pool, which the new attributes are interned in, or NULL to copy them.
+ */
+void readAttributes(xmlTextReader* reader, List* list, KeywordCache* names, StringPool* strings) {
+    while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+        if (xmlTextReaderIsNamespaceDecl(reader) == 1) continue;
+        const char* name = (char*)xmlTextReaderConstLocalName(reader);
+        insertBack(list, newInternedAttribute(list->arena, strings, lookupCachedKeyword(names, name), name, (char*)xmlTextReaderConstValue(reader)));
+    }
+    xmlTextReaderMoveToElement(reader);
+}
+
+/**
+ * Adds the rectangle at the reader's position to a list.
+ * @pre reader is positioned on a rect element.
+ * @param reader Reader positioned on a rect element.
+ * @param list List of rectangles to add the new Rectangle to.
+ * @param names Keyword cache for the reader's names, shared by the whole parse.
+ * @param strings The image's string pool, which the new attributes are interned in, or NULL to copy them.
+ */
+void readRectangle(xmlTextReader* reader, List* list, KeywordCache* names, StringPool* strings) {
+    Rectangle* rectToAdd = allocateIn(list->arena, sizeof(Rectangle));
+    rectToAdd->otherAttributes = initializeAttributeList(list->arena, strings);
+
+    while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+        if (xmlTextReaderIsNamespaceDecl(reader) == 1) continue;
+        const char* name = (char*)xmlTextReaderConstLocalName(reader);
+        const char* value = (char*)xmlTextReaderConstValue(reader);
+        SVGKeyword keyword = lookupCachedKeyword(names, name);
+        switch (keyword) {
+            case KEYWORD_X:
+                //Units are taken from the first coordinate only, the same as addRectangle
+                rectToAdd->x = parseSVGLength(value, rectToAdd->units, sizeof(rectToAdd->units));
+                break;
+            case KEYWORD_Y:
+                rectToAdd->y = parseSVGNumber(value, NULL);
+                break;
+            case KEYWORD_WIDTH:
+                rectToAdd->width = parseSVGNumber(value, NULL);
+                break;
+            case KEYWORD_HEIGHT:
+                rectToAdd->height = parseSVGNumber(value, NULL);
+                break;
+            default:
+                insertBack(rectToAdd->otherAttributes, newInternedAttribute(list->arena, strings, keyword, name, value));
+                break;
+        }
+    }
+    xmlTextReaderMoveToElement(reader);
+
+    insertBack(list, rectToAdd);
+}
+
+/**
+ * Adds the circle at the reader's position to a list.
+ * @pre reader is positioned on a circle element.
+ * @param reader Reader positioned on a circle element.
+ * @param list List of circles to add the new Circle to.
+ * @param names Keyword cache for the reader's names, shared by the whole parse.
+ * @param strings The image's string pool, which the new attributes are interned in, or NULL to copy them.
+ */
+void readCircle(xmlTextReader* reader, List* list, KeywordCache* names, StringPool* strings) {
+    Circle* circleToAdd = allocateIn(list->arena, sizeof(Circle));
+    circleToAdd->otherAttributes = initializeAttributeList(list->arena, strings);
+
+    while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+        if (xmlTextReaderIsNamespaceDecl(reader) == 1) continue;
+        const char* name = (char*)xmlTextReaderConstLocalName(reader);
+        const char* value = (char*)xmlTextReaderConstValue(reader);
+        SVGKeyword keyword = lookupCachedKeyword(names, name);
+        switch (keyword) {
+            case KEYWORD_CX:
+                //Units are taken from the first coordinate only, the same as addCircle
+                circleToAdd->cx = parseSVGLength(value, circleToAdd->units, sizeof(circleToAdd->units));
+                break;
+            case KEYWORD_CY:
+                circleToAdd->cy = parseSVGNumber(value, NULL);
+                break;
+            case KEYWORD_R:
+                circleToAdd->r = parseSVGNumber(value, NULL);
+                break;
+            default:
+                insertBack(circleToAdd->otherAttributes, newInternedAttribute(list->arena, strings, keyword, name, value));
+                break;
+        }
+    }
+    xmlTextReaderMoveToElement(reader);
+
+    insertBack(list, circleToAdd);
+}
+
+/**
+ * Adds the path at the reader's position to a list.
+ * @pre reader is positioned on a path element.
+ * @param reader Reader positioned on a path element.
+ * @param list List of paths to add the new Path to.
+ * @param names Keyword cache for the reader's names, shared by the whole parse.
+ * @param strings The image's string pool, which the new attributes are interned in, or NULL to copy them.
+ */
+void readPath(xmlTextReader* reader, List* list, KeywordCache* names, StringPool* strings) {
+    Path* pathToAdd = allocateIn(list->arena, sizeof(Path));
+    pathToAdd->otherAttributes = initializeAttributeList(list->arena, strings);
+
+    while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+        if (xmlTextReaderIsNamespaceDecl(reader) == 1) continue;
+        const char* name = (char*)xmlTextReaderConstLocalName(reader);
+        const char* value = (char*)xmlTextReaderConstValue(reader);
+        SVGKeyword keyword = lookupCachedKeyword(names, name);
+        if (keyword == KEYWORD_D) {
+            pathToAdd->data = copyStringIn(list->arena, value);
+        } else {
+            insertBack(pathToAdd->otherAttributes, newInternedAttribute(list->arena, strings, keyword, name, value));
+        }
+    }
+    xmlTextReaderMoveToElement(reader);
+
+    insertBack(list, pathToAdd);
+}
+
+/**
+ * Adds the group at the reader's position to a list, recursively.
+ * @pre reader is positioned on a g element.
+ * @post reader is positioned on the end of the group, or on the group itself if it is empty.
+ * @param reader Reader positioned on a g element.
+ * @param list List of groups to add the new Group to.
+ * @param names Keyword cache for the reader's names, shared by the whole parse.
+ * @param strings The image's string pool, which the new attributes are interned in, or NULL to copy them.
+ */
+void readGroup(xmlTextReader* reader, List* list, KeywordCache* names, StringPool* strings) {
+    Group* groupToAdd = allocateIn(list->arena, sizeof(Group));
+    groupToAdd->rectangles = initializeListInArena(rectangleToString, deleteRectangle, compareRectangles, list->arena);
+    groupToAdd->circles = initializeListInArena(circleToString, deleteCircle, compareCircles, list->arena);
+    groupToAdd->paths = initializeListInArena(pathToString, deletePath, comparePaths, list->arena);
+    groupToAdd->groups = initializeListInArena(groupToString, deleteGroup, compareGroups, list->arena);
+    groupToAdd->otherAttributes = initializeAttributeList(list->arena, strings);
+    insertBack(list, groupToAdd);
+
+    //The g attributes go after any title/desc children, the same order addGroup produces
+    List* properties = initializeListInArena(attributeToString, dummy, compareAttributes, list->arena);
+    int depth = xmlTextReaderDepth(reader);
+    bool empty = xmlTextReaderIsEmptyElement(reader);
+    readAttributes(reader, properties, names, strings);
+
+    int ret = (empty ? 0 : xmlTextReaderRead(reader));
+    while (ret == 1) {
+        int type = xmlTextReaderNodeType(reader);
+        if (type == XML_READER_TYPE_END_ELEMENT && xmlTextReaderDepth(reader) == depth) break;
+        if (type != XML_READER_TYPE_ELEMENT) {
+            ret = xmlTextReaderRead(reader);
+            continue;
+        }
+
+        SVGKeyword keyword = lookupCachedKeyword(names, (char*)xmlTextReaderConstLocalName(reader));
+        switch (keyword) {
+            case KEYWORD_RECT:
+                readRectangle(reader, groupToAdd->rectangles, names, strings);
+                break;
+            case KEYWORD_CIRCLE:
+                readCircle(reader, groupToAdd->circles, names, strings);
+                break;
+            case KEYWORD_PATH:
+                readPath(reader, groupToAdd->paths, names, strings);
+                break;
+            case KEYWORD_G:
+                readGroup(reader, groupToAdd->groups, names, strings);
+                break;
+            case KEYWORD_TITLE:
+            case KEYWORD_DESC: {
+                xmlChar* content = readFirstChildContent(reader);
+                const char* value = (content == NULL ? "" : (char*)content);
+                insertBack(groupToAdd->otherAttributes, newInternedAttribute(list->arena, strings, keyword, keywordName(keyword), value));
+                xmlFree(content);
+                break;
+            }
+            default:
+                break;
+        }
+        ret = xmlTextReaderNext(reader);
+    }
+
+    for (Node* node = properties->head; node != NULL; node = node->next) {
+        insertBack(groupToAdd->otherAttributes, node->data);
+    }
+    freeList(properties);
+}
+
+/**
+ * Reads the content of the reader's current element's first child, the node->children->content the DOM loader took a
+ * title or description from. Text after a comment or nested element in it is not included. The reader is left on the
+ * element's end, so xmlTextReaderNext moves past it.
+ * @param reader A reader on an element's start.
+ * @return The content, which the caller frees with xmlFree, or NULL if the element is empty or its first child has
+ *         no content.
+ */
+xmlChar* readFirstChildContent(xmlTextReader* reader) {
+    if (xmlTextReaderIsEmptyElement(reader)) return NULL;
+    int depth = xmlTextReaderDepth(reader);
+    if (xmlTextReaderRead(reader) != 1) return NULL;
+    if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_END_ELEMENT && xmlTextReaderDepth(reader) == depth) return NULL;
+    xmlChar* content = xmlTextReaderValue(reader);
+
+    while (!(xmlTextReaderNodeType(reader) == XML_READER_TYPE_END_ELEMENT && xmlTextReaderDepth(reader) == depth) &&
+           xmlTextReaderRead(reader) == 1);
+    return content;
+}
+
+/**
+ * Dummy function, used in getter delete list initializers.
+ */
+void dummy() {}
+
+/**
+ * Creates a valid SVG image struct.
+ * @param fileName File name for the XML document.
+ * @param schemaFile Schema file to validate the xml file against. Expected to be an SVG schema file.
+ * @return A valid SVGimage struct if the given XML document is valid SVG, NULL otherwise.
+ */
+SVGimage* createValidSVGimage(char* fileName, char* schemaFile) {
+    if (!validLoadArguments(fileName, schemaFile)) return NULL;
+    return loadSVGimage(fileName, schemaFile, false);
+}
+
+/**
+ * Creates a valid SVG image struct, with the image and all its components allocated from one arena.
+ * @param fileName File name for the XML document.
+ * @param schemaFile Schema file to validate the xml file against. Expected to be an SVG schema file.
+ * @return A valid SVGimage struct if the given XML document is valid SVG, NULL otherwise.
+ */
+SVGimage* createValidSVGimageInArena(char* fileName, char* schemaFile) {
+    if (!validLoadArguments(fileName, schemaFile)) return NULL;
+    return loadSVGimage(fileName, schemaFile, true);
+}
+
+/**
+ * Checks the arguments given to the validated loaders.
+ * @param fileName File name for the XML document.
+ * @param schemaFile Schema file to validate the xml file against.
+ * @return False if either is NULL or has the wrong extension. True otherwise. Missing files are found by the loaders,
+ *         which fail when the file cannot be mapped or the schema cannot be compiled.
+ */
+bool validLoadArguments(char* fileName, char* schemaFile) {
+    /*Return false if:
+        -fileName or schemaFile is NULL
+        -fileName does not have a .svg extension
+        -schemaFile does not have a .xsd extension*/
+    if ((fileName == NULL || schemaFile == NULL) ||
+        (strcmp(".xsd", schemaFile + (strlen(schemaFile) - 4)) != 0) ||
+        (strcmp(".svg", fileName + (strlen(fileName) - 4)) != 0)) return false;
+    return true;
+}
+
+/**
+ * Validate an SVGimage against a XSD file.
+ * @param image The SVGimage to validate.
+ * @param schemaFile File name for the XML XSD file to use.
+ * @return True is the SVGimage is valid, false otherwise
+ */
+bool validateSVGimage(SVGimage* image, char* schemaFile) {
+    if (schemaFile == NULL || image == NULL) return false;
+
+    //Header constraint checks
+    if (!validateRects(image->rectangles) ||
+        !validateCircles(image->circles) ||
+        !validatePaths(image->paths) ||
+        !validateGroups(image->groups) ||
+        !validateAttributes(image->otherAttributes)) return false;
+
+    //XSD checking
+    xmlDoc* imageDoc = imageToXML(image);
+    int ret = validateXMLwithXSD(imageDoc, schemaFile);
+    xmlFreeDoc(imageDoc);
+
+    return (ret == 0 ? true : false);
+}
+
+/**
+ * Validate the given rectangles list against constraints outlined in the header.
+ * @param list List of elements.
+ * @return True if the list elements are valid, false otherwise.
+ */
+bool validateRects (List* list) {
+    if (list == NULL) return false;
+
+    ListIterator iter = createIterator(list);
+    Rectangle* rect = NULL;
+    while ((rect = nextElement(&iter)) != NULL) {
+        if (rect->units == NULL || rect->otherAttributes == NULL || !validateAttributes(rect->otherAttributes)) return false;
+    }
+    return true;
+}
+
+/**
+ * Validate the given circles list against constraints outlined in the header.
+ * @param list List of elements.
+ * @return True if the list elements are valid, false otherwise.
+ */
+bool validateCircles (List* list) {
+    if (list == NULL) return false;
+
+    ListIterator iter = createIterator(list);
+    Circle* circle = NULL;
+    while ((circle = nextElement(&iter)) != NULL) {
+        if (circle->units == NULL || circle->otherAttributes == NULL || !validateAttributes(circle->otherAttributes) || circle->r < 0) return false;
+    }
+    return true;
 }
 
 /**
@@ -908,74 +1651,481 @@ bool validateAttributes (List* list) {
 }
 
 /**
- * Checks if a given file exists.
- * @param fileName File to attempt to open.
- * @return True or false if the file exists.
+ * Validate a single component against the constraints outlined in the header, without walking the rest of the image.
+ * @param type The type of the component.
+ * @param component A SVGimage, Rectangle, Circle, Path or Group depending on type.
+ * @return True if the component is valid, false otherwise.
+ */
+bool validateComponent (elementType type, void* component) {
+    if (component == NULL) return false;
+
+    SVGimage* image = NULL;
+    Group* group = NULL;
+    switch (type) {
+        case SVG_IMAGE:
+            image = component;
+            return image->rectangles != NULL && image->circles != NULL && image->paths != NULL &&
+                   image->groups != NULL && validateAttributes(image->otherAttributes);
+        case RECT:
+            return validateAttributes(((Rectangle*)component)->otherAttributes);
+        case CIRC:
+            return ((Circle*)component)->r >= 0 && validateAttributes(((Circle*)component)->otherAttributes);
+        case PATH:
+            return ((Path*)component)->data != NULL && validateAttributes(((Path*)component)->otherAttributes);
+        case GROUP:
+            group = component;
+            return validateRects(group->rectangles) && validateCircles(group->circles) && validatePaths(group->paths) &&
+                   validateGroups(group->groups) && validateAttributes(group->otherAttributes);
+        default:
+            return false;
+    }
+}
+
+/**
+ * Checks if a given file exists.
+ * @param fileName File to attempt to open.
+ * @return True or false if the file exists.
+ */
+bool fileExists (char* fileName) {
+    struct stat fileInfo;
+    return fileName != NULL && stat(fileName, &fileInfo) == 0;
+}
+
+/**
+ * Validates an XML doc against a given schema file URL.
+ * @param xml XML tree to validate.
+ * @param xsdFile URL to the XSD to use to validate.
+ * @return The value returned when validating the XML tree.
+ */
+int validateXMLwithXSD(xmlDoc* xml, char* xsdFile) {
+    xmlSchemaValidCtxt* validator = NULL;
+    int retVal = -1;
+
+    //The compiled schema is shared through the cache, only the validation context is per call
+    if (xml == NULL) return retVal;
+    SchemaCacheEntry* entry = acquireSchema(xsdFile);
+    if (entry == NULL) return retVal;
+
+    validator = xmlSchemaNewValidCtxt(entry->schema);
+    if (validator != NULL) {
+        retVal = xmlSchemaValidateDoc(validator, xml);
+        xmlSchemaFreeValidCtxt(validator);
+    }
+    releaseSchema(entry);
+    return retVal;
+}
+
+/**
+ * Gets the compiled schema for an XSD file, compiling it only if it is not cached or has changed on disk.
+ * Safe to call from several threads. Every successful call must be paired with releaseSchema.
+ * @param xsdFile Path to the XSD file.
+ * @return The cache entry holding the compiled schema, or NULL if the file does not exist or is not a valid schema.
+ */
+SchemaCacheEntry* acquireSchema(char* xsdFile) {
+    struct stat fileInfo;
+    if (xsdFile == NULL || stat(xsdFile, &fileInfo) != 0) return NULL;
+    initSVGParser();
+
+    pthread_mutex_lock(&schemaCacheLock);
+    if (schemaCache == NULL) schemaCache = initializeList(schemaCacheEntryToString, dropSchemaCacheEntry, compareSchemaCacheEntries);
+
+    //Reuse the compiled schema if the file has not been modified since it was compiled
+    SchemaCacheEntry* entry = findElement(schemaCache, schemaCacheEntryHasPath, xsdFile);
+    if (entry != NULL) {
+        if (entry->mtime.tv_sec == fileInfo.st_mtim.tv_sec && entry->mtime.tv_nsec == fileInfo.st_mtim.tv_nsec &&
+            entry->size == fileInfo.st_size) {
+            entry->refCount++;
+            pthread_mutex_unlock(&schemaCacheLock);
+            return entry;
+        }
+        //Out of date. Other threads may still be validating with it, so the last one to release it frees it.
+        dropSchemaCacheEntry(deleteDataFromList(schemaCache, entry));
+    }
+
+    entry = NULL;
+    xmlSchemaParserCtxt* parserContext = xmlSchemaNewParserCtxt(xsdFile);
+    xmlSchema* schema = (parserContext == NULL ? NULL : xmlSchemaParse(parserContext));
+    if (parserContext != NULL) xmlSchemaFreeParserCtxt(parserContext);
+
+    if (schema != NULL) {
+        entry = calloc(1, sizeof(SchemaCacheEntry));
+        entry->path = calloc(strlen(xsdFile) + 1, sizeof(char));
+        strcpy(entry->path, xsdFile);
+        entry->mtime = fileInfo.st_mtim;
+        entry->size = fileInfo.st_size;
+        entry->schema = schema;
+        entry->refCount = 1;
+        insertBack(schemaCache, entry);
+    }
+    pthread_mutex_unlock(&schemaCacheLock);
+    return entry;
+}
+
+/**
+ * Releases a schema returned by acquireSchema.
+ * @param entry The cache entry to release. May be NULL.
+ */
+void releaseSchema(SchemaCacheEntry* entry) {
+    if (entry == NULL) return;
+    pthread_mutex_lock(&schemaCacheLock);
+    entry->refCount--;
+    if (entry->stale && entry->refCount == 0) deleteSchemaCacheEntry(entry);
+    pthread_mutex_unlock(&schemaCacheLock);
+}
+
+/**
+ * Empties the schema cache. The next validation recompiles its schema. Schemas still in use by a validation are
+ * freed when it releases them.
+ */
+void clearSchemaCache() {
+    pthread_mutex_lock(&schemaCacheLock);
+    freeList(schemaCache);
+    schemaCache = NULL;
+    pthread_mutex_unlock(&schemaCacheLock);
+}
+
+/**
+ * Removes a SchemaCacheEntry from use by the cache. It is freed now if nothing holds it, otherwise by the last
+ * releaseSchema. The cache lock must be held.
+ * @param data void pointer to a SchemaCacheEntry struct.
+ */
+void dropSchemaCacheEntry(void* data) {
+    SchemaCacheEntry* entry = data;
+    if (entry == NULL) return;
+    entry->stale = true;
+    if (entry->refCount == 0) deleteSchemaCacheEntry(entry);
+}
+
+/**
+ * Frees a SchemaCacheEntry and its compiled schema.
+ * @param data void pointer to a SchemaCacheEntry struct.
+ */
+void deleteSchemaCacheEntry(void* data) {
+    if (data == NULL) return;
+    xmlSchemaFree(((SchemaCacheEntry*)data)->schema);
+    free(((SchemaCacheEntry*)data)->path);
+    free(data);
+}
+
+/**
+ * C equivalent of a Java toString, but for SchemaCacheEntries
+ * @param data void pointer to SchemaCacheEntry struct.
+ * @return A string representation of the given SchemaCacheEntry.
+ */
+char* schemaCacheEntryToString(void* data) {
+    char* tmpDesc = calloc(strlen(((SchemaCacheEntry*)data)->path) + 64, sizeof(char));
+    sprintf(tmpDesc, "[SCHEMA] %s (%ld)\n", ((SchemaCacheEntry*)data)->path, (long)((SchemaCacheEntry*)data)->mtime.tv_sec);
+    return tmpDesc;
+}
+
+/**Compares schema cache entries by path*/
+int compareSchemaCacheEntries(const void* first, const void* second) {
+    return strcmp(((SchemaCacheEntry*)first)->path, ((SchemaCacheEntry*)second)->path);
+}
+
+/**Search predicate for findElement, matches a SchemaCacheEntry against a path*/
+bool schemaCacheEntryHasPath(const void* first, const void* second) {
+    return strcmp(((SchemaCacheEntry*)first)->path, (char*)second) == 0;
+}
+
+/**
+ * Writes the SVGimage to a SVG image file.
+ * @param image SVGimage struct to write.
+ * @param fileName Filename to write to.
+ * @return True if completed successfully, false otherwise.
+ */
+bool writeSVGimage(SVGimage* image, char* fileName) {
+    if (image == NULL || fileName == NULL) return false;
+    if (strcmp(".svg", fileName + (strlen(fileName) - 4)) != 0) return false;
+    return writeSVGimageCompressed(image, fileName, 0);
+}
+
+/**
+ * Writes the SVGimage to a SVG image file, optionally gzip compressed. The image is streamed to the file as it is
+ * serialized, without building an XML tree of it first.
+ * @param image SVGimage struct to write.
+ * @param fileName Filename to write to, with a .svg or .svgz extension.
+ * @param compression The gzip compression level, 1 to 9, or 0 to write plain text.
+ * @return True if completed successfully, false otherwise.
+ */
+bool writeSVGimageCompressed(SVGimage* image, char* fileName, int compression) {
+    //Validity checking
+    if (image == NULL || fileName == NULL || compression < 0 || compression > 9) return false;
+    if (strlen(fileName) < 4 || (strcmp(".svg", fileName + (strlen(fileName) - 4)) != 0 &&
+        (strlen(fileName) < 5 || strcmp(".svgz", fileName + (strlen(fileName) - 5)) != 0))) return false;
+    if (!hasValidComponents(image)) return false;
+
+    //The image is written beside the file, hidden, and renamed over it, so a failed write leaves the old file whole
+    const char* slash = strrchr(fileName, '/');
+    int directoryLength = (slash == NULL ? 0 : (int)(slash - fileName) + 1);
+    char* tempPath = malloc(strlen(fileName) + 9);
+    if (tempPath == NULL) return false;
+    sprintf(tempPath, "%.*s.%s.XXXXXX", directoryLength, fileName, fileName + directoryLength);
+    int descriptor = mkstemp(tempPath);
+    if (descriptor < 0) {
+        free(tempPath);
+        return false;
+    }
+    //Keep the permissions of the file being replaced. mkstemp creates it readable by its owner only.
+    struct stat info;
+    bool written = (fchmod(descriptor, (stat(fileName, &info) == 0 ? info.st_mode & 07777 : 0644)) == 0);
+
+    initSVGParser();
+    //libxml2 only compresses output it opens itself, so the writer reopens the temporary file by name
+    xmlTextWriter* writer = (written ? xmlNewTextWriterFilename(tempPath, compression) : NULL);
+    written = (writer != NULL && writeImageXML(writer, image));
+    if (writer != NULL) xmlFreeTextWriter(writer);
+    close(descriptor);
+    written = (written && rename(tempPath, fileName) == 0);
+    if (!written) unlink(tempPath);
+    free(tempPath);
+
+    //The file's cached summaries and snapshot describe what it held before
+    if (written) {
+        invalidateFileSummary(fileName);
+        invalidateSVGsnapshot(fileName);
+    }
+    return written;
+}
+
+/**
+ * Writes the SVGimage in SVG format to an open file descriptor, e.g. a socket or pipe, as it is serialized.
+ * @param image SVGimage struct to write.
+ * @param fd The descriptor to write to. It is not closed.
+ * @return True if completed successfully, false otherwise.
+ */
+bool writeSVGimageToFd(SVGimage* image, int fd) {
+    if (image == NULL || fd < 0 || !hasValidComponents(image)) return false;
+
+    initSVGParser();
+    xmlOutputBuffer* output = xmlOutputBufferCreateFd(fd, NULL);
+    //The writer owns the output buffer, and frees it with itself
+    xmlTextWriter* writer = (output == NULL ? NULL : xmlNewTextWriter(output));
+    if (writer == NULL) {
+        if (output != NULL) xmlOutputBufferClose(output);
+        return false;
+    }
+    bool written = writeImageXML(writer, image);
+    xmlFreeTextWriter(writer);
+    return written;
+}
+
+/**
+ * Creates the SVG document for an SVGimage, as writeSVGimage would write it.
+ * @param image SVGimage struct to write.
+ * @return The newly allocated document, or NULL if the image is not valid.
+ */
+char* SVGimageToXMLString(SVGimage* image) {
+    if (image == NULL || !hasValidComponents(image)) return NULL;
+
+    initSVGParser();
+    xmlBuffer* buffer = xmlBufferCreate();
+    xmlTextWriter* writer = (buffer == NULL ? NULL : xmlNewTextWriterMemory(buffer, 0));
+    char* result = NULL;
+    if (writer != NULL) {
+        bool written = writeImageXML(writer, image);
+        //Freeing the writer flushes what it still holds into the buffer
+        xmlFreeTextWriter(writer);
+        if (written) result = copyStringIn(NULL, (char*)xmlBufferContent(buffer));
+    }
+    if (buffer != NULL) xmlBufferFree(buffer);
+    return result;
+}
+
+/**
+ * Checks the image and everything in it against the constraints outlined in the header.
+ * @param image The image to check.
+ * @return True if every list is valid, false otherwise.
+ */
+bool hasValidComponents(SVGimage* image) {
+    return validateRects(image->rectangles) && validateCircles(image->circles) && validatePaths(image->paths) &&
+           validateGroups(image->groups) && validateAttributes(image->otherAttributes);
+}
+
+/**
+ * Streams an SVGimage as an SVG document, laid out byte for byte as xmlSaveFormatFileEnc lays out the tree from
+ * imageToXML. The layout is written by hand, since the writer's own indenting does not cap deep indents as it does.
+ * @param writer The writer to write to.
+ * @param image The image to write.
+ * @return True if every write succeeded, false otherwise.
+ */
+bool writeImageXML(xmlTextWriter* writer, SVGimage* image) {
+    bool written = xmlTextWriterStartDocument(writer, "1.0", "UTF-8", NULL) >= 0 &&
+                   xmlTextWriterStartElement(writer, (xmlChar*)"svg") >= 0 &&
+                   xmlTextWriterWriteAttribute(writer, (xmlChar*)"xmlns", (xmlChar*)image->namespace) >= 0 &&
+                   writeAttributesXML(image->otherAttributes, writer);
+    bool hasChildren = (strlen(image->title) > 0 || strlen(image->description) > 0 || getLength(image->rectangles) > 0 ||
+                        getLength(image->circles) > 0 || getLength(image->paths) > 0 || getLength(image->groups) > 0);
+    if (written && hasChildren) {
+        //Add title and desc elements only if they have content
+        written = xmlTextWriterWriteRaw(writer, (xmlChar*)"\n") >= 0 &&
+                  (strlen(image->title) == 0 || writeTextElementXML(writer, "title", image->title, 1)) &&
+                  (strlen(image->description) == 0 || writeTextElementXML(writer, "desc", image->description, 1)) &&
+                  writeRectsXML(image->rectangles, writer, 1) && writeCirclesXML(image->circles, writer, 1) &&
+                  writePathsXML(image->paths, writer, 1) && writeGroupsXML(image->groups, writer, 1);
+    }
+    return written && xmlTextWriterEndElement(writer) >= 0 && xmlTextWriterEndDocument(writer) >= 0;
+}
+
+/**
+ * Writes the indent for an element at a depth. Like the tree serializer, indents stop growing after 30 levels.
+ * @param writer The writer.
+ * @param depth The element's depth below the root.
+ * @return True if the write succeeded, false otherwise.
+ */
+bool writeIndentXML(xmlTextWriter* writer, int depth) {
+    static const char spaces[] = "                                                            ";
+    int length = 2 * (depth > 30 ? 30 : depth);
+    return length == 0 || xmlTextWriterWriteRawLen(writer, (xmlChar*)spaces, length) >= 0;
+}
+
+/**
+ * Writes an element holding only text, on its own line, escaping the text as the tree serializer does.
+ * @param writer The writer, inside the parent element.
+ * @param name The element's name.
+ * @param text The element's text.
+ * @param depth The element's depth below the root.
+ * @return True if every write succeeded, false otherwise.
+ */
+bool writeTextElementXML(xmlTextWriter* writer, const char* name, const char* text, int depth) {
+    if (!writeIndentXML(writer, depth) || xmlTextWriterStartElement(writer, (xmlChar*)name) < 0) return false;
+
+    //Copy runs of plain text across whole, and replace the characters that must be escaped
+    const char* run = text;
+    for (const char* c = text; ; c++) {
+        const char* entity = NULL;
+        switch (*c) {
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+            case '&': entity = "&amp;"; break;
+            case '\r': entity = "&#13;"; break;
+            default: break;
+        }
+        if (entity == NULL && *c != '\0') continue;
+        if (c > run && xmlTextWriterWriteRawLen(writer, (xmlChar*)run, c - run) < 0) return false;
+        if (entity == NULL) break;
+        if (xmlTextWriterWriteRaw(writer, (xmlChar*)entity) < 0) return false;
+        run = c + 1;
+    }
+    return xmlTextWriterEndElement(writer) >= 0 && xmlTextWriterWriteRaw(writer, (xmlChar*)"\n") >= 0;
+}
+
+/**
+ * Writes a length attribute's text, a number with as few digits as read back as the same float followed by its units.
+ * @param buffer Where to write it. Must hold NUMBER_FORMAT_SIZE chars more than the units.
+ * @param value The number.
+ * @param units The units, e.g. "px", or an empty string.
+ * @return The buffer.
+ */
+xmlChar* formatLength(char* buffer, float value, const char* units) {
+    int length = formatNumber(buffer, value, NUMBER_SHORTEST);
+    strcpy(buffer + length, units);
+    return (xmlChar*)buffer;
+}
+
+/**
+ * Writes the attributes in an otherAttributes list into the element being written.
+ * @param elementList List of otherAttributes to go through.
+ * @param writer The writer, inside the element's start tag.
+ * @return True if every write succeeded, false otherwise.
+ */
+bool writeAttributesXML(List* elementList, xmlTextWriter* writer) {
+    ListIterator iterator = createIterator(elementList);
+    Attribute* attr = NULL;
+    while ((attr = nextElement(&iterator)) != NULL) {
+        if (xmlTextWriterWriteAttribute(writer, (xmlChar*)attr->name, (xmlChar*)attr->value) < 0) return false;
+    }
+    return true;
+}
+
+/**
+ * Writes a rect element for each Rectangle in a list.
+ * @param elementList The list of rectangles.
+ * @param writer The writer, inside the parent element.
+ * @param depth The elements' depth below the root.
+ * @return True if every write succeeded, false otherwise.
+ */
+bool writeRectsXML(List* elementList, xmlTextWriter* writer, int depth) {
+    ListIterator iterator = createIterator(elementList);
+    Rectangle* rect = NULL;
+    char value[NUMBER_FORMAT_SIZE + sizeof(rect->units)];
+    while ((rect = nextElement(&iterator)) != NULL) {
+        if (!writeIndentXML(writer, depth) || xmlTextWriterStartElement(writer, (xmlChar*)"rect") < 0 ||
+            xmlTextWriterWriteAttribute(writer, (xmlChar*)"x", formatLength(value, rect->x, rect->units)) < 0 ||
+            xmlTextWriterWriteAttribute(writer, (xmlChar*)"y", formatLength(value, rect->y, rect->units)) < 0 ||
+            xmlTextWriterWriteAttribute(writer, (xmlChar*)"width", formatLength(value, rect->width, rect->units)) < 0 ||
+            xmlTextWriterWriteAttribute(writer, (xmlChar*)"height", formatLength(value, rect->height, rect->units)) < 0 ||
+            !writeAttributesXML(rect->otherAttributes, writer) || xmlTextWriterEndElement(writer) < 0 ||
+            xmlTextWriterWriteRaw(writer, (xmlChar*)"\n") < 0) return false;
+    }
+    return true;
+}
+
+/**
+ * Writes a circle element for each Circle in a list.
+ * @param elementList The list of circles.
+ * @param writer The writer, inside the parent element.
+ * @param depth The elements' depth below the root.
+ * @return True if every write succeeded, false otherwise.
+ */
+bool writeCirclesXML(List* elementList, xmlTextWriter* writer, int depth) {
+    ListIterator iterator = createIterator(elementList);
+    Circle* circle = NULL;
+    char value[NUMBER_FORMAT_SIZE + sizeof(circle->units)];
+    while ((circle = nextElement(&iterator)) != NULL) {
+        if (!writeIndentXML(writer, depth) || xmlTextWriterStartElement(writer, (xmlChar*)"circle") < 0 ||
+            xmlTextWriterWriteAttribute(writer, (xmlChar*)"cx", formatLength(value, circle->cx, circle->units)) < 0 ||
+            xmlTextWriterWriteAttribute(writer, (xmlChar*)"cy", formatLength(value, circle->cy, circle->units)) < 0 ||
+            xmlTextWriterWriteAttribute(writer, (xmlChar*)"r", formatLength(value, circle->r, circle->units)) < 0 ||
+            !writeAttributesXML(circle->otherAttributes, writer) || xmlTextWriterEndElement(writer) < 0 ||
+            xmlTextWriterWriteRaw(writer, (xmlChar*)"\n") < 0) return false;
+    }
+    return true;
+}
+
+/**
+ * Writes a path element for each Path in a list.
+ * @param elementList The list of paths.
+ * @param writer The writer, inside the parent element.
+ * @param depth The elements' depth below the root.
+ * @return True if every write succeeded, false otherwise.
  */
-bool fileExists (char* fileName) {
-    if (fileName == NULL) return false;
-    FILE* file = fopen(fileName, "r");
-    if (file == NULL) return false;
-    fclose(file);
+bool writePathsXML(List* elementList, xmlTextWriter* writer, int depth) {
+    ListIterator iterator = createIterator(elementList);
+    Path* path = NULL;
+    while ((path = nextElement(&iterator)) != NULL) {
+        if (!writeIndentXML(writer, depth) || xmlTextWriterStartElement(writer, (xmlChar*)"path") < 0 ||
+            xmlTextWriterWriteAttribute(writer, (xmlChar*)"d", (xmlChar*)path->data) < 0 ||
+            !writeAttributesXML(path->otherAttributes, writer) || xmlTextWriterEndElement(writer) < 0 ||
+            xmlTextWriterWriteRaw(writer, (xmlChar*)"\n") < 0) return false;
+    }
     return true;
 }
 
 /**
- * Validates an XML doc against a given schema file URL.
- * @param xml XML tree to validate.
- * @param xsdFile URL to the XSD to use to validate.
- * @return The value returned when validating the XML tree.
- */
-int validateXMLwithXSD(xmlDoc* xml, char* xsdFile) {//Declaring all the XML variables
-    xmlSchemaParserCtxt* parserContext = NULL;
-    xmlSchema* schema = NULL;
-    xmlSchemaValidCtxt* validator = NULL;
-    int retVal = -1;
-
-    //This is all for XML validation against a inputted schema files
-    if (xml == NULL) goto end;
-    if (!fileExists(xsdFile)) goto end;
-
-    parserContext = xmlSchemaNewParserCtxt(xsdFile);
-    if (parserContext == NULL) goto end;
-
-    schema = xmlSchemaParse(parserContext);
-    if (schema == NULL) goto end;
-
-    validator = xmlSchemaNewValidCtxt(schema);
-    if (validator == NULL) goto end;
-
-    retVal = xmlSchemaValidateDoc(validator, xml);
-
-    end:
-    if (parserContext != NULL) xmlSchemaFreeParserCtxt(parserContext);
-    if (schema != NULL) xmlSchemaFree(schema);
-    if (validator != NULL) xmlSchemaFreeValidCtxt(validator);
-    xmlSchemaCleanupTypes();
-    xmlCleanupParser();
-    return retVal;
-}
-
-/**
- * Writes the SVGimage to a SVG image file.
- * @param image SVGimage struct to write.
- * @param fileName Filename to write to.
- * @return True if completed successfully, false otherwise.
+ * Writes a g element for each Group in a list, and everything in it.
+ * @param elementList The list of groups.
+ * @param writer The writer, inside the parent element.
+ * @param depth The elements' depth below the root.
+ * @return True if every write succeeded, false otherwise.
  */
-bool writeSVGimage(SVGimage* image, char* fileName) {
-    //Validity checking
-    if (image == NULL || fileName == NULL) return false;
-    if (strcmp(".svg", fileName + (strlen(fileName) - 4)) != 0) return false;
-    if (!(validateRects(image->rectangles) && validateCircles(image->circles) && validatePaths(image->paths) && validateGroups(image->groups) && validateAttributes(image->otherAttributes))) return false;
-
-    //Turns the image into an XML tree
-    xmlDoc* imageXML = imageToXML(image);
-
-    //Write the XML tree
-    if (imageXML == NULL) return false;
-    int retVal = xmlSaveFormatFileEnc(fileName, imageXML, "UTF-8", 1);
-    xmlFreeDoc(imageXML);
-    return (retVal == -1 ? false : true);
+bool writeGroupsXML(List* elementList, xmlTextWriter* writer, int depth) {
+    ListIterator iterator = createIterator(elementList);
+    Group* group = NULL;
+    while ((group = nextElement(&iterator)) != NULL) {
+        if (!writeIndentXML(writer, depth) || xmlTextWriterStartElement(writer, (xmlChar*)"g") < 0 ||
+            !writeAttributesXML(group->otherAttributes, writer)) return false;
+
+        //An empty group is closed in its start tag
+        if (getLength(group->rectangles) > 0 || getLength(group->circles) > 0 || getLength(group->paths) > 0 ||
+            getLength(group->groups) > 0) {
+            if (xmlTextWriterWriteRaw(writer, (xmlChar*)"\n") < 0 || !writeRectsXML(group->rectangles, writer, depth + 1) ||
+                !writeCirclesXML(group->circles, writer, depth + 1) || !writePathsXML(group->paths, writer, depth + 1) ||
+                !writeGroupsXML(group->groups, writer, depth + 1) || !writeIndentXML(writer, depth)) return false;
+        }
+        if (xmlTextWriterEndElement(writer) < 0 || xmlTextWriterWriteRaw(writer, (xmlChar*)"\n") < 0) return false;
+    }
+    return true;
 }
 
 /**
@@ -1036,25 +2186,20 @@ void addAttributesToXML(List* elementList, xmlNode* node) {
 void addRectsToXML(List* elementList, xmlNode* docHead) {
     ListIterator iterator = createIterator(elementList);
     Rectangle* rect = NULL;
+    char value[NUMBER_FORMAT_SIZE + sizeof(rect->units)];
 
     while ((rect = nextElement(&iterator)) != NULL) {
         xmlNode* newNode = xmlNewNode(docHead->ns, (xmlChar*)"rect");
 
         //Adds all the properties to the newly created XML node
-        char* value = calloc(1024, sizeof(char));
-        sprintf(value, "%f%s", rect->x, rect->units);
-        xmlNewProp(newNode, (xmlChar*)"x", (xmlChar*)value);
-        sprintf(value, "%f%s", rect->y, rect->units);
-        xmlNewProp(newNode, (xmlChar*)"y", (xmlChar*)value);
-        sprintf(value, "%f%s", rect->width, rect->units);
-        xmlNewProp(newNode, (xmlChar*)"width", (xmlChar*)value);
-        sprintf(value, "%f%s", rect->height, rect->units);
-        xmlNewProp(newNode, (xmlChar*)"height", (xmlChar*)value);
+        xmlNewProp(newNode, (xmlChar*)"x", formatLength(value, rect->x, rect->units));
+        xmlNewProp(newNode, (xmlChar*)"y", formatLength(value, rect->y, rect->units));
+        xmlNewProp(newNode, (xmlChar*)"width", formatLength(value, rect->width, rect->units));
+        xmlNewProp(newNode, (xmlChar*)"height", formatLength(value, rect->height, rect->units));
         addAttributesToXML(rect->otherAttributes, newNode);
 
         //Adds the new node to the SVG doc
         xmlAddChild(docHead, newNode);
-        free(value);
     }
 }
 
@@ -1066,23 +2211,19 @@ void addRectsToXML(List* elementList, xmlNode* docHead) {
 void addCirclesToXML(List* elementList, xmlNode* docHead) {
     ListIterator iterator = createIterator(elementList);
     Circle* circle = NULL;
+    char value[NUMBER_FORMAT_SIZE + sizeof(circle->units)];
 
     while ((circle = nextElement(&iterator)) != NULL) {
         xmlNode* newNode = xmlNewNode(docHead->ns, (xmlChar*)"circle");
 
         //Adds all the properties to the newly created XML node
-        char* value = calloc(1024, sizeof(char));
-        sprintf(value, "%f%s", circle->cx, circle->units);
-        xmlNewProp(newNode, (xmlChar*)"cx", (xmlChar*)value);
-        sprintf(value, "%f%s", circle->cy, circle->units);
-        xmlNewProp(newNode, (xmlChar*)"cy", (xmlChar*)value);
-        sprintf(value, "%f%s", circle->r, circle->units);
-        xmlNewProp(newNode, (xmlChar*)"r", (xmlChar*)value);
+        xmlNewProp(newNode, (xmlChar*)"cx", formatLength(value, circle->cx, circle->units));
+        xmlNewProp(newNode, (xmlChar*)"cy", formatLength(value, circle->cy, circle->units));
+        xmlNewProp(newNode, (xmlChar*)"r", formatLength(value, circle->r, circle->units));
         addAttributesToXML(circle->otherAttributes, newNode);
 
         //Adds the new node to the SVG doc
         xmlAddChild(docHead, newNode);
-        free(value);
     }
 }
 
@@ -1144,118 +2285,120 @@ void setAttribute(SVGimage* image, elementType elemType, int elemIndex, Attribut
     if (image == NULL || newAttribute == NULL) return;
     if (newAttribute->name == NULL || newAttribute->value == NULL) return;
     if (elemType != RECT && elemType != CIRC && elemType != PATH && elemType != GROUP &&elemType != SVG_IMAGE) return;
-    if (!(validateRects(image->rectangles) && validateCircles(image->circles) && validatePaths(image->paths) && validateGroups(image->groups) && validateAttributes(image->otherAttributes))) return;
 
-    Node* node = NULL;
+    //Only the element being edited is checked, so that an edit does not cost a walk of the whole image
+    void* element = getComponentAt(image, elemType, elemIndex);
+    if (elemType != SVG_IMAGE && element == NULL) return;
+    if (!validateComponent(elemType, elemType == SVG_IMAGE ? image : element)) return;
+
+    bool moved = isGeometryAttribute(elemType, newAttribute->name);
+    applyAttribute(image, elemType, element, newAttribute);
+
+    //Moving a shape makes the cached image bounds stale and moves its spatial index entry.
+    //Groups are not affected, edits only reach top level shapes.
+    if (moved && image->index != NULL) {
+        image->index->boundsValid = false;
+        if (image->index->spatial != NULL) rtreeUpdate(image->index->spatial, element, getComponentBounds(image, elemType, element));
+    }
+}
+
+/**
+ * Does the edit for setAttribute, once the element has been found and checked.
+ * @param image The image being edited.
+ * @param elemType The element's type.
+ * @param element The element to edit. Unused for SVG_IMAGE.
+ * @param newAttribute Attribute to set. It is used or freed.
+ */
+void applyAttribute(SVGimage* image, elementType elemType, void* element, Attribute* newAttribute) {
     Attribute* attr = NULL;
     switch (elemType) {
         case SVG_IMAGE:
-            attr = existsInList(image->otherAttributes, newAttribute);
+            attr = existsInList(image->otherAttributes, image->strings, newAttribute->name);
             if (attr != NULL) {
-                //Free the old value, and calloc space for the new value.
-                free(attr->value);
-                attr->value = calloc(strlen(newAttribute->value) + 4, sizeof(char));
-                strcpy(attr->value, newAttribute->value);
+                //Free the old value, and allocate space for the new value.
+                setAttributeValue(image->otherAttributes, image->strings, attr, newAttribute->value);
             } else {
                 //Add the new attribute to the list
-                insertBack(image->otherAttributes, newAttribute);
+                insertAttribute(image->otherAttributes, image->strings, newAttribute);
                 return;
             }
             deleteAttribute(newAttribute);
             return;
 
         case CIRC:
-            //Sanity check
-            if (elemIndex > image->circles->length - 1 || elemIndex < 0) return;
-
-            //Finds the target node at the index
-            node = image->circles->head;
-            for (int i = 0; i < elemIndex; i++) { node = node->next; }
-
-            if (strcmp(newAttribute->name, "cx") == 0) {
-                //Set circle center x
-                ((Circle*)(node->data))->cx = strtof(newAttribute->value, NULL);
-            } else if (strcmp(newAttribute->name, "cy") == 0) {
-                //Set circle center y
-                ((Circle*)(node->data))->cy = strtof(newAttribute->value, NULL);
-            } else if (strcmp(newAttribute->name, "r") == 0) {
-                //Set radius
-                ((Circle*)(node->data))->r = strtof(newAttribute->value, NULL);
-            } else {
-                attr = existsInList(((Circle*)(node->data))->otherAttributes, newAttribute);
-                if (attr != NULL) {
-                    //Update the old attribute
-                    free(attr->value);
-                    attr->value = calloc(strlen(newAttribute->value) + 1, sizeof(char));
-                    strcpy(attr->value, newAttribute->value);
-                } else {
-                    //Add new attribute
-                    insertBack(((Circle*)(node->data))->otherAttributes, newAttribute);
-                    return;
-                }
+            switch (lookupKeyword(newAttribute->name)) {
+                case KEYWORD_CX:
+                    //Set circle center x
+                    ((Circle*)element)->cx = parseSVGNumber(newAttribute->value, NULL);
+                    break;
+                case KEYWORD_CY:
+                    //Set circle center y
+                    ((Circle*)element)->cy = parseSVGNumber(newAttribute->value, NULL);
+                    break;
+                case KEYWORD_R:
+                    //Set radius
+                    ((Circle*)element)->r = parseSVGNumber(newAttribute->value, NULL);
+                    break;
+                default:
+                    attr = existsInList(((Circle*)element)->otherAttributes, image->strings, newAttribute->name);
+                    if (attr != NULL) {
+                        //Update the old attribute
+                        setAttributeValue(((Circle*)element)->otherAttributes, image->strings, attr, newAttribute->value);
+                    } else {
+                        //Add new attribute
+                        insertAttribute(((Circle*)element)->otherAttributes, image->strings, newAttribute);
+                        return;
+                    }
+                    break;
             }
             deleteAttribute(newAttribute);
             return;
 
         case RECT:
-            //Sanity check
-            if (elemIndex > image->rectangles->length - 1 || elemIndex < 0) return;
-
-            //Finds the target node at the index
-            node = image->rectangles->head;
-            for (int i = 0; i < elemIndex; i++) { node = node->next; }
-
-            if (strcmp(newAttribute->name, "x") == 0) {
-                //Set rectangle x
-                ((Rectangle*)(node->data))->x = strtof(newAttribute->value, NULL);
-            } else if (strcmp(newAttribute->name, "y") == 0) {
-                //Set rectangle y
-                ((Rectangle*)(node->data))->y = strtof(newAttribute->value, NULL);
-            } else if (strcmp(newAttribute->name, "width") == 0) {
-                //Set rectangle width
-                ((Rectangle*)(node->data))->width = strtof(newAttribute->value, NULL);
-            } else if (strcmp(newAttribute->name, "height") == 0) {
-                //Set rectangle width
-                ((Rectangle*)(node->data))->height = strtof(newAttribute->value, NULL);
-            } else {
-                attr = existsInList(((Rectangle*)(node->data))->otherAttributes, newAttribute);
-                if (attr != NULL) {
-                    //Update the old attribute
-                    free(attr->value);
-                    attr->value = calloc(strlen(newAttribute->value) + 1, sizeof(char));
-                    strcpy(attr->value, newAttribute->value);
-                } else {
-                    //Add new attribute
-                    insertBack(((Rectangle*)(node->data))->otherAttributes, newAttribute);
-                    return;
-                }
+            switch (lookupKeyword(newAttribute->name)) {
+                case KEYWORD_X:
+                    //Set rectangle x
+                    ((Rectangle*)element)->x = parseSVGNumber(newAttribute->value, NULL);
+                    break;
+                case KEYWORD_Y:
+                    //Set rectangle y
+                    ((Rectangle*)element)->y = parseSVGNumber(newAttribute->value, NULL);
+                    break;
+                case KEYWORD_WIDTH:
+                    //Set rectangle width
+                    ((Rectangle*)element)->width = parseSVGNumber(newAttribute->value, NULL);
+                    break;
+                case KEYWORD_HEIGHT:
+                    //Set rectangle width
+                    ((Rectangle*)element)->height = parseSVGNumber(newAttribute->value, NULL);
+                    break;
+                default:
+                    attr = existsInList(((Rectangle*)element)->otherAttributes, image->strings, newAttribute->name);
+                    if (attr != NULL) {
+                        //Update the old attribute
+                        setAttributeValue(((Rectangle*)element)->otherAttributes, image->strings, attr, newAttribute->value);
+                    } else {
+                        //Add new attribute
+                        insertAttribute(((Rectangle*)element)->otherAttributes, image->strings, newAttribute);
+                        return;
+                    }
+                    break;
             }
             deleteAttribute(newAttribute);
             return;
 
         case PATH:
-            //Sanity check
-            if (elemIndex > image->paths->length - 1 || elemIndex < 0) return;
-
-            //Finds the target node at the index
-            node = image->paths->head;
-            for (int i = 0; i < elemIndex; i++) { node = node->next; }
-
-            if (strcmp(newAttribute->name, "d") == 0) {
-                //Set path data
-                free(((Path*)(node->data))->data);
-                ((Path*)(node->data))->data = calloc(strlen(newAttribute->value) + 1, sizeof(char));
-                strcpy(((Path*)(node->data))->data, newAttribute->value);
+            if (lookupKeyword(newAttribute->name) == KEYWORD_D) {
+                //Set path data. The cached parsed form no longer matches, so it is rebuilt when next asked for.
+                ((Path*)element)->data = replaceString(((Path*)element)->otherAttributes->arena, ((Path*)element)->data, newAttribute->value);
             } else {
-                attr = existsInList(((Path*)(node->data))->otherAttributes, newAttribute);
+                attr = existsInList(((Path*)element)->otherAttributes, image->strings, newAttribute->name);
                 if (attr != NULL) {
                     //Update the old attribute
-                    free(attr->value);
-                    attr->value = calloc(strlen(newAttribute->value), sizeof(char));
-                    strcpy(attr->value, newAttribute->value);
+                    setAttributeValue(((Path*)element)->otherAttributes, image->strings, attr, newAttribute->value);
                 } else {
                     //Add new attribute
-                    insertBack(((Path*)(node->data))->otherAttributes, newAttribute);
+                    insertAttribute(((Path*)element)->otherAttributes, image->strings, newAttribute);
                     return;
                 }
             }
@@ -1263,23 +2406,14 @@ void setAttribute(SVGimage* image, elementType elemType, int elemIndex, Attribut
             return;
 
         case GROUP:
-            //Sanity check
-            if (elemIndex > image->groups->length - 1 || elemIndex < 0) return;
-
-            //Finds the target node at the index
-            node = image->groups->head;
-            for (int i = 0; i < elemIndex; i++) { node = node->next; }
-
-            attr = existsInList(((Group*)(node->data))->otherAttributes, newAttribute);
+            attr = existsInList(((Group*)element)->otherAttributes, image->strings, newAttribute->name);
             if (attr != NULL) {
                 //Update the old attribute
-                free(attr->value);
-                attr->value = calloc(strlen(newAttribute->value) + 1, sizeof(char));
-                strcpy(attr->value, newAttribute->value);
+                setAttributeValue(((Group*)element)->otherAttributes, image->strings, attr, newAttribute->value);
                 deleteAttribute(newAttribute);
             } else {
                 //Add new attribute
-                insertBack(((Group*)(node->data))->otherAttributes, newAttribute);
+                insertAttribute(((Group*)element)->otherAttributes, image->strings, newAttribute);
             }
             return;
         default:
@@ -1288,18 +2422,585 @@ void setAttribute(SVGimage* image, elementType elemType, int elemIndex, Attribut
 }
 
 /**
- * Checks to see if the given attribute exists in the given list.
+ * Checks to see if an attribute with the given name exists in the given list.
+ * Names in an interned list are compared by address first, since the parser stores each distinct name once per image.
+ * Attributes added later, by edits or by the caller, may have their own copy, so a miss falls back to strcmp.
  * @param list List to look for attribute in.
- * @param attribute Attribute to look for.
+ * @param strings The image's string pool.
+ * @param name Name of the attribute to look for.
  * @return A pointer to the attribute in the list if it exists, otherwise NULL.
  */
-Attribute* existsInList(List* list, Attribute* attribute) {
+Attribute* existsInList(List* list, StringPool* strings, const char* name) {
     ListIterator iterator = createIterator(list);
     Attribute* node = NULL;
+    if (isInternedList(list)) {
+        SVGKeyword keyword = lookupKeyword(name);
+        const char* shared = (keyword != KEYWORD_UNKNOWN ? keywordName(keyword) : findString(strings, name));
+        while (shared != NULL && (node = nextElement(&iterator)) != NULL) {
+            if (node->name == shared) return node;
+        }
+        iterator = createIterator(list);
+    }
+
     while ((node = nextElement(&iterator)) != NULL) {
-        if (strcmp(node->name, attribute->name) == 0) return node;
+        if (strcmp(node->name, name) == 0) return node;
+    }
+    return NULL;
+}
+
+/**
+ * Finds one of the image's own (not nested) components by index, in constant time.
+ * @param image The image to search.
+ * @param type RECT, CIRC, PATH or GROUP.
+ * @param index 0 based index into the image's list of that type.
+ * @return The component, or NULL if the index is out of range or the type has no list.
+ */
+void* getComponentAt(SVGimage* image, elementType type, int index) {
+    return getVectorElement(getComponentView(image, type), index);
+}
+
+/**
+ * Gets the random access view of one of the image's top level component lists, building it if needed.
+ * @param image The image.
+ * @param type RECT, CIRC, PATH or GROUP.
+ * @return A Vector borrowing the list's elements, owned by the image. NULL for other types, or if memory could not
+ *         be allocated.
+ */
+Vector* getComponentView(SVGimage* image, elementType type) {
+    if (image == NULL) return NULL;
+
+    if (image->index == NULL && (image->index = calloc(1, sizeof(SVGindex))) == NULL) return NULL;
+    ListView* view = NULL;
+    List* list = NULL;
+    switch (type) {
+        case RECT:
+            view = &image->index->rectangles;
+            list = image->rectangles;
+            break;
+        case CIRC:
+            view = &image->index->circles;
+            list = image->circles;
+            break;
+        case PATH:
+            view = &image->index->paths;
+            list = image->paths;
+            break;
+        case GROUP:
+            view = &image->index->groups;
+            list = image->groups;
+            break;
+        default:
+            return NULL;
+    }
+    if (list == NULL) return NULL;
+
+    //addComponent keeps views in step, this catches lists that were changed directly
+    if (view->elements == NULL || view->version != list->version) {
+        freeVector(view->elements);
+        view->elements = listToVector(list);
+        view->version = list->version;
+    }
+    return view->elements;
+}
+
+/**
+ * Gets the flattened views of every component in an image, nested ones included, building them on first use. They
+ * are cached on the image and rebuilt once any of its lists has changed since, the same way as its bounds.
+ * @param image The image.
+ * @return The views, owned by the image. NULL if memory could not be allocated.
+ */
+const ComponentViews* getComponentViews(SVGimage* image) {
+    if (image->index == NULL && (image->index = calloc(1, sizeof(SVGindex))) == NULL) return NULL;
+    ComponentViews* views = &image->index->views;
+    unsigned long version = getImageVersion(image);
+    if (views->groups != NULL) {
+        if (image->index->viewsVersion == version) return views;
+        freeComponentViews(views);
+    }
+    buildComponentViews(image, views);
+    image->index->viewsVersion = version;
+    return views;
+}
+
+/**
+ * Builds flattened views of every component in an image, nested ones included, in the order the get* functions
+ * return them: the image's own components, then those in each group of views->groups.
+ * @param image The image.
+ * @param views Set to the views, which the caller frees with freeComponentViews.
+ */
+void buildComponentViews(const SVGimage* image, ComponentViews* views) {
+    views->groups = initializeVector(groupToString, borrowedVectorData, compareGroups);
+    for (Node* node = image->groups->head; node != NULL; node = node->next) {
+        collectGroups(views->groups, node->data);
+    }
+
+    views->rectangles = listToVector(image->rectangles);
+    views->circles = listToVector(image->circles);
+    views->paths = listToVector(image->paths);
+    for (int i = 0; i < views->groups->length; i++) {
+        Group* group = views->groups->data[i];
+        for (Node* node = group->rectangles->head; node != NULL; node = node->next) {
+            insertBackVector(views->rectangles, node->data);
+        }
+        for (Node* node = group->circles->head; node != NULL; node = node->next) {
+            insertBackVector(views->circles, node->data);
+        }
+        for (Node* node = group->paths->head; node != NULL; node = node->next) {
+            insertBackVector(views->paths, node->data);
+        }
+    }
+}
+
+/**
+ * Frees views made by buildComponentViews. The components they refer to are not freed.
+ * @param views The views.
+ */
+void freeComponentViews(ComponentViews* views) {
+    freeVector(views->rectangles);
+    freeVector(views->circles);
+    freeVector(views->paths);
+    freeVector(views->groups);
+    *views = (ComponentViews){NULL, NULL, NULL, NULL};
+}
+
+/**
+ * Gets the view of one type from views made by buildComponentViews.
+ * @param views The views.
+ * @param type RECT, CIRC, PATH or GROUP.
+ * @return The view, or NULL for other types.
+ */
+Vector* getComponentsOfType(const ComponentViews* views, elementType type) {
+    switch (type) {
+        case RECT:
+            return views->rectangles;
+        case CIRC:
+            return views->circles;
+        case PATH:
+            return views->paths;
+        case GROUP:
+            return views->groups;
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * Adds a group and every group inside it to a vector, depth first, with nested groups before their parent.
+ * @param groups The vector to add to.
+ * @param root The group to start from.
+ */
+void collectGroups(Vector* groups, Group* root) {
+    for (Node* node = root->groups->head; node != NULL; node = node->next) {
+        collectGroups(groups, node->data);
+    }
+    insertBackVector(groups, root);
+}
+
+/**
+ * Counts every component in an image, nested ones included, without building any list.
+ * @param image The image.
+ * @param counts Set to the lengths of the lists the get* functions would return.
+ */
+void countImageComponents(const SVGimage* image, ComponentCounts* counts) {
+    *counts = (ComponentCounts){image->rectangles->length, image->circles->length, image->paths->length, 0};
+    for (Node* node = image->groups->head; node != NULL; node = node->next) {
+        countGroupComponents(node->data, counts);
+    }
+}
+
+/**
+ * Adds a group, and everything in it, to component counts.
+ * @param group The group.
+ * @param counts The counts to add to.
+ */
+void countGroupComponents(const Group* group, ComponentCounts* counts) {
+    counts->rectangles += group->rectangles->length;
+    counts->circles += group->circles->length;
+    counts->paths += group->paths->length;
+    counts->groups++;
+    for (Node* node = group->groups->head; node != NULL; node = node->next) {
+        countGroupComponents(node->data, counts);
+    }
+}
+
+/**
+ * Gets the newest version of any of an image's component lists, its groups' included. Every insert, delete or clear
+ * through the list functions gives a list a version no list has had, so this changes whenever the image's structure
+ * does. It costs a walk of the groups, not of the components.
+ * @param image The image.
+ * @return The version.
+ */
+unsigned long getImageVersion(const SVGimage* image) {
+    unsigned long version = image->groups->version;
+    if (image->rectangles->version > version) version = image->rectangles->version;
+    if (image->circles->version > version) version = image->circles->version;
+    if (image->paths->version > version) version = image->paths->version;
+    for (Node* node = image->groups->head; node != NULL; node = node->next) {
+        unsigned long groupVersion = getGroupVersion(node->data);
+        if (groupVersion > version) version = groupVersion;
+    }
+    return version;
+}
+
+/**
+ * Gets the newest version of any of a group's component lists, its nested groups' included.
+ * @param group The group.
+ * @return The version.
+ */
+unsigned long getGroupVersion(const Group* group) {
+    unsigned long version = group->groups->version;
+    if (group->rectangles->version > version) version = group->rectangles->version;
+    if (group->circles->version > version) version = group->circles->version;
+    if (group->paths->version > version) version = group->paths->version;
+    for (Node* node = group->groups->head; node != NULL; node = node->next) {
+        unsigned long groupVersion = getGroupVersion(node->data);
+        if (groupVersion > version) version = groupVersion;
+    }
+    return version;
+}
+
+/**
+ * Copies one type of component from an image, nested ones included, into a new list that does not own them.
+ * @param image The image.
+ * @param type RECT, CIRC, PATH or GROUP.
+ * @return The new list, in get* order, which the caller frees with freeList.
+ */
+List* flatViewToList(SVGimage* image, elementType type) {
+    List* list = NULL;
+    switch (type) {
+        case RECT:
+            list = initializeList(rectangleToString, dummy, compareRectangles);
+            break;
+        case CIRC:
+            list = initializeList(circleToString, dummy, compareCircles);
+            break;
+        case PATH:
+            list = initializeList(pathToString, dummy, comparePaths);
+            break;
+        case GROUP:
+            list = initializeList(groupToString, dummy, compareGroups);
+            break;
+        default:
+            return NULL;
+    }
+    const ComponentViews* views = getComponentViews(image);
+    Vector* view = (views == NULL ? NULL : getComponentsOfType(views, type));
+    for (int i = 0; view != NULL && i < view->length; i++) {
+        insertBack(list, view->data[i]);
+    }
+    return list;
+}
+
+/**
+ * Frees an image's lookup structures. The components they refer to are not freed.
+ * @param index The index to free. May be NULL.
+ */
+void deleteImageIndex(SVGindex* index) {
+    if (index == NULL) return;
+    freeVector(index->rectangles.elements);
+    freeVector(index->circles.elements);
+    freeVector(index->paths.elements);
+    freeVector(index->groups.elements);
+    freeComponentViews(&index->views);
+    freeRTree(index->spatial);
+    freePathGeometryCache(index->geometry);
+    free(index);
+}
+
+/**
+ * Gets the box containing a rectangle. Units are ignored.
+ * @param rect The rectangle.
+ * @return The rectangle's bounding box.
+ */
+BoundingBox getRectBounds(const Rectangle* rect) {
+    BoundingBox box = {rect->x, rect->y, rect->x + rect->width, rect->y + rect->height};
+    return box;
+}
+
+/**
+ * Gets the box containing a circle. Units are ignored.
+ * @param circle The circle.
+ * @return The circle's bounding box.
+ */
+BoundingBox getCircleBounds(const Circle* circle) {
+    BoundingBox box = {circle->cx - circle->r, circle->cy - circle->r, circle->cx + circle->r, circle->cy + circle->r};
+    return box;
+}
+
+/**
+ * Gets the box containing a path, parsing its data into a geometry that is thrown away afterwards.
+ * @param path The path.
+ * @return The path's bounding box, empty if it has no drawable data.
+ */
+BoundingBox getPathBounds(Path* path) {
+    PathGeometry* geometry = parsePathGeometry(path->data, NULL);
+    BoundingBox box = (geometry == NULL ? emptyBounds() : geometry->bounds);
+    deletePathGeometry(geometry);
+    return box;
+}
+
+/**
+ * Gets the box containing a path, from the geometry cached in its image.
+ * @param image The image the path is in, or NULL to parse the path without caching it.
+ * @param path The path.
+ * @return The path's bounding box, empty if it has no drawable data.
+ */
+BoundingBox getCachedPathBounds(SVGimage* image, Path* path) {
+    if (image == NULL) return getPathBounds(path);
+    PathGeometry* geometry = getPathGeometry(image, path);
+    return (geometry == NULL ? emptyBounds() : geometry->bounds);
+}
+
+/**
+ * Gets the box containing everything in a group, including nested groups. It is worked out on every call, since a
+ * Group has nowhere private to keep it. Callers that need every group's box use collectGroupBounds.
+ * @param group The group.
+ * @return The group's bounding box, empty if it has no shapes.
+ */
+BoundingBox getGroupBounds(Group* group) {
+    BoundingBox box = emptyBounds();
+    addShapeBounds(NULL, &box, group->rectangles, group->circles, group->paths);
+    for (Node* node = group->groups->head; node != NULL; node = node->next) {
+        boundsAddBox(&box, getGroupBounds(node->data));
+    }
+    return box;
+}
+
+/**
+ * Gets the boxes of a group and of every group inside it, each worked out once, in the order collectGroups adds them.
+ * @param image The image the group is in, whose cached path geometry is used.
+ * @param group The group to start from.
+ * @param boxes Array to store the boxes in, with room for the group and all of its nested groups. NULL to only
+ *              get the group's box.
+ * @param next Index in boxes of the next box to store. Advanced past the boxes stored. Unused if boxes is NULL.
+ * @return The group's bounding box.
+ */
+BoundingBox collectGroupBounds(SVGimage* image, Group* group, BoundingBox* boxes, int* next) {
+    BoundingBox box = emptyBounds();
+    for (Node* node = group->groups->head; node != NULL; node = node->next) {
+        boundsAddBox(&box, collectGroupBounds(image, node->data, boxes, next));
+    }
+    addShapeBounds(image, &box, group->rectangles, group->circles, group->paths);
+    if (boxes != NULL) boxes[(*next)++] = box;
+    return box;
+}
+
+/**
+ * Gets the box containing every shape in an image, including those in groups. The result is cached on the image
+ * until a list in it changes.
+ * @param image The image.
+ * @return The image's bounding box, empty if it has no shapes or memory could not be allocated.
+ */
+BoundingBox getImageBounds(SVGimage* image) {
+    if (image->index == NULL && (image->index = calloc(1, sizeof(SVGindex))) == NULL) return emptyBounds();
+    unsigned long version = getImageVersion(image);
+    if (image->index->boundsValid && image->index->boundsVersion == version) return image->index->bounds;
+
+    BoundingBox box = emptyBounds();
+    addShapeBounds(image, &box, image->rectangles, image->circles, image->paths);
+    for (Node* node = image->groups->head; node != NULL; node = node->next) {
+        boundsAddBox(&box, collectGroupBounds(image, node->data, NULL, NULL));
+    }
+    image->index->bounds = box;
+    image->index->boundsValid = true;
+    image->index->boundsVersion = version;
+    return box;
+}
+
+/**
+ * Drops an image's cached bounding box.
+ * @param image The image.
+ */
+void invalidateBounds(SVGimage* image) {
+    if (image == NULL || image->index == NULL) return;
+    image->index->boundsValid = false;
+}
+
+/**
+ * Finds every shape, nested ones included, whose bounding box intersects an area, using the image's spatial index.
+ * @param image The image.
+ * @param area The area to search.
+ * @return A new Vector of RTreeEntry pointers owned by the index, or NULL if image is NULL. Free it with freeVector.
+ */
+Vector* getComponentsInArea(SVGimage* image, BoundingBox area) {
+    RTree* tree = getSpatialIndex(image);
+    if (tree == NULL) return NULL;
+    Vector* results = initializeVector(rtreeEntryToString, borrowedVectorData, compareRTreeEntries);
+    rtreeSearch(tree, area, results);
+    return results;
+}
+
+/**
+ * Finds every shape, nested ones included, whose bounding box contains a point, using the image's spatial index.
+ * @param image The image.
+ * @param x The point's x coordinate.
+ * @param y The point's y coordinate.
+ * @return A new Vector of RTreeEntry pointers owned by the index, or NULL if image is NULL. Free it with freeVector.
+ */
+Vector* getComponentsAtPoint(SVGimage* image, float x, float y) {
+    RTree* tree = getSpatialIndex(image);
+    if (tree == NULL) return NULL;
+    Vector* results = initializeVector(rtreeEntryToString, borrowedVectorData, compareRTreeEntries);
+    rtreeSearchPoint(tree, x, y, results);
+    return results;
+}
+
+/**
+ * Gets the image's spatial index of every rectangle, circle and path, bulk loading it on first use.
+ * addComponent and setAttribute keep it up to date. It is bulk loaded again if a list in the image was changed
+ * directly, which is checked with a walk of the image's groups.
+ * @param image The image.
+ * @return The index, owned by the image. NULL if image is NULL or memory could not be allocated.
+ */
+RTree* getSpatialIndex(SVGimage* image) {
+    if (image == NULL) return NULL;
+    if (image->index == NULL && (image->index = calloc(1, sizeof(SVGindex))) == NULL) return NULL;
+    unsigned long version = getImageVersion(image);
+    if (image->index->spatial != NULL) {
+        if (image->index->spatialVersion == version) return image->index->spatial;
+        freeRTree(image->index->spatial);
+        image->index->spatial = NULL;
+    }
+
+    elementType types[] = {RECT, CIRC, PATH};
+    const ComponentViews* views = getComponentViews(image);
+    if (views == NULL) return NULL;
+    int count = views->rectangles->length + views->circles->length + views->paths->length;
+
+    RTreeEntry* entries = malloc((count > 0 ? count : 1) * sizeof(RTreeEntry));
+    if (entries == NULL) return NULL;
+    int entry = 0;
+    for (int i = 0; i < 3; i++) {
+        Vector* view = getComponentsOfType(views, types[i]);
+        for (int j = 0; j < view->length; j++) {
+            void* component = view->data[j];
+            entries[entry].bounds = getComponentBounds(image, types[i], component);
+            entries[entry].type = types[i];
+            entries[entry].data = component;
+            entries[entry].stale = false;
+            entry++;
+        }
+    }
+    image->index->spatial = createRTree(entries, count);
+    image->index->spatialVersion = version;
+    free(entries);
+    return image->index->spatial;
+}
+
+/**
+ * C equivalent of a Java toString, but for spatial index entries
+ * @param data void pointer to an RTreeEntry struct.
+ * @return A string with the entry's type and bounding box.
+ */
+char* rtreeEntryToString(void* data) {
+    RTreeEntry* entry = data;
+    char* string = calloc(128, sizeof(char));
+    snprintf(string, 128, "[ENTRY] type: %d bounds: %.2f %.2f %.2f %.2f", entry->type, entry->bounds.minX, entry->bounds.minY,
+             entry->bounds.maxX, entry->bounds.maxY);
+    return string;
+}
+
+/**
+ * Orders spatial index entries by type, then by bounding box, then by the component they hold, so that two
+ * entries compare equal only if they are the same component with the same box.
+ * @param first void pointer to an RTreeEntry.
+ * @param second void pointer to an RTreeEntry.
+ * @return Negative, zero or positive as first sorts before, with or after second.
+ */
+int compareRTreeEntries(const void* first, const void* second) {
+    const RTreeEntry* a = first;
+    const RTreeEntry* b = second;
+    if (a->type != b->type) return (a->type > b->type) - (a->type < b->type);
+    const float keysA[4] = {a->bounds.minX, a->bounds.minY, a->bounds.maxX, a->bounds.maxY};
+    const float keysB[4] = {b->bounds.minX, b->bounds.minY, b->bounds.maxX, b->bounds.maxY};
+    for (int i = 0; i < 4; i++) {
+        if (keysA[i] != keysB[i]) return (keysA[i] > keysB[i]) - (keysA[i] < keysB[i]);
+    }
+    return comparePointers(&a->data, &b->data);
+}
+
+/**qsort and bsearch callback ordering an array of pointers by address*/
+int comparePointers(const void* first, const void* second) {
+    uintptr_t a = (uintptr_t)*(void* const*)first, b = (uintptr_t)*(void* const*)second;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Grows a box to contain lists of shapes. The rectangles' and circles' corners are gathered into contiguous
+ * coordinate arrays first, so the min/max work runs through the vector kernel.
+ * @param image The image the shapes are in, whose cached path geometry is used. NULL to parse paths without caching.
+ * @param box The box to grow.
+ * @param rectangles List of Rectangles.
+ * @param circles List of Circles.
+ * @param paths List of Paths.
+ */
+void addShapeBounds(SVGimage* image, BoundingBox* box, List* rectangles, List* circles, List* paths) {
+    int corners = 2 * (rectangles->length + circles->length);
+    if (corners > 0) {
+        float* x = malloc(corners * sizeof(float));
+        float* y = malloc(corners * sizeof(float));
+        int i = 0;
+        for (Node* node = rectangles->head; node != NULL; node = node->next) {
+            BoundingBox shape = getRectBounds(node->data);
+            x[i] = shape.minX;
+            y[i++] = shape.minY;
+            x[i] = shape.maxX;
+            y[i++] = shape.maxY;
+        }
+        for (Node* node = circles->head; node != NULL; node = node->next) {
+            BoundingBox shape = getCircleBounds(node->data);
+            x[i] = shape.minX;
+            y[i++] = shape.minY;
+            x[i] = shape.maxX;
+            y[i++] = shape.maxY;
+        }
+        boundsAddPoints(box, x, y, corners);
+        free(x);
+        free(y);
+    }
+    for (Node* node = paths->head; node != NULL; node = node->next) {
+        boundsAddBox(box, getCachedPathBounds(image, node->data));
+    }
+}
+
+/**
+ * Gets the bounding box of a rectangle, circle or path.
+ * @param image The image the component is in, whose cached path geometry is used.
+ * @param type RECT, CIRC or PATH.
+ * @param component The component.
+ * @return Its bounding box, or an empty box for other types.
+ */
+BoundingBox getComponentBounds(SVGimage* image, elementType type, void* component) {
+    switch (type) {
+        case RECT:
+            return getRectBounds(component);
+        case CIRC:
+            return getCircleBounds(component);
+        case PATH:
+            return getCachedPathBounds(image, component);
+        default:
+            return emptyBounds();
+    }
+}
+
+/**
+ * Checks whether setting an attribute moves or resizes a component.
+ * @param type The component's type.
+ * @param name The attribute name.
+ * @return true for x, y, width and height on rectangles, cx, cy and r on circles and d on paths.
+ */
+bool isGeometryAttribute(elementType type, const char* name) {
+    SVGKeyword keyword = lookupKeyword(name);
+    switch (type) {
+        case RECT:
+            return keyword == KEYWORD_X || keyword == KEYWORD_Y || keyword == KEYWORD_WIDTH || keyword == KEYWORD_HEIGHT;
+        case CIRC:
+            return keyword == KEYWORD_CX || keyword == KEYWORD_CY || keyword == KEYWORD_R;
+        case PATH:
+            return keyword == KEYWORD_D;
+        default:
+            return false;
     }
-    return NULL;
 }
 
 /**
@@ -1311,20 +3012,54 @@ Attribute* existsInList(List* list, Attribute* attribute) {
 void addComponent(SVGimage* image, elementType type, void* newElement) {
     if (image == NULL || newElement == NULL) return;
     if (type != RECT && type != CIRC && type != PATH) return;
-    if (!(validateRects(image->rectangles) && validateCircles(image->circles) && validatePaths(image->paths) && validateGroups(image->groups) && validateAttributes(image->otherAttributes))) return;
+    //Check the image and the new element only, so that adding stays constant time
+    if (!validateComponent(SVG_IMAGE, image) || !validateComponent(type, newElement)) return;
 
+    //Arena images take ownership of the heap allocated element by freeing it along with the arena
+    List* list = NULL;
+    ListView* view = NULL;
     switch (type) {
         case RECT:
-            insertBack(image->rectangles, newElement);
+            list = image->rectangles;
+            if (image->arena != NULL) arenaAddCleanup(image->arena, newElement, deleteRectangle);
+            if (image->index != NULL) view = &image->index->rectangles;
             break;
         case CIRC:
-            insertBack(image->circles, newElement);
+            list = image->circles;
+            if (image->arena != NULL) arenaAddCleanup(image->arena, newElement, deleteCircle);
+            if (image->index != NULL) view = &image->index->circles;
             break;
         case PATH:
-            insertBack(image->paths, newElement);
+            list = image->paths;
+            if (image->arena != NULL) arenaAddCleanup(image->arena, newElement, deletePath);
+            if (image->index != NULL) view = &image->index->paths;
             break;
         default:
-            break;
+            return;
+    }
+    //Keep the random access view in step with the list, unless it was already out of date
+    bool viewCurrent = (view != NULL && view->elements != NULL && view->version == list->version);
+    //The cached bounds and spatial index are only updated in place if nothing else changed since they were made
+    SVGindex* index = image->index;
+    unsigned long version = 0;
+    if (index != NULL && (index->boundsValid || index->spatial != NULL)) version = getImageVersion(image);
+    bool boundsCurrent = (index != NULL && index->boundsValid && index->boundsVersion == version);
+    bool spatialCurrent = (index != NULL && index->spatial != NULL && index->spatialVersion == version);
+
+    insertBack(list, newElement);
+    if (viewCurrent) {
+        insertBackVector(view->elements, newElement);
+        view->version = list->version;
+    }
+    //Grow the cached image bounds instead of recomputing them, and add the element to the spatial index.
+    //No list has a newer version than the one just edited, so it is the image's version now.
+    if (boundsCurrent) {
+        boundsAddBox(&index->bounds, getComponentBounds(image, type, newElement));
+        index->boundsVersion = list->version;
+    }
+    if (spatialCurrent) {
+        rtreeInsert(index->spatial, type, newElement, getComponentBounds(image, type, newElement));
+        index->spatialVersion = list->version;
     }
 }
 
@@ -1334,14 +3069,9 @@ void addComponent(SVGimage* image, elementType type, void* newElement) {
  * @return JSON string representing the Attribute.
  */
 char* attrToJSON(const Attribute *a) {
-    if (a == NULL) {
-        char* retString = calloc(3, sizeof(char));
-        strcat(retString, "{}");
-        return retString;
-    }
-    char* string = calloc(strlen(a->name) + strlen(a->value) + 128, sizeof(char));
-    sprintf(string, "{\"name\":\"%s\",\"value\":\"%s\"}", a->name, a->value);
-    return string;
+    StringBuffer* buffer = createStringBuffer(0);
+    writeAttrJSON(buffer, a);
+    return bufferRelease(buffer);
 }
 
 /**
@@ -1350,17 +3080,9 @@ char* attrToJSON(const Attribute *a) {
  * @return JSON string representing the Circle.
  */
 char* circleToJSON(const Circle *c) {
-    if (c == NULL) {
-        char* retString = calloc(3, sizeof(char));
-        strcat(retString, "{}");
-        return retString;
-    }
-    char* attrList = attrListToJSON(c->otherAttributes);
-    char* string = calloc(strlen(c->units) + strlen(attrList) + 128, sizeof(char));
-    sprintf(string, "{\"cx\":%.2f,\"cy\":%.2f,\"r\":%.2f,\"numAttr\":%d,\"units\":\"%s\",\"otherAttrs\":%s}",
-            c->cx, c->cy, c->r, c->otherAttributes->length, c->units, attrList);
-    free(attrList);
-    return string;
+    StringBuffer* buffer = createStringBuffer(0);
+    writeCircleJSON(buffer, c);
+    return bufferRelease(buffer);
 }
 
 /**
@@ -1369,18 +3091,9 @@ char* circleToJSON(const Circle *c) {
  * @return JSON string representing the Rectangle.
  */
 char* rectToJSON(const Rectangle *r) {
-    if (r == NULL) {
-        char* retString = calloc(3, sizeof(char));
-        strcat(retString, "{}");
-        return retString;
-    }
-
-    char* attrList = attrListToJSON(r->otherAttributes);
-    char* string = calloc(strlen(r->units) + strlen(attrList) + 128, sizeof(char));
-    sprintf(string, "{\"x\":%.2f,\"y\":%.2f,\"w\":%.2f,\"h\":%.2f,\"numAttr\":%d,\"units\":\"%s\",\"otherAttrs\":%s}",
-            r->x, r->y, r->width, r->height, r->otherAttributes->length, r->units, attrList);
-    free(attrList);
-    return string;
+    StringBuffer* buffer = createStringBuffer(0);
+    writeRectJSON(buffer, r);
+    return bufferRelease(buffer);
 }
 
 /**
@@ -1389,20 +3102,9 @@ char* rectToJSON(const Rectangle *r) {
  * @return JSON string representing the Path.
  */
 char* pathToJSON(const Path *p) {
-    if (p == NULL) {
-        char* retString = calloc(3, sizeof(char));
-        strcat(retString, "{}");
-        return retString;
-    }
-    char* attrList = attrListToJSON(p->otherAttributes);
-    char* string = calloc(strlen(p->data) + strlen(attrList) + 128, sizeof(char));
-    char* pathData = calloc(65, sizeof(char));
-    strncpy(pathData, p->data, 64);
-    sprintf(string, "{\"d\":\"%s\",\"numAttr\":%d,\"otherAttrs\":%s}",
-            pathData, p->otherAttributes->length, attrList);
-    free(pathData);
-    free(attrList);
-    return string;
+    StringBuffer* buffer = createStringBuffer(0);
+    writePathJSON(buffer, p);
+    return bufferRelease(buffer);
 }
 
 /**
@@ -1411,17 +3113,9 @@ char* pathToJSON(const Path *p) {
  * @return JSON string representing the Group.
  */
 char* groupToJSON(const Group *g) {
-    if (g == NULL) {
-        char* retString = calloc(3, sizeof(char));
-        strcat(retString, "{}");
-        return retString;
-    }
-    char* attrList = attrListToJSON(g->otherAttributes);
-    char* string = calloc(strlen(attrList) + 128, sizeof(char));
-    sprintf(string, "{\"children\":%d,\"numAttr\":%d,\"otherAttrs\":%s}",
-            g->rectangles->length + g->circles->length + g->paths->length + g->groups->length, g->otherAttributes->length, attrList);
-    free(attrList);
-    return string;
+    StringBuffer* buffer = createStringBuffer(0);
+    writeGroupJSON(buffer, g);
+    return bufferRelease(buffer);
 }
 
 /**
@@ -1435,16 +3129,20 @@ char* SVGtoJSON(const SVGimage* imge) {
         strcat(retString, "{}");
         return retString;
     }
+    ComponentCounts counts;
+    countImageComponents(imge, &counts);
+    return countsToJSON(&counts);
+}
+
+/**
+ * Creates the JSON string SVGtoJSON returns from an image's component counts.
+ * @param counts The counts, nested components included.
+ * @return JSON string with the four counts.
+ */
+char* countsToJSON(const ComponentCounts* counts) {
     char* string = calloc(128, sizeof(char));
-    List* rects = getRects((SVGimage*)imge);
-    List* circles = getCircles((SVGimage*)imge);
-    List* paths = getPaths((SVGimage*)imge);
-    List* groups = getGroups((SVGimage*)imge);
-    sprintf(string, "{\"numRect\":%d,\"numCirc\":%d,\"numPaths\":%d,\"numGroups\":%d}", rects->length, circles->length, paths->length, groups->length);
-    freeList(rects);
-    freeList(circles);
-    freeList(paths);
-    freeList(groups);
+    sprintf(string, "{\"numRect\":%d,\"numCirc\":%d,\"numPaths\":%d,\"numGroups\":%d}", counts->rectangles,
+            counts->circles, counts->paths, counts->groups);
     return string;
 }
 
@@ -1454,28 +3152,7 @@ char* SVGtoJSON(const SVGimage* imge) {
  * @return JSON string representing the list of Attributes.
  */
 char* attrListToJSON(const List *list) {
-    //Sanity checking
-    if (list == NULL || list->head == NULL) {
-        char* retString = calloc(3, sizeof(char));
-        strcpy(retString, "[]");
-        return retString;
-    }
-    //List initialization
-    ListIterator listIterator = createIterator((List*)list);
-    Attribute* attribute = NULL;
-    char* string = calloc(4, sizeof(char));
-    string[0] = '[';
-    //Create the string, iterating through each element
-    while ((attribute = nextElement(&listIterator)) != NULL) {
-        char* attrJSON = attrToJSON(attribute);
-        string = realloc(string, strlen(string) + strlen(attrJSON) + 8);
-        strcat(string, attrJSON);
-        strcat(string, ",");
-        free(attrJSON);
-    }
-    //Close off the JSON string and return
-    *strrchr(string, ',') = ']';
-    return string;
+    return listToJSON(list, writeAttrJSON);
 }
 
 /**
@@ -1484,28 +3161,7 @@ char* attrListToJSON(const List *list) {
  * @return JSON string representing the list of Circles.
  */
 char* circListToJSON(const List *list) {
-    //Sanity checking
-    if (list == NULL || list->head == NULL) {
-        char* retString = calloc(3, sizeof(char));
-        strcpy(retString, "[]");
-        return retString;
-    }
-    //List initialization
-    ListIterator listIterator = createIterator((List*)list);
-    Circle* circle = NULL;
-    char* string = calloc(4, sizeof(char));
-    string[0] = '[';
-    //Create the string, iterating through each element
-    while ((circle = nextElement(&listIterator)) != NULL) {
-        char* circleJSON = circleToJSON(circle);
-        string = realloc(string, strlen(string) + strlen(circleJSON) + 8);
-        strcat(string, circleJSON);
-        strcat(string, ",");
-        free(circleJSON);
-    }
-    //Close off the JSON string and return
-    *strrchr(string, ',') = ']';
-    return string;
+    return listToJSON(list, writeCircleJSON);
 }
 
 /**
@@ -1514,28 +3170,7 @@ char* circListToJSON(const List *list) {
  * @return JSON string representing the list of Rectangles.
  */
 char* rectListToJSON(const List *list) {
-    //Sanity checking
-    if (list == NULL || list->head == NULL) {
-        char* retString = calloc(3, sizeof(char));
-        strcpy(retString, "[]");
-        return retString;
-    }
-    //List initialization
-    ListIterator listIterator = createIterator((List*)list);
-    Rectangle* rectangle = NULL;
-    char* string = calloc(4, sizeof(char));
-    string[0] = '[';
-    //Create the string, iterating through each element
-    while ((rectangle = nextElement(&listIterator)) != NULL) {
-        char* rectJSON = rectToJSON(rectangle);
-        string = realloc(string, strlen(string) + strlen(rectJSON) + 8);
-        strcat(string, rectJSON);
-        strcat(string, ",");
-        free(rectJSON);
-    }
-    //Close off the JSON string and return
-    *strrchr(string, ',') = ']';
-    return string;
+    return listToJSON(list, writeRectJSON);
 }
 
 /**
@@ -1544,28 +3179,7 @@ char* rectListToJSON(const List *list) {
  * @return JSON string representing the list of Paths.
  */
 char* pathListToJSON(const List *list) {
-    //Sanity checking
-    if (list == NULL || list->head == NULL) {
-        char* retString = calloc(3, sizeof(char));
-        strcpy(retString, "[]");
-        return retString;
-    }
-    //List initialization
-    ListIterator listIterator = createIterator((List*)list);
-    Path* path = NULL;
-    char* string = calloc(4, sizeof(char));
-    string[0] = '[';
-    //Create the string, iterating through each element
-    while ((path = nextElement(&listIterator)) != NULL) {
-        char* pathJSON = pathToJSON(path);
-        string = realloc(string, strlen(string) + strlen(pathJSON) + 8);
-        strcat(string, pathJSON);
-        strcat(string, ",");
-        free(pathJSON);
-    }
-    //Close off the JSON string and return
-    *strrchr(string, ',') = ']';
-    return string;
+    return listToJSON(list, writePathJSON);
 }
 
 /**
@@ -1574,28 +3188,318 @@ char* pathListToJSON(const List *list) {
  * @return JSON string representing the list of Groups.
  */
 char* groupListToJSON(const List *list) {
-    //Sanity checking
-    if (list == NULL || list->head == NULL) {
-        char* retString = calloc(3, sizeof(char));
-        strcpy(retString, "[]");
-        return retString;
+    return listToJSON(list, writeGroupJSON);
+}
+
+/**
+ * Creates a JSON array string for a list, writing every element into one buffer.
+ * @param list The list. May be NULL, which gives an empty array.
+ * @param writeElement Function that appends one element's JSON to the buffer.
+ * @return JSON string representing the list.
+ */
+char* listToJSON(const List* list, void (*writeElement)(StringBuffer* out, const void* data)) {
+    StringBuffer* buffer = createStringBuffer(0);
+    writeListJSON(buffer, list, writeElement);
+    return bufferRelease(buffer);
+}
+
+/**
+ * Appends a JSON array for a list to a buffer.
+ * @param out The buffer to append to.
+ * @param list The list. May be NULL, which gives an empty array.
+ * @param writeElement Function that appends one element's JSON to the buffer.
+ */
+void writeListJSON(StringBuffer* out, const List* list, void (*writeElement)(StringBuffer* out, const void* data)) {
+    bufferAppendChar(out, '[');
+    if (list != NULL) {
+        for (Node* node = list->head; node != NULL; node = node->next) {
+            if (node != list->head) bufferAppendChar(out, ',');
+            writeElement(out, node->data);
+        }
     }
-    //List initialization
-    ListIterator listIterator = createIterator((List*)list);
-    Group* group = NULL;
-    char* string = calloc(4, sizeof(char));
-    string[0] = '[';
-    //Create the string, iterating through each element
-    while ((group = nextElement(&listIterator)) != NULL) {
-        char* groupJSON = groupToJSON(group);
-        string = realloc(string, strlen(string) + strlen(groupJSON) + 8);
-        strcat(string, groupJSON);
-        strcat(string, ",");
-        free(groupJSON);
-    }
-    //Close off the JSON string and return
-    *strrchr(string, ',') = ']';
-    return string;
+    bufferAppendChar(out, ']');
+}
+
+/**
+ * Appends a JSON array for every component of a type in an image, nested ones included, in get* order.
+ * @param out The buffer to append to.
+ * @param image The image.
+ * @param type RECT, CIRC, PATH or GROUP.
+ * @param writeElement Function that appends one element's JSON to the buffer.
+ */
+void writeComponentsJSON(StringBuffer* out, SVGimage* image, elementType type, void (*writeElement)(StringBuffer* out, const void* data)) {
+    const ComponentViews* views = getComponentViews(image);
+    Vector* view = (views == NULL ? NULL : getComponentsOfType(views, type));
+    bufferAppendChar(out, '[');
+    for (int i = 0; view != NULL && i < view->length; i++) {
+        if (i > 0) bufferAppendChar(out, ',');
+        writeElement(out, view->data[i]);
+    }
+    bufferAppendChar(out, ']');
+}
+
+/**
+ * Exports one page of an image's components of a type as JSON. See SVGParser.h.
+ * @param image The image.
+ * @param type RECT, CIRC, PATH or GROUP.
+ * @param offset How many components that pass the filter to skip.
+ * @param limit The most components to export.
+ * @param filter The conditions components must meet, or NULL for none.
+ * @return Newly allocated JSON, or NULL for other types or if memory could not be allocated.
+ */
+char* componentPageToJSON(SVGimage* image, elementType type, int offset, int limit, const ComponentFilter* filter) {
+    const char* name = NULL;
+    void (*writeElement)(StringBuffer* out, const void* data) = NULL;
+    switch (type) {
+        case RECT:
+            name = "rectangles";
+            writeElement = writeRectJSON;
+            break;
+        case CIRC:
+            name = "circles";
+            writeElement = writeCircleJSON;
+            break;
+        case PATH:
+            name = "paths";
+            writeElement = writePathJSON;
+            break;
+        case GROUP:
+            name = "groups";
+            writeElement = writeGroupJSON;
+            break;
+        default:
+            return NULL;
+    }
+    if (image == NULL) return NULL;
+    if (offset < 0) offset = 0;
+    if (limit < 0) limit = 0;
+    bool filtered = (filter != NULL && (filter->attributeName != NULL || filter->hasArea));
+
+    //The shapes in the area come from the spatial index, sorted so each component is checked against them by binary
+    //search instead of by its own box. Groups are not in the index, and are checked with their own boxes.
+    void** inArea = NULL;
+    int numInArea = 0;
+    if (filtered && filter->hasArea && type != GROUP) {
+        Vector* results = getComponentsInArea(image, filter->area);
+        if (results == NULL || (inArea = malloc((getVectorLength(results) + 1) * sizeof(void*))) == NULL) {
+            if (results != NULL) freeVector(results);
+            return NULL;
+        }
+        VectorIterator iterator = createVectorIterator(results);
+        RTreeEntry* entry = NULL;
+        while ((entry = nextVectorElement(&iterator)) != NULL) {
+            if (entry->type == type) inArea[numInArea++] = entry->data;
+        }
+        freeVector(results);
+        qsort(inArea, numInArea, sizeof(void*), comparePointers);
+    }
+
+    StringBuffer* out = createStringBuffer(0);
+    StringBuffer* indices = createStringBuffer(0);
+    bufferAppend(out, "{\"title\":");
+    writeJSONString(out, image->title);
+    bufferAppend(out, ",\"description\":");
+    writeJSONString(out, image->description);
+    bufferPrintf(out, ",\"%s\":[", name);
+
+    const ComponentViews* views = getComponentViews(image);
+    Vector* view = (views == NULL ? NULL : getComponentsOfType(views, type));
+    int length = (view == NULL ? 0 : view->length);
+    //Every group's box is worked out in one walk, in the same order as the view
+    BoundingBox* groupBounds = NULL;
+    if (filtered && filter->hasArea && type == GROUP) {
+        groupBounds = malloc((length + 1) * sizeof(BoundingBox));
+        int next = 0;
+        for (Node* node = image->groups->head; groupBounds != NULL && node != NULL; node = node->next) {
+            collectGroupBounds(image, node->data, groupBounds, &next);
+        }
+    }
+    int total = 0;
+    if (!filtered) {
+        //Only the page's own components are written
+        total = length;
+        for (int i = offset; i < length && i - offset < limit; i++) {
+            if (i > offset) {
+                bufferAppendChar(out, ',');
+                bufferAppendChar(indices, ',');
+            }
+            writeElement(out, view->data[i]);
+            bufferPrintf(indices, "%d", i);
+        }
+    } else if (!filter->hasArea || type == GROUP || numInArea > 0) {
+        for (int i = 0; i < length; i++) {
+            void* component = view->data[i];
+            BoundingBox* box = (groupBounds != NULL ? &groupBounds[i] : NULL);
+            if (!componentMatches(image, type, component, box, filter, inArea, numInArea)) continue;
+            if (total >= offset && total - offset < limit) {
+                if (total > offset) {
+                    bufferAppendChar(out, ',');
+                    bufferAppendChar(indices, ',');
+                }
+                writeElement(out, component);
+                bufferPrintf(indices, "%d", i);
+            }
+            total++;
+        }
+    }
+    free(inArea);
+    free(groupBounds);
+
+    char* indexList = bufferRelease(indices);
+    bufferPrintf(out, "],\"total\":%d,\"offset\":%d,\"indices\":[", total, offset);
+    bufferAppend(out, indexList);
+    bufferAppend(out, "]}");
+    free(indexList);
+    return bufferRelease(out);
+}
+
+/**
+ * Checks a component against the conditions of a ComponentFilter.
+ * @param image The image the component belongs to.
+ * @param type The component's type, RECT, CIRC, PATH or GROUP.
+ * @param component The component.
+ * @param groupBounds For groups, the group's box, or NULL to work it out. Unused for shapes.
+ * @param filter The conditions.
+ * @param inArea For shapes, the components in the filter's area, sorted with comparePointers. Unused for groups.
+ * @param numInArea Number of components in inArea.
+ * @return True if the component meets every condition that is set.
+ */
+bool componentMatches(SVGimage* image, elementType type, void* component, const BoundingBox* groupBounds,
+                      const ComponentFilter* filter, void** inArea, int numInArea) {
+    if (filter->hasArea) {
+        if (type == GROUP) {
+            BoundingBox box = (groupBounds != NULL ? *groupBounds : getGroupBounds(component));
+            if (!boundsIntersect(box, filter->area)) return false;
+        } else if (bsearch(&component, inArea, numInArea, sizeof(void*), comparePointers) == NULL) {
+            return false;
+        }
+    }
+    if (filter->attributeName != NULL) {
+        Attribute* attribute = existsInList(getComponentAttributes(type, component), image->strings, filter->attributeName);
+        if (attribute == NULL) return false;
+        if (filter->attributeValue != NULL && strcmp(attribute->value, filter->attributeValue) != 0) return false;
+    }
+    return true;
+}
+
+/**
+ * Gets a component's list of other attributes.
+ * @param type RECT, CIRC, PATH or GROUP.
+ * @param component The component.
+ * @return The list, or NULL for other types.
+ */
+List* getComponentAttributes(elementType type, void* component) {
+    switch (type) {
+        case RECT:
+            return ((Rectangle*)component)->otherAttributes;
+        case CIRC:
+            return ((Circle*)component)->otherAttributes;
+        case PATH:
+            return ((Path*)component)->otherAttributes;
+        case GROUP:
+            return ((Group*)component)->otherAttributes;
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * Appends the JSON for an Attribute to a buffer.
+ * @param out The buffer to append to.
+ * @param data The Attribute. NULL gives an empty object.
+ */
+void writeAttrJSON(StringBuffer* out, const void* data) {
+    const Attribute* a = data;
+    if (a == NULL) {
+        bufferAppend(out, "{}");
+        return;
+    }
+    bufferAppend(out, "{\"name\":");
+    writeJSONString(out, a->name);
+    bufferAppend(out, ",\"value\":");
+    writeJSONString(out, a->value);
+    bufferAppendChar(out, '}');
+}
+
+/**
+ * Appends the JSON for a Circle to a buffer.
+ * @param out The buffer to append to.
+ * @param data The Circle. NULL gives an empty object.
+ */
+void writeCircleJSON(StringBuffer* out, const void* data) {
+    const Circle* c = data;
+    if (c == NULL) {
+        bufferAppend(out, "{}");
+        return;
+    }
+    char cx[NUMBER_FORMAT_SIZE], cy[NUMBER_FORMAT_SIZE], r[NUMBER_FORMAT_SIZE];
+    formatNumber(cx, c->cx, NUMBER_SHORTEST);
+    formatNumber(cy, c->cy, NUMBER_SHORTEST);
+    formatNumber(r, c->r, NUMBER_SHORTEST);
+    bufferPrintf(out, "{\"cx\":%s,\"cy\":%s,\"r\":%s,\"numAttr\":%d,\"units\":", cx, cy, r, c->otherAttributes->length);
+    writeJSONString(out, c->units);
+    bufferAppend(out, ",\"otherAttrs\":");
+    writeListJSON(out, c->otherAttributes, writeAttrJSON);
+    bufferAppendChar(out, '}');
+}
+
+/**
+ * Appends the JSON for a Rectangle to a buffer.
+ * @param out The buffer to append to.
+ * @param data The Rectangle. NULL gives an empty object.
+ */
+void writeRectJSON(StringBuffer* out, const void* data) {
+    const Rectangle* r = data;
+    if (r == NULL) {
+        bufferAppend(out, "{}");
+        return;
+    }
+    char x[NUMBER_FORMAT_SIZE], y[NUMBER_FORMAT_SIZE], w[NUMBER_FORMAT_SIZE], h[NUMBER_FORMAT_SIZE];
+    formatNumber(x, r->x, NUMBER_SHORTEST);
+    formatNumber(y, r->y, NUMBER_SHORTEST);
+    formatNumber(w, r->width, NUMBER_SHORTEST);
+    formatNumber(h, r->height, NUMBER_SHORTEST);
+    bufferPrintf(out, "{\"x\":%s,\"y\":%s,\"w\":%s,\"h\":%s,\"numAttr\":%d,\"units\":", x, y, w, h,
+                 r->otherAttributes->length);
+    writeJSONString(out, r->units);
+    bufferAppend(out, ",\"otherAttrs\":");
+    writeListJSON(out, r->otherAttributes, writeAttrJSON);
+    bufferAppendChar(out, '}');
+}
+
+/**
+ * Appends the JSON for a Path to a buffer. Only the first 64 characters of the path data are written.
+ * @param out The buffer to append to.
+ * @param data The Path. NULL gives an empty object.
+ */
+void writePathJSON(StringBuffer* out, const void* data) {
+    const Path* p = data;
+    if (p == NULL) {
+        bufferAppend(out, "{}");
+        return;
+    }
+    bufferAppend(out, "{\"d\":");
+    writeJSONStringN(out, p->data, strnlen(p->data, 64));
+    bufferPrintf(out, ",\"numAttr\":%d,\"otherAttrs\":", p->otherAttributes->length);
+    writeListJSON(out, p->otherAttributes, writeAttrJSON);
+    bufferAppendChar(out, '}');
+}
+
+/**
+ * Appends the JSON for a Group to a buffer.
+ * @param out The buffer to append to.
+ * @param data The Group. NULL gives an empty object.
+ */
+void writeGroupJSON(StringBuffer* out, const void* data) {
+    const Group* g = data;
+    if (g == NULL) {
+        bufferAppend(out, "{}");
+        return;
+    }
+    bufferPrintf(out, "{\"children\":%d,\"numAttr\":%d,\"otherAttrs\":",
+                 g->rectangles->length + g->circles->length + g->paths->length + g->groups->length, g->otherAttributes->length);
+    writeListJSON(out, g->otherAttributes, writeAttrJSON);
+    bufferAppendChar(out, '}');
 }
 
 /**
@@ -1611,7 +3515,7 @@ SVGimage* JSONtoSVG(const char* svgString) {
     image->circles = initializeList(circleToString, deleteCircle, compareCircles);
     image->paths = initializeList(pathToString, deletePath, comparePaths);
     image->groups = initializeList(groupToString, deleteGroup, compareGroups);
-    image->otherAttributes = initializeList(attributeToString, deleteAttribute, compareAttributes);
+    image->otherAttributes = initializeAttributeList(NULL, image->strings);
 
     char* start = strstr(svgString, "title") + 8;
     char* end = strstr(start, "\",\"");
@@ -1638,15 +3542,15 @@ Rectangle* JSONtoRect(const char* svgString) {
 
     //Finds the required fields and populates the rectangle
     char* start = strstr(svgString, "x") + 3;
-    rectangle->x = strtof(start, NULL);
+    rectangle->x = parseSVGNumber(start, NULL);
     start = strstr(svgString, "y") + 3;
-    rectangle->y = strtof(start, NULL);
+    rectangle->y = parseSVGNumber(start, NULL);
     start = strstr(svgString, "w") + 3;
-    rectangle->width = strtof(start, NULL);
+    rectangle->width = parseSVGNumber(start, NULL);
     start = strstr(svgString, "h") + 3;
-    rectangle->height = strtof(start, NULL);
+    rectangle->height = parseSVGNumber(start, NULL);
     start = strstr(svgString, "h") + 3;
-    rectangle->height = strtof(start, NULL);
+    rectangle->height = parseSVGNumber(start, NULL);
     start = strstr(svgString, "units") + 8;
     char* end = strstr(start, "\"}");
     int length = ((end - start) / sizeof(char));
@@ -1668,11 +3572,11 @@ Circle* JSONtoCircle(const char* svgString) {
 
     //Finds the required fields and populates the rectangle
     char* start = strstr(svgString, "cx") + 4;
-    circle->cx = strtof(start, NULL);
+    circle->cx = parseSVGNumber(start, NULL);
     start = strstr(svgString, "cy") + 4;
-    circle->cy = strtof(start, NULL);
+    circle->cy = parseSVGNumber(start, NULL);
     start = strstr(svgString, "r") + 3;
-    circle->r = strtof(start, NULL);
+    circle->r = parseSVGNumber(start, NULL);
     start = strstr(svgString, "units") + 8;
     char* end = strstr(start, "\"}");
     int length = ((end - start) / sizeof(char));
@@ -1696,17 +3600,13 @@ bool createEmptySVG(char* filename) {
 
 char* fileToJSON(char* filename, char* schema) {
     if (filename == NULL || schema == NULL) return NULL;
-
-    SVGimage* image = createValidSVGimage(filename, schema);
-    char* imageJSON = SVGtoJSON(image);
-    deleteSVGimage(image);
-    return imageJSON;
+    return cachedImageJSON(filename, schema, NULL, false);
 }
 
 bool validateFile (char* filename, char* schema) {
     if (filename == NULL || schema == NULL) return false;
 
-    SVGimage* image = createValidSVGimage(filename, schema);
+    SVGimage* image = createValidSVGimageInArena(filename, schema);
 
     if (image == NULL) {
         return false;
@@ -1718,62 +3618,459 @@ bool validateFile (char* filename, char* schema) {
 
 char* fullImageToJSON(char* filename, char* schema) {
     if (filename == NULL || schema == NULL) return NULL;
-    SVGimage* image = createValidSVGimage(filename, schema);
-    if (image == NULL) return NULL;
+    return cachedImageJSON(filename, schema, NULL, true);
+}
+
+/**
+ * Exports one page of a valid SVG file's components, as componentPageToJSON. The file is loaded from its snapshot when
+ * it has one, so a page costs far less than fullImageToJSON for a large file.
+ * @param fileName File name for the XML document.
+ * @param schemaFile Schema file to validate the xml file against.
+ * @param type The components' element name: "rect", "circle", "path" or "g".
+ * @param offset How many matching components to skip.
+ * @param limit The most components to export.
+ * @param attributeName Attribute the components must have, or NULL or "" for any component.
+ * @param attributeValue Value that attribute must have, or NULL or "" for any value.
+ * @param area Area written like a viewBox, "x y width height", that the components must intersect. NULL or "" for
+ *             anywhere.
+ * @return Newly allocated JSON. NULL if the file is not valid SVG, or the type or area could not be read.
+ */
+char* componentQueryJSON(char* fileName, char* schemaFile, char* type, int offset, int limit, char* attributeName,
+                         char* attributeValue, char* area) {
+    if (fileName == NULL || schemaFile == NULL || type == NULL) return NULL;
+
+    elementType elemType;
+    switch (lookupKeyword(type)) {
+        case KEYWORD_RECT:
+            elemType = RECT;
+            break;
+        case KEYWORD_CIRCLE:
+            elemType = CIRC;
+            break;
+        case KEYWORD_PATH:
+            elemType = PATH;
+            break;
+        case KEYWORD_G:
+            elemType = GROUP;
+            break;
+        default:
+            return NULL;
+    }
 
-    List* rects = getRects(image);
-    char* rectsJSON = rectListToJSON(rects);
-    List* circles = getCircles(image);
-    char* circlesJSON = circListToJSON(circles);
-    List* paths = getPaths(image);
-    char* pathsJSON = pathListToJSON(paths);
-    List* groups = getGroups(image);
-    char* groupsJSON = groupListToJSON(groups);
+    ComponentFilter filter;
+    if (!makeComponentFilter(attributeName, attributeValue, area, &filter)) return NULL;
 
-    char* out = calloc(strlen(image->title) +
-                       strlen(image->description) +
-                       strlen(rectsJSON) +
-                       strlen(circlesJSON) +
-                       strlen(pathsJSON) +
-                       strlen(groupsJSON) + 128, sizeof(char));
+    SVGimage* image = createValidSVGimageInArena(fileName, schemaFile);
+    if (image == NULL) return NULL;
+    char* result = componentPageToJSON(image, elemType, offset, limit, &filter);
+    deleteSVGimage(image);
+    return result;
+}
 
-    sprintf(out, "{\"title\":\"%s\",\"description\":\"%s\",\"rectangles\":%s,\"circles\":%s,\"paths\":%s,\"groups\":%s}", image->title, image->description, rectsJSON, circlesJSON, pathsJSON, groupsJSON);
+/**
+ * Exports the first page of each type of a valid SVG file's components from one load of the file, for a view that
+ * shows them all at once.
+ * @param fileName File name for the XML document.
+ * @param schemaFile Schema file to validate the xml file against.
+ * @param limit The most components of each type to export.
+ * @param attributeName As componentQueryJSON.
+ * @param attributeValue As componentQueryJSON.
+ * @param area As componentQueryJSON.
+ * @return Newly allocated JSON, {"rect":page,"circle":page,"path":page,"g":page} with each page as componentQueryJSON
+ *         gives it. NULL if the file is not valid SVG, or the area could not be read.
+ */
+char* componentPagesJSON(char* fileName, char* schemaFile, int limit, char* attributeName, char* attributeValue,
+                         char* area) {
+    if (fileName == NULL || schemaFile == NULL) return NULL;
+    ComponentFilter filter;
+    if (!makeComponentFilter(attributeName, attributeValue, area, &filter)) return NULL;
 
+    SVGimage* image = createValidSVGimageInArena(fileName, schemaFile);
+    if (image == NULL) return NULL;
+    const char* names[4] = {"rect", "circle", "path", "g"};
+    elementType types[4] = {RECT, CIRC, PATH, GROUP};
+    StringBuffer* out = createStringBuffer(0);
+    for (int i = 0; i < 4; i++) {
+        bufferAppend(out, i == 0 ? "{\"" : ",\"");
+        bufferAppend(out, names[i]);
+        bufferAppend(out, "\":");
+        char* page = componentPageToJSON(image, types[i], 0, limit, &filter);
+        bufferAppend(out, page);
+        free(page);
+    }
+    bufferAppend(out, "}");
     deleteSVGimage(image);
-    freeList(rects);
-    free(rectsJSON);
-    freeList(circles);
-    free(circlesJSON);
-    freeList(paths);
-    free(pathsJSON);
-    freeList(groups);
-    free(groupsJSON);
+    return bufferRelease(out);
+}
 
-    return out;
+/**
+ * Makes the filter for componentQueryJSON and componentPagesJSON from their arguments.
+ * @param attributeName Attribute the components must have, or NULL or "" for any component.
+ * @param attributeValue Value that attribute must have, or NULL or "" for any value.
+ * @param area Area the components must intersect, as parseArea reads it. NULL or "" for anywhere.
+ * @param filter Set to the filter.
+ * @return False if the area could not be read.
+ */
+bool makeComponentFilter(char* attributeName, char* attributeValue, char* area, ComponentFilter* filter) {
+    *filter = (ComponentFilter){0};
+    if (attributeName != NULL && attributeName[0] != '\0') {
+        filter->attributeName = attributeName;
+        if (attributeValue != NULL && attributeValue[0] != '\0') filter->attributeValue = attributeValue;
+    }
+    return area == NULL || area[0] == '\0' || (filter->hasArea = parseArea(area, &filter->area));
 }
 
-bool saveTitle(char* filename, char* schema, char* newTitle) {
-    if (filename == NULL || schema == NULL || newTitle == NULL) return false;
+/**
+ * Reads an area written like a viewBox: x, y, width and height, separated by whitespace and/or commas.
+ * @param text The text to read.
+ * @param area Set to the area's box.
+ * @return True if the text held exactly four numbers and the width and height are not negative.
+ */
+bool parseArea(const char* text, BoundingBox* area) {
+    float values[4];
+    char* end = (char*)text;
+    for (int i = 0; i < 4; i++) {
+        while (isspace((unsigned char)*end) || (i > 0 && *end == ',')) end++;
+        char* start = end;
+        values[i] = parseSVGNumber(start, &end);
+        if (end == start) return false;
+    }
+    while (isspace((unsigned char)*end)) end++;
+    if (*end != '\0' || values[2] < 0 || values[3] < 0) return false;
+
+    *area = (BoundingBox){values[0], values[1], values[0] + values[2], values[1] + values[3]};
+    return true;
+}
 
-    SVGimage* image = createValidSVGimage(filename, schema);
-    if (image == NULL) return false;
+/**
+ * Gets the SVGtoJSON counts or the fullImageToJSON payload for an SVG file. They come from the file's summary cache
+ * record while the file and schema are unchanged, without touching libxml2. Otherwise the file is parsed and validated,
+ * and the record is updated.
+ * @param fileName File name for the XML document.
+ * @param schemaFile Schema file to validate the xml file against.
+ * @param schema The compiled schemaFile if the caller already holds it, or NULL to acquire it only when needed.
+ * @param full True for the fullImageToJSON payload, false for the counts.
+ * @return Newly allocated JSON. For a file that is not valid SVG, "{}" for the counts and NULL for the payload.
+ */
+char* cachedImageJSON(char* fileName, char* schemaFile, SchemaCacheEntry* schema, bool full) {
+    if (!validLoadArguments(fileName, schemaFile)) return (full ? NULL : SVGtoJSON(NULL));
+
+    //The identity is taken from the mapping that is parsed, so a file that changes meanwhile does not get a record for
+    //contents it no longer has
+    MappedFile* input = openMappedFile(fileName);
+    FileIdentity identity;
+    bool cacheable = (input != NULL &&
+                      getContentIdentity(input->data, input->size, input->mtimeSec, input->mtimeNsec, schemaFile, &identity));
+    FileSummary* summary = (cacheable ? loadFileSummary(fileName, &identity) : NULL);
+    if (summary != NULL && (!summary->valid || (full ? summary->full : summary->counts) != NULL)) {
+        char* result = NULL;
+        if (summary->valid) {
+            result = copyStringIn(NULL, full ? summary->full : summary->counts);
+        } else if (!full) {
+            result = SVGtoJSON(NULL);
+        }
+        freeFileSummary(summary);
+        closeMappedFile(input);
+        return result;
+    }
+
+    bool valid = false;
+    char* result = NULL;
+    if (input != NULL && full) {
+        initSVGParser();
+        //The image is only read, so it can come from the file's snapshot
+        SVGimage* image = loadMappedSVGimage(input, fileName, schemaFile, schema, cacheable ? &identity : NULL, true);
+        if ((valid = (image != NULL))) {
+            StringBuffer* buffer = createStringBuffer(0);
+            writeFullImageJSON(buffer, image);
+            result = bufferRelease(buffer);
+        }
+        deleteSVGimage(image);
+    } else if (input != NULL) {
+        //The counts need no image, so the file is only streamed through
+        initSVGParser();
+        ComponentCounts counts;
+        valid = countMappedSVGcomponents(input, fileName, schemaFile, schema, cacheable ? &identity : NULL, &counts);
+        if (valid) result = countsToJSON(&counts);
+    }
+    closeMappedFile(input);
+    if (!full && !valid) result = SVGtoJSON(NULL);
+
+    //Add what was just computed to anything the record already held for this version of the file
+    if (cacheable && (summary != NULL || (summary = createFileSummary(&identity)) != NULL)) {
+        char** slot = (full ? &summary->full : &summary->counts);
+        summary->valid = valid;
+        free(*slot);
+        *slot = (valid ? result : NULL);
+        storeFileSummary(fileName, summary);
+        //The result is the caller's, not the record's
+        *slot = NULL;
+    }
+    freeFileSummary(summary);
+    return result;
+}
 
-    strcpy(image->title, newTitle);
-    bool result = writeSVGimage(image, filename);
-    deleteSVGimage(image);
+/**
+ * Summarizes every file in a directory for the file log, validating the SVG files on a pool of worker threads that
+ * share one compiled schema.
+ * @param directory Path to the directory.
+ * @param schema Schema file to validate the SVG files against.
+ * @return A JSON array with an object per file, sorted by name, each with its name and size in bytes. Valid SVG files
+ *         also have the counts from SVGtoJSON. NULL if the directory could not be read.
+ */
+char* directoryToJSON(char* directory, char* schema) {
+    if (directory == NULL || schema == NULL) return NULL;
+    initSVGParser();
+
+    DirectoryScan scan = {0};
+    scan.names = listDirectoryFiles(directory, &scan.count);
+    if (scan.names == NULL) return NULL;
+    scan.directory = directory;
+    scan.schemaFile = schema;
+    scan.results = calloc(scan.count + 1, sizeof(char*));
+    pthread_mutex_init(&scan.lock, NULL);
+
+    //A schema that fails to compile leaves every file without counts, as fileToJSON would
+    if (strlen(schema) >= 4 && strcmp(".xsd", schema + strlen(schema) - 4) == 0) scan.schema = acquireSchema(schema);
+
+    //One worker per core, the calling thread being one of them
+    long workers = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+    workers = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (workers > scan.count) workers = scan.count;
+    if (workers < 1) workers = 1;
+
+    pthread_t* threads = calloc(workers, sizeof(pthread_t));
+    int started = 0;
+    while (threads != NULL && started < workers - 1 && pthread_create(&threads[started], NULL, summarizeDirectoryFiles, &scan) == 0) {
+        started++;
+    }
+    summarizeDirectoryFiles(&scan);
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    free(threads);
+    releaseSchema(scan.schema);
+    pthread_mutex_destroy(&scan.lock);
+
+    StringBuffer* buffer = createStringBuffer(0);
+    bufferAppendChar(buffer, '[');
+    for (int i = 0; i < scan.count; i++) {
+        if (i > 0) bufferAppendChar(buffer, ',');
+        bufferAppend(buffer, scan.results[i] == NULL ? "{}" : scan.results[i]);
+        free(scan.results[i]);
+        free(scan.names[i]);
+    }
+    bufferAppendChar(buffer, ']');
+    free(scan.results);
+    free(scan.names);
+    return bufferRelease(buffer);
+}
 
-    return result;
+/**
+ * Lists the regular files in a directory, skipping hidden ones.
+ * @param directory Path to the directory.
+ * @param count Set to the number of names returned.
+ * @return Newly allocated array of newly allocated names, sorted with strcmp. NULL if the directory could not be read.
+ */
+char** listDirectoryFiles(char* directory, int* count) {
+    DIR* dir = opendir(directory);
+    if (dir == NULL) return NULL;
+
+    int capacity = 64;
+    char** names = malloc(capacity * sizeof(char*));
+    *count = 0;
+    struct dirent* entry = NULL;
+    while (names != NULL && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        struct stat fileInfo;
+        char* path = malloc(strlen(directory) + strlen(entry->d_name) + 2);
+        sprintf(path, "%s/%s", directory, entry->d_name);
+        bool regular = (stat(path, &fileInfo) == 0 && S_ISREG(fileInfo.st_mode));
+        free(path);
+        if (!regular) continue;
+
+        if (*count == capacity) {
+            capacity *= 2;
+            char** grown = realloc(names, capacity * sizeof(char*));
+            if (grown == NULL) break;
+            names = grown;
+        }
+        names[(*count)++] = copyStringIn(NULL, entry->d_name);
+    }
+    closedir(dir);
+
+    if (names != NULL) qsort(names, *count, sizeof(char*), compareFileNames);
+    return names;
+}
+
+/**qsort callback for listDirectoryFiles*/
+int compareFileNames(const void* first, const void* second) {
+    return strcmp(*(char* const*)first, *(char* const*)second);
+}
+
+/**
+ * Worker thread for directoryToJSON. Takes files from the scan one at a time until none are left.
+ * @param data void pointer to the DirectoryScan.
+ * @return NULL.
+ */
+void* summarizeDirectoryFiles(void* data) {
+    DirectoryScan* scan = data;
+    while (true) {
+        pthread_mutex_lock(&scan->lock);
+        int index = scan->next++;
+        pthread_mutex_unlock(&scan->lock);
+        if (index >= scan->count) break;
+
+        //Each worker only writes its own slots, so the results need no lock
+        scan->results[index] = fileSummaryJSON(scan, scan->names[index]);
+    }
+    return NULL;
+}
+
+/**
+ * Creates the JSON summary for one file of a directory scan.
+ * @param scan The scan the file belongs to.
+ * @param name The file's name within the scan's directory.
+ * @return Newly allocated JSON object with the file's name, size and, if it is a valid SVG file, its counts.
+ */
+char* fileSummaryJSON(DirectoryScan* scan, char* name) {
+    char* path = malloc(strlen(scan->directory) + strlen(name) + 2);
+    sprintf(path, "%s/%s", scan->directory, name);
+
+    struct stat fileInfo;
+    long long size = (stat(path, &fileInfo) == 0 ? (long long)fileInfo.st_size : 0);
+    StringBuffer* buffer = createStringBuffer(128);
+    bufferAppend(buffer, "{\"name\":");
+    writeJSONString(buffer, name);
+    bufferPrintf(buffer, ",\"size\":%lld", size);
+
+    //The counts object's members are copied in after the name and size. Files that are not valid SVG get "{}".
+    if (scan->schema != NULL) {
+        char* counts = cachedImageJSON(path, scan->schemaFile, scan->schema, false);
+        size_t length = (counts == NULL ? 0 : strlen(counts));
+        if (length > 2) {
+            bufferAppendChar(buffer, ',');
+            bufferAppendN(buffer, counts + 1, length - 2);
+        }
+        free(counts);
+    }
+    bufferAppendChar(buffer, '}');
+    free(path);
+    return bufferRelease(buffer);
+}
+
+/**
+ * Appends a string to a buffer as a quoted JSON string, escaping quotes, backslashes and control characters.
+ * @param out The buffer to append to.
+ * @param string The string to write.
+ */
+void writeJSONString(StringBuffer* out, const char* string) {
+    writeJSONStringN(out, string, strlen(string));
+}
+
+/**
+ * Appends the first length bytes of a string to a buffer as a quoted JSON string, escaped as writeJSONString does.
+ * @param out The buffer to append to.
+ * @param string The string to write.
+ * @param length Number of bytes of string to write.
+ */
+void writeJSONStringN(StringBuffer* out, const char* string, size_t length) {
+    bufferAppendChar(out, '"');
+    const unsigned char* end = (const unsigned char*)string + length;
+    for (const unsigned char* c = (const unsigned char*)string; c < end; c++) {
+        if (*c == '"' || *c == '\\') {
+            bufferAppendChar(out, '\\');
+            bufferAppendChar(out, *c);
+        } else if (*c < 0x20) {
+            bufferPrintf(out, "\\u%04x", *c);
+        } else {
+            bufferAppendChar(out, *c);
+        }
+    }
+    bufferAppendChar(out, '"');
+}
+
+/**
+ * Appends the JSON for an image's title, description and every component, nested ones included, to a buffer.
+ * Pass a buffer from createFileBuffer to stream large images to a file.
+ * @param out The buffer to append to.
+ * @param image The image.
+ */
+void writeFullImageJSON(StringBuffer* out, SVGimage* image) {
+    bufferAppend(out, "{\"title\":");
+    writeJSONString(out, image->title);
+    bufferAppend(out, ",\"description\":");
+    writeJSONString(out, image->description);
+    bufferAppend(out, ",\"rectangles\":");
+    writeComponentsJSON(out, image, RECT, writeRectJSON);
+    bufferAppend(out, ",\"circles\":");
+    writeComponentsJSON(out, image, CIRC, writeCircleJSON);
+    bufferAppend(out, ",\"paths\":");
+    writeComponentsJSON(out, image, PATH, writePathJSON);
+    bufferAppend(out, ",\"groups\":");
+    writeComponentsJSON(out, image, GROUP, writeGroupJSON);
+    bufferAppendChar(out, '}');
+}
+
+bool saveTitle(char* filename, char* schema, char* newTitle) {
+    if (filename == NULL || schema == NULL || newTitle == NULL) return false;
+    return saveMetadata(filename, schema, newTitle, NULL);
 }
 
 bool saveDesc(char* filename, char* schema, char* newDesc) {
     if (filename == NULL || schema == NULL || newDesc == NULL) return false;
+    return saveMetadata(filename, schema, NULL, newDesc);
+}
 
-    SVGimage* image = createValidSVGimage(filename, schema);
-    if (image == NULL) return false;
+/**
+ * Sets an image's title or description, truncated as writePatchedSVG truncates it so both ways of saving agree.
+ * @param field The image's title or description field.
+ * @param text The new text.
+ */
+void copyMetadataText(char* field, const char* text) {
+    size_t length = metadataTextLength(text);
+    memcpy(field, text, length);
+    field[length] = '\0';
+}
 
-    strcpy(image->description, newDesc);
-    bool result = writeSVGimage(image, filename);
-    deleteSVGimage(image);
+/**
+ * Changes the title and description of a valid SVG file. Only the <title> and <desc> elements are replaced, the rest
+ * of the file is copied across as it is and the new file is renamed over the old one. Files that cannot be patched
+ * that way, e.g. ones not in UTF-8, are loaded and written back out in full instead. Either way, text longer than
+ * the image's 255 byte fields is truncated to fit, as the parser truncates it.
+ * @param fileName File name for the XML document.
+ * @param schemaFile Schema file the document must be valid against.
+ * @param title The new title, or NULL to leave it as it is.
+ * @param description The new description, or NULL to leave it as it is.
+ * @return True if the file was changed, false if it was not valid or could not be written.
+ */
+bool saveMetadata(char* fileName, char* schemaFile, char* title, char* description) {
+    if (!validLoadArguments(fileName, schemaFile)) return false;
+    initSVGParser();
+    MappedFile* input = openMappedFile(fileName);
+    if (input == NULL) return false;
+
+    //A file with a snapshot for its current contents and schema has already passed validation
+    FileIdentity identity;
+    bool valid = (getContentIdentity(input->data, input->size, input->mtimeSec, input->mtimeNsec, schemaFile, &identity) &&
+                  matchesSVGsnapshot(fileName, &identity)) || validateMappedSVG(input, fileName, schemaFile);
+    bool saved = (valid && patchSVGfile(fileName, input->data, input->size, title, description));
+    closeMappedFile(input);
+
+    if (valid && !saved) {
+        SVGimage* image = createValidSVGimageInArena(fileName, schemaFile);
+        if (image == NULL) return false;
+        if (title != NULL) copyMetadataText(image->title, title);
+        if (description != NULL) copyMetadataText(image->description, description);
+        saved = writeSVGimage(image, fileName);
+        deleteSVGimage(image);
+        return saved;
+    }
 
-    return result;
+    if (saved) {
+        //The file's cached summaries and snapshot describe what it held before
+        invalidateFileSummary(fileName);
+        invalidateSVGsnapshot(fileName);
+    }
+    return saved;
 }
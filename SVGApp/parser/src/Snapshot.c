@@ -0,0 +1,523 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "Helper.h"
+#include "Snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SNAPSHOT_MAGIC "SVGSNAP"
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+#define SNAPSHOT_EXTENSION ".snap"
+//Every struct starts on a multiple of this, which is the alignment of the widest field in them
+#define SNAPSHOT_ALIGNMENT 8
+//Slab size for the arena of a loaded image. It only holds edits made after loading.
+#define SNAPSHOT_ARENA_SLAB_SIZE 4096
+//Slots in a new string index. Must be a power of two.
+#define STRING_INDEX_INITIAL_CAPACITY 1024
+#define FNV_OFFSET 0x811c9dc5u
+#define FNV_PRIME 0x01000193u
+
+/**
+ * A growable array of file offsets.
+ **/
+typedef struct {
+    uint64_t* items;
+    size_t count;
+    size_t capacity;
+} OffsetArray;
+
+/**
+ * State while a snapshot is written. Pointer fields in data hold offsets into the file until it is loaded again.
+ **/
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    //The string region, written after the structs, and an index of it so each distinct string is stored once.
+    //The index holds 1 + the offset of a string in the region, or 0 for an empty slot.
+    char* strings;
+    size_t stringsLength;
+    size_t stringsCapacity;
+    uint64_t* stringIndex;
+    uint32_t* stringHashes;
+    size_t stringIndexCapacity;
+    size_t stringCount;
+    OffsetArray pointers;
+    OffsetArray stringFields;
+    OffsetArray keywordFields;
+    OffsetArray lists;
+    bool failed;
+} SnapshotWriter;
+
+/**
+ * A mapped snapshot, unmapped when the arena of the image in it is freed.
+ **/
+typedef struct {
+    void* base;
+    size_t size;
+} SnapshotMapping;
+
+static uint64_t writeSnapshotList(SnapshotWriter* writer, const List* list, SnapshotListKind kind);
+
+/** Makes room for needed bytes in a buffer, doubling it so growth is amortized **/
+static bool reserveBytes(char** data, size_t* capacity, size_t needed) {
+    if (needed <= *capacity) return true;
+    size_t newCapacity = (*capacity == 0 ? 4096 : *capacity);
+    while (newCapacity < needed) newCapacity *= 2;
+    char* newData = realloc(*data, newCapacity);
+    if (newData == NULL) return false;
+    *data = newData;
+    *capacity = newCapacity;
+    return true;
+}
+
+static void appendOffset(SnapshotWriter* writer, OffsetArray* array, uint64_t offset) {
+    if (array->count == array->capacity) {
+        size_t capacity = (array->capacity == 0 ? 256 : array->capacity * 2);
+        uint64_t* items = realloc(array->items, capacity * sizeof(uint64_t));
+        if (items == NULL) {
+            writer->failed = true;
+            return;
+        }
+        array->items = items;
+        array->capacity = capacity;
+    }
+    array->items[array->count++] = offset;
+}
+
+/** Adds size zeroed bytes to the struct region. Returns their offset, or 0 on failure since 0 is the header **/
+static uint64_t reserveBlock(SnapshotWriter* writer, size_t size) {
+    size_t offset = (writer->length + SNAPSHOT_ALIGNMENT - 1) & ~(size_t)(SNAPSHOT_ALIGNMENT - 1);
+    if (writer->failed || !reserveBytes(&writer->data, &writer->capacity, offset + size)) {
+        writer->failed = true;
+        return 0;
+    }
+    memset(writer->data + writer->length, 0, offset + size - writer->length);
+    writer->length = offset + size;
+    return offset;
+}
+
+/** Points the pointer field at field to the struct at target, or sets it to NULL if target is 0 **/
+static void setPointer(SnapshotWriter* writer, uint64_t field, uint64_t target) {
+    if (writer->failed) return;
+    memcpy(writer->data + field, &target, sizeof(uint64_t));
+    if (target != 0) appendOffset(writer, &writer->pointers, field);
+}
+
+static uint32_t hashString(const char* string) {
+    uint32_t hash = FNV_OFFSET;
+    for (const unsigned char* p = (const unsigned char*)string; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/** Doubles the string index. False if malloc fails **/
+static bool growStringIndex(SnapshotWriter* writer) {
+    size_t capacity = (writer->stringIndexCapacity == 0 ? STRING_INDEX_INITIAL_CAPACITY : writer->stringIndexCapacity * 2);
+    uint64_t* index = calloc(capacity, sizeof(uint64_t));
+    uint32_t* hashes = calloc(capacity, sizeof(uint32_t));
+    if (index == NULL || hashes == NULL) {
+        free(index);
+        free(hashes);
+        return false;
+    }
+
+    for (size_t i = 0; i < writer->stringIndexCapacity; i++) {
+        if (writer->stringIndex[i] == 0) continue;
+        size_t slot = writer->stringHashes[i] & (capacity - 1);
+        while (index[slot] != 0) slot = (slot + 1) & (capacity - 1);
+        index[slot] = writer->stringIndex[i];
+        hashes[slot] = writer->stringHashes[i];
+    }
+    free(writer->stringIndex);
+    free(writer->stringHashes);
+    writer->stringIndex = index;
+    writer->stringHashes = hashes;
+    writer->stringIndexCapacity = capacity;
+    return true;
+}
+
+/** Offset of a string in the string region, adding it the first time it is seen **/
+static uint64_t addSnapshotString(SnapshotWriter* writer, const char* string) {
+    if ((writer->stringCount + 1) * 2 > writer->stringIndexCapacity && !growStringIndex(writer)) {
+        writer->failed = true;
+        return 0;
+    }
+
+    uint32_t hash = hashString(string);
+    size_t mask = writer->stringIndexCapacity - 1;
+    size_t slot = hash & mask;
+    for (; writer->stringIndex[slot] != 0; slot = (slot + 1) & mask) {
+        uint64_t offset = writer->stringIndex[slot] - 1;
+        if (writer->stringHashes[slot] == hash && strcmp(writer->strings + offset, string) == 0) return offset;
+    }
+
+    size_t length = strlen(string) + 1;
+    if (!reserveBytes(&writer->strings, &writer->stringsCapacity, writer->stringsLength + length)) {
+        writer->failed = true;
+        return 0;
+    }
+    uint64_t offset = writer->stringsLength;
+    memcpy(writer->strings + offset, string, length);
+    writer->stringsLength += length;
+    writer->stringIndex[slot] = offset + 1;
+    writer->stringHashes[slot] = hash;
+    writer->stringCount++;
+    return offset;
+}
+
+/** Writes an attribute string field. Names in the keyword table are stored as their keyword **/
+static void setString(SnapshotWriter* writer, uint64_t field, const char* string, bool isName) {
+    SVGKeyword keyword = (isName ? lookupKeyword(string) : KEYWORD_UNKNOWN);
+    uint64_t value = (keyword != KEYWORD_UNKNOWN ? (uint64_t)keyword : addSnapshotString(writer, string));
+    if (writer->failed) return;
+    memcpy(writer->data + field, &value, sizeof(uint64_t));
+    appendOffset(writer, keyword != KEYWORD_UNKNOWN ? &writer->keywordFields : &writer->stringFields, field);
+}
+
+/** Writes one item of a list, returning its offset **/
+static uint64_t writeSnapshotItem(SnapshotWriter* writer, const void* item, SnapshotListKind kind) {
+    uint64_t offset = 0;
+    switch (kind) {
+        case SNAPSHOT_RECTANGLES:
+            if ((offset = reserveBlock(writer, sizeof(Rectangle))) == 0) return 0;
+            memcpy(writer->data + offset, item, sizeof(Rectangle));
+            setPointer(writer, offset + offsetof(Rectangle, otherAttributes),
+                       writeSnapshotList(writer, ((const Rectangle*)item)->otherAttributes, SNAPSHOT_ATTRIBUTES));
+            break;
+        case SNAPSHOT_CIRCLES:
+            if ((offset = reserveBlock(writer, sizeof(Circle))) == 0) return 0;
+            memcpy(writer->data + offset, item, sizeof(Circle));
+            setPointer(writer, offset + offsetof(Circle, otherAttributes),
+                       writeSnapshotList(writer, ((const Circle*)item)->otherAttributes, SNAPSHOT_ATTRIBUTES));
+            break;
+        case SNAPSHOT_PATHS: {
+            const Path* path = item;
+            if ((offset = reserveBlock(writer, sizeof(Path))) == 0) return 0;
+            //Path data is unique to each path, so it is kept with the structs rather than in the string region
+            size_t length = strlen(path->data) + 1;
+            uint64_t data = reserveBlock(writer, length);
+            if (data == 0) return 0;
+            memcpy(writer->data + data, path->data, length);
+            setPointer(writer, offset + offsetof(Path, data), data);
+            setPointer(writer, offset + offsetof(Path, otherAttributes),
+                       writeSnapshotList(writer, path->otherAttributes, SNAPSHOT_ATTRIBUTES));
+            break;
+        }
+        case SNAPSHOT_GROUPS: {
+            const Group* group = item;
+            if ((offset = reserveBlock(writer, sizeof(Group))) == 0) return 0;
+            memcpy(writer->data + offset, item, sizeof(Group));
+            setPointer(writer, offset + offsetof(Group, rectangles), writeSnapshotList(writer, group->rectangles, SNAPSHOT_RECTANGLES));
+            setPointer(writer, offset + offsetof(Group, circles), writeSnapshotList(writer, group->circles, SNAPSHOT_CIRCLES));
+            setPointer(writer, offset + offsetof(Group, paths), writeSnapshotList(writer, group->paths, SNAPSHOT_PATHS));
+            setPointer(writer, offset + offsetof(Group, groups), writeSnapshotList(writer, group->groups, SNAPSHOT_GROUPS));
+            setPointer(writer, offset + offsetof(Group, otherAttributes),
+                       writeSnapshotList(writer, group->otherAttributes, SNAPSHOT_ATTRIBUTES));
+            break;
+        }
+        case SNAPSHOT_ATTRIBUTES:
+            if ((offset = reserveBlock(writer, sizeof(Attribute))) == 0) return 0;
+            setString(writer, offset + offsetof(Attribute, name), ((const Attribute*)item)->name, true);
+            setString(writer, offset + offsetof(Attribute, value), ((const Attribute*)item)->value, false);
+            break;
+        default:
+            break;
+    }
+    return (writer->failed ? 0 : offset);
+}
+
+/** Writes a list, its nodes and everything in it. Returns the list's offset, or 0 on failure **/
+static uint64_t writeSnapshotList(SnapshotWriter* writer, const List* list, SnapshotListKind kind) {
+    uint64_t offset = reserveBlock(writer, sizeof(List));
+    if (offset == 0) return 0;
+    appendOffset(writer, &writer->lists, offset);
+    appendOffset(writer, &writer->lists, kind);
+
+    int count = 0;
+    for (Node* node = list->head; node != NULL; node = node->next) count++;
+    ((List*)(writer->data + offset))->length = count;
+    if (count == 0) return offset;
+
+    //The nodes go in one block, each linked to its neighbours
+    uint64_t nodes = reserveBlock(writer, count * sizeof(Node));
+    if (nodes == 0) return 0;
+    setPointer(writer, offset + offsetof(List, head), nodes);
+    setPointer(writer, offset + offsetof(List, tail), nodes + (count - 1) * sizeof(Node));
+
+    int i = 0;
+    for (Node* node = list->head; node != NULL && !writer->failed; node = node->next, i++) {
+        uint64_t nodeOffset = nodes + i * sizeof(Node);
+        if (i > 0) setPointer(writer, nodeOffset + offsetof(Node, previous), nodeOffset - sizeof(Node));
+        if (i < count - 1) setPointer(writer, nodeOffset + offsetof(Node, next), nodeOffset + sizeof(Node));
+        setPointer(writer, nodeOffset + offsetof(Node, data), writeSnapshotItem(writer, node->data, kind));
+    }
+    return (writer->failed ? 0 : offset);
+}
+
+/** Appends a table to the end of the file and records where it is **/
+static void appendTable(SnapshotWriter* writer, const OffsetArray* array, uint64_t* tableOffset, uint64_t* count) {
+    *tableOffset = reserveBlock(writer, array->count * sizeof(uint64_t) + 1);
+    *count = array->count;
+    if (*tableOffset != 0 && array->count > 0) memcpy(writer->data + *tableOffset, array->items, array->count * sizeof(uint64_t));
+}
+
+static void freeSnapshotWriter(SnapshotWriter* writer) {
+    free(writer->data);
+    free(writer->strings);
+    free(writer->stringIndex);
+    free(writer->stringHashes);
+    free(writer->pointers.items);
+    free(writer->stringFields.items);
+    free(writer->keywordFields.items);
+    free(writer->lists.items);
+}
+
+bool saveSVGsnapshot(const SVGimage* image, const char* fileName, const FileIdentity* identity) {
+    if (image == NULL || fileName == NULL || identity == NULL || sizeof(void*) != sizeof(uint64_t)) return false;
+
+    SnapshotWriter writer = {0};
+    reserveBlock(&writer, sizeof(SnapshotHeader));
+    uint64_t imageOffset = reserveBlock(&writer, sizeof(SVGimage));
+    if (imageOffset != 0) {
+        memcpy(writer.data + imageOffset, image, sizeof(SVGimage));
+        //The arena, string pool and index are made again when the snapshot is loaded
+        setPointer(&writer, imageOffset + offsetof(SVGimage, arena), 0);
+        setPointer(&writer, imageOffset + offsetof(SVGimage, strings), 0);
+        setPointer(&writer, imageOffset + offsetof(SVGimage, index), 0);
+        setPointer(&writer, imageOffset + offsetof(SVGimage, rectangles), writeSnapshotList(&writer, image->rectangles, SNAPSHOT_RECTANGLES));
+        setPointer(&writer, imageOffset + offsetof(SVGimage, circles), writeSnapshotList(&writer, image->circles, SNAPSHOT_CIRCLES));
+        setPointer(&writer, imageOffset + offsetof(SVGimage, paths), writeSnapshotList(&writer, image->paths, SNAPSHOT_PATHS));
+        setPointer(&writer, imageOffset + offsetof(SVGimage, groups), writeSnapshotList(&writer, image->groups, SNAPSHOT_GROUPS));
+        setPointer(&writer, imageOffset + offsetof(SVGimage, otherAttributes),
+                   writeSnapshotList(&writer, image->otherAttributes, SNAPSHOT_ATTRIBUTES));
+    }
+
+    SnapshotHeader header = {0};
+    header.stringsSize = writer.stringsLength;
+    header.strings = reserveBlock(&writer, writer.stringsLength + 1);
+    if (header.strings != 0 && writer.stringsLength > 0) memcpy(writer.data + header.strings, writer.strings, writer.stringsLength);
+    appendTable(&writer, &writer.pointers, &header.pointers, &header.pointerCount);
+    appendTable(&writer, &writer.stringFields, &header.stringFields, &header.stringFieldCount);
+    appendTable(&writer, &writer.keywordFields, &header.keywordFields, &header.keywordFieldCount);
+    appendTable(&writer, &writer.lists, &header.lists, &header.listCount);
+    header.listCount /= 2;
+
+    bool saved = false;
+    if (!writer.failed) {
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.byteOrder = SNAPSHOT_BYTE_ORDER;
+        header.pointerSize = sizeof(void*);
+        header.imageSize = sizeof(SVGimage);
+        header.listSize = sizeof(List);
+        header.nodeSize = sizeof(Node);
+        header.rectangleSize = sizeof(Rectangle);
+        header.circleSize = sizeof(Circle);
+        header.pathSize = sizeof(Path);
+        header.groupSize = sizeof(Group);
+        header.attributeSize = sizeof(Attribute);
+        header.identity = *identity;
+        header.fileSize = writer.length;
+        header.image = imageOffset;
+        memcpy(writer.data, &header, sizeof(SnapshotHeader));
+        saved = storeCacheRecord(fileName, SNAPSHOT_EXTENSION, writer.data, writer.length);
+    }
+    freeSnapshotWriter(&writer);
+    return saved;
+}
+
+/** True if the table of count entries at offset lies within the file **/
+static bool tableFits(const SnapshotHeader* header, uint64_t offset, uint64_t count) {
+    return offset >= sizeof(SnapshotHeader) && offset <= header->fileSize && count <= (header->fileSize - offset) / sizeof(uint64_t);
+}
+
+/** Checks a snapshot was written by this layout for this version of the file **/
+static bool checkSnapshotHeader(const SnapshotHeader* header, size_t size, const FileIdentity* identity) {
+    if (size < sizeof(SnapshotHeader) || memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) return false;
+    if (header->version != SNAPSHOT_VERSION || header->byteOrder != SNAPSHOT_BYTE_ORDER || header->fileSize != size) return false;
+    if (header->pointerSize != sizeof(void*) || header->imageSize != sizeof(SVGimage) || header->listSize != sizeof(List) ||
+        header->nodeSize != sizeof(Node) || header->rectangleSize != sizeof(Rectangle) || header->circleSize != sizeof(Circle) ||
+        header->pathSize != sizeof(Path) || header->groupSize != sizeof(Group) || header->attributeSize != sizeof(Attribute)) {
+        return false;
+    }
+    return sameFileIdentity(&header->identity, identity);
+}
+
+/** Checks that a mapped snapshot belongs to this build and identity, and that its tables stay inside it **/
+static bool checkSnapshot(const char* base, size_t size, const FileIdentity* identity) {
+    const SnapshotHeader* header = (const SnapshotHeader*)base;
+    if (!checkSnapshotHeader(header, size, identity)) return false;
+
+    //Structs all lie before the strings, and the string region ends with a terminator
+    if (header->strings < sizeof(SnapshotHeader) || header->strings > size || header->stringsSize >= size - header->strings) return false;
+    if (base[header->strings + header->stringsSize] != '\0') return false;
+    if (header->image < sizeof(SnapshotHeader) || header->image + sizeof(SVGimage) > header->strings) return false;
+    return tableFits(header, header->pointers, header->pointerCount) &&
+           tableFits(header, header->stringFields, header->stringFieldCount) &&
+           tableFits(header, header->keywordFields, header->keywordFieldCount) &&
+           header->listCount <= UINT64_MAX / 2 && tableFits(header, header->lists, header->listCount * 2);
+}
+
+/** True if a field of fieldSize bytes at offset lies in the struct region and is aligned for a pointer **/
+static bool fieldFits(const SnapshotHeader* header, uint64_t offset, size_t fieldSize) {
+    return offset >= sizeof(SnapshotHeader) && offset % sizeof(void*) == 0 && offset <= header->strings - fieldSize;
+}
+
+/** Turns the offsets in a checked snapshot into pointers. False, possibly part way through, if any are out of range **/
+static bool relocateSnapshot(char* base) {
+    const SnapshotHeader* header = (const SnapshotHeader*)base;
+    const uint64_t* pointers = (const uint64_t*)(base + header->pointers);
+    for (uint64_t i = 0; i < header->pointerCount; i++) {
+        uint64_t target = 0;
+        if (!fieldFits(header, pointers[i], sizeof(uint64_t))) return false;
+        memcpy(&target, base + pointers[i], sizeof(uint64_t));
+        if (target < sizeof(SnapshotHeader) || target >= header->strings) return false;
+        char* pointer = base + target;
+        memcpy(base + pointers[i], &pointer, sizeof(pointer));
+    }
+
+    const uint64_t* stringFields = (const uint64_t*)(base + header->stringFields);
+    for (uint64_t i = 0; i < header->stringFieldCount; i++) {
+        uint64_t target = 0;
+        if (!fieldFits(header, stringFields[i], sizeof(uint64_t))) return false;
+        memcpy(&target, base + stringFields[i], sizeof(uint64_t));
+        if (target >= header->stringsSize) return false;
+        char* pointer = base + header->strings + target;
+        memcpy(base + stringFields[i], &pointer, sizeof(pointer));
+    }
+
+    const uint64_t* keywordFields = (const uint64_t*)(base + header->keywordFields);
+    for (uint64_t i = 0; i < header->keywordFieldCount; i++) {
+        uint64_t keyword = 0;
+        if (!fieldFits(header, keywordFields[i], sizeof(uint64_t))) return false;
+        memcpy(&keyword, base + keywordFields[i], sizeof(uint64_t));
+        const char* name = (keyword < NUM_KEYWORDS ? keywordName((SVGKeyword)keyword) : NULL);
+        if (name == NULL) return false;
+        memcpy(base + keywordFields[i], &name, sizeof(name));
+    }
+    return true;
+}
+
+/** Gives each list in a relocated snapshot the functions for its kind, and the image's arena **/
+static bool restoreSnapshotLists(char* base, Arena* arena) {
+    const SnapshotHeader* header = (const SnapshotHeader*)base;
+    const uint64_t* lists = (const uint64_t*)(base + header->lists);
+    for (uint64_t i = 0; i < header->listCount; i++) {
+        if (!fieldFits(header, lists[2 * i], sizeof(List))) return false;
+        List* list = (List*)(base + lists[2 * i]);
+        switch (lists[2 * i + 1]) {
+            case SNAPSHOT_RECTANGLES:
+                list->printData = rectangleToString;
+                list->deleteData = deleteRectangle;
+                list->compare = compareRectangles;
+                break;
+            case SNAPSHOT_CIRCLES:
+                list->printData = circleToString;
+                list->deleteData = deleteCircle;
+                list->compare = compareCircles;
+                break;
+            case SNAPSHOT_PATHS:
+                list->printData = pathToString;
+                list->deleteData = deletePath;
+                list->compare = comparePaths;
+                break;
+            case SNAPSHOT_GROUPS:
+                list->printData = groupToString;
+                list->deleteData = deleteGroup;
+                list->compare = compareGroups;
+                break;
+            case SNAPSHOT_ATTRIBUTES:
+                //The attributes' strings are in the image's pool once it is seeded
+                list->printData = attributeToString;
+                list->deleteData = deleteInternedAttribute;
+                list->compare = compareAttributes;
+                break;
+            default:
+                return false;
+        }
+        list->arena = arena;
+    }
+    return true;
+}
+
+/** Arena cleanup that unmaps a loaded snapshot **/
+static void unmapSnapshot(void* data) {
+    SnapshotMapping* mapping = data;
+    munmap(mapping->base, mapping->size);
+}
+
+SVGimage* loadSVGsnapshot(const char* fileName, const FileIdentity* identity) {
+    if (fileName == NULL || identity == NULL) return NULL;
+    char* recordPath = cacheRecordPath(fileName, SNAPSHOT_EXTENSION);
+    int descriptor = (recordPath == NULL ? -1 : open(recordPath, O_RDONLY));
+    free(recordPath);
+    if (descriptor < 0) return NULL;
+
+    //A private writable mapping, so relocating copies only the pages it touches and never changes the file
+    struct stat info;
+    char* base = MAP_FAILED;
+    if (fstat(descriptor, &info) == 0 && info.st_size >= (off_t)sizeof(SnapshotHeader)) {
+        base = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+    }
+    close(descriptor);
+    if (base == MAP_FAILED) return NULL;
+
+    size_t size = info.st_size;
+    Arena* arena = NULL;
+    SnapshotMapping* mapping = NULL;
+    if (!checkSnapshot(base, size, identity) || !relocateSnapshot(base) ||
+        (arena = createArena(SNAPSHOT_ARENA_SLAB_SIZE)) == NULL || !restoreSnapshotLists(base, arena) ||
+        (mapping = arenaAlloc(arena, sizeof(SnapshotMapping))) == NULL) {
+        freeArena(arena);
+        munmap(base, size);
+        return NULL;
+    }
+    mapping->base = base;
+    mapping->size = size;
+    arenaAddCleanup(arena, mapping, unmapSnapshot);
+
+    const SnapshotHeader* header = (const SnapshotHeader*)base;
+    SVGimage* image = (SVGimage*)(base + header->image);
+    image->arena = arena;
+    image->index = NULL;
+    //Seed the pool with the mapped strings, so edits compare and share them like those of a parsed image
+    image->strings = createStringPool(arena);
+    if (image->strings == NULL) {
+        deleteSVGimage(image);
+        return NULL;
+    }
+    const char* strings = base + header->strings;
+    for (uint64_t offset = 0; offset < header->stringsSize; offset += strlen(strings + offset) + 1) {
+        adoptString(image->strings, strings + offset);
+    }
+    return image;
+}
+
+bool matchesSVGsnapshot(const char* fileName, const FileIdentity* identity) {
+    if (fileName == NULL || identity == NULL) return false;
+    char* recordPath = cacheRecordPath(fileName, SNAPSHOT_EXTENSION);
+    int descriptor = (recordPath == NULL ? -1 : open(recordPath, O_RDONLY));
+    free(recordPath);
+    if (descriptor < 0) return false;
+
+    struct stat info;
+    SnapshotHeader header;
+    bool matches = (fstat(descriptor, &info) == 0 && pread(descriptor, &header, sizeof(header), 0) == sizeof(header) &&
+                    checkSnapshotHeader(&header, info.st_size, identity));
+    close(descriptor);
+    return matches;
+}
+
+void invalidateSVGsnapshot(const char* fileName) {
+    char* recordPath = cacheRecordPath(fileName, SNAPSHOT_EXTENSION);
+    if (recordPath != NULL) unlink(recordPath);
+    free(recordPath);
+}
@@ -0,0 +1,122 @@
+#include "StringBuffer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#define STRING_BUFFER_DEFAULT_CAPACITY 256
+//File buffers write out once they hold this much
+#define STRING_BUFFER_FLUSH_SIZE 65536
+
+StringBuffer* createStringBuffer(size_t capacity) {
+    StringBuffer* buffer = calloc(1, sizeof(StringBuffer));
+    if (buffer == NULL) return NULL;
+
+    buffer->capacity = (capacity == 0 ? STRING_BUFFER_DEFAULT_CAPACITY : capacity);
+    buffer->data = malloc(buffer->capacity);
+    if (buffer->data == NULL) {
+        free(buffer);
+        return NULL;
+    }
+    buffer->data[0] = '\0';
+    return buffer;
+}
+
+StringBuffer* createFileBuffer(FILE* file) {
+    StringBuffer* buffer = createStringBuffer(STRING_BUFFER_FLUSH_SIZE + STRING_BUFFER_DEFAULT_CAPACITY);
+    if (buffer != NULL) buffer->sink = file;
+    return buffer;
+}
+
+/** Makes room for extra more bytes plus the terminator, doubling the capacity so growth is amortized **/
+static bool reserveBuffer(StringBuffer* buffer, size_t extra) {
+    if (buffer->failed) return false;
+    if (buffer->length + extra + 1 <= buffer->capacity) return true;
+
+    size_t capacity = buffer->capacity;
+    while (buffer->length + extra + 1 > capacity) capacity *= 2;
+    char* data = realloc(buffer->data, capacity);
+    if (data == NULL) {
+        buffer->failed = true;
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+/** Writes the buffer out once it has grown past the flush size, if it has a file **/
+static void flushIfFull(StringBuffer* buffer) {
+    if (buffer->sink != NULL && buffer->length >= STRING_BUFFER_FLUSH_SIZE) bufferFlush(buffer);
+}
+
+void bufferAppend(StringBuffer* buffer, const char* string) {
+    bufferAppendN(buffer, string, strlen(string));
+}
+
+void bufferAppendN(StringBuffer* buffer, const char* string, size_t length) {
+    if (!reserveBuffer(buffer, length)) return;
+
+    memcpy(buffer->data + buffer->length, string, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+    flushIfFull(buffer);
+}
+
+void bufferAppendChar(StringBuffer* buffer, char c) {
+    bufferAppendN(buffer, &c, 1);
+}
+
+void bufferPrintf(StringBuffer* buffer, const char* format, ...) {
+    if (buffer->failed) return;
+
+    //Try to format straight into the free space, and only grow and retry if it did not fit
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, args);
+    va_end(args);
+    if (length < 0) {
+        buffer->failed = true;
+        return;
+    }
+
+    if (buffer->length + length + 1 > buffer->capacity) {
+        if (!reserveBuffer(buffer, length)) return;
+        va_start(args, format);
+        vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, args);
+        va_end(args);
+    }
+    buffer->length += length;
+    flushIfFull(buffer);
+}
+
+bool bufferFlush(StringBuffer* buffer) {
+    if (buffer->failed) return false;
+    if (buffer->sink == NULL || buffer->length == 0) return true;
+
+    if (fwrite(buffer->data, 1, buffer->length, buffer->sink) != buffer->length) {
+        buffer->failed = true;
+        return false;
+    }
+    buffer->length = 0;
+    buffer->data[0] = '\0';
+    return true;
+}
+
+char* bufferRelease(StringBuffer* buffer) {
+    if (buffer == NULL) return NULL;
+
+    char* data = NULL;
+    if (buffer->sink != NULL) {
+        bufferFlush(buffer);
+    } else if (!buffer->failed) {
+        data = buffer->data;
+        buffer->data = NULL;
+    }
+    free(buffer->data);
+    free(buffer);
+    return data;
+}
+
+void freeStringBuffer(StringBuffer* buffer) {
+    free(bufferRelease(buffer));
+}
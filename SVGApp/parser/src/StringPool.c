@@ -0,0 +1,132 @@
+#include "StringPool.h"
+#include <stdlib.h>
+#include <string.h>
+
+//Slots in a new pool. Must be a power of two.
+#define STRING_POOL_INITIAL_CAPACITY 64
+//Slab size of an arena the pool makes itself. Small, so a pool for a small drawing stays small.
+#define STRING_POOL_SLAB_SIZE 4096
+#define FNV_OFFSET 0x811c9dc5u
+#define FNV_PRIME 0x01000193u
+
+static uint32_t hashString(const char* string, size_t* length) {
+    uint32_t hash = FNV_OFFSET;
+    const unsigned char* p = (const unsigned char*)string;
+    for (; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= FNV_PRIME;
+    }
+    *length = (size_t)(p - (const unsigned char*)string);
+    return hash;
+}
+
+/** Slot holding string, or the empty slot it belongs in **/
+static size_t findSlot(const StringPool* pool, const char* string, size_t length, uint32_t hash) {
+    size_t mask = pool->capacity - 1;
+    size_t slot = hash & mask;
+    while (pool->strings[slot] != NULL) {
+        if (pool->hashes[slot] == hash && strncmp(pool->strings[slot], string, length + 1) == 0) return slot;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/** Doubles the table. False if malloc fails, leaving the pool as it was **/
+static bool growPool(StringPool* pool) {
+    size_t capacity = pool->capacity * 2;
+    const char** strings = calloc(capacity, sizeof(char*));
+    uint32_t* hashes = calloc(capacity, sizeof(uint32_t));
+    if (strings == NULL || hashes == NULL) {
+        free(strings);
+        free(hashes);
+        return false;
+    }
+
+    for (size_t i = 0; i < pool->capacity; i++) {
+        if (pool->strings[i] == NULL) continue;
+        size_t slot = pool->hashes[i] & (capacity - 1);
+        while (strings[slot] != NULL) slot = (slot + 1) & (capacity - 1);
+        strings[slot] = pool->strings[i];
+        hashes[slot] = pool->hashes[i];
+    }
+    free(pool->strings);
+    free(pool->hashes);
+    pool->strings = strings;
+    pool->hashes = hashes;
+    pool->capacity = capacity;
+    return true;
+}
+
+/** Frees the table, and the arena if the pool made it. Also the arena cleanup for pools that live in an arena **/
+static void releasePool(void* data) {
+    StringPool* pool = data;
+    free(pool->strings);
+    free(pool->hashes);
+    if (pool->ownsArena) freeArena(pool->arena);
+    free(pool);
+}
+
+StringPool* createStringPool(Arena* arena) {
+    StringPool* pool = calloc(1, sizeof(StringPool));
+    if (pool == NULL) return NULL;
+
+    pool->capacity = STRING_POOL_INITIAL_CAPACITY;
+    pool->strings = calloc(pool->capacity, sizeof(char*));
+    pool->hashes = calloc(pool->capacity, sizeof(uint32_t));
+    pool->ownsArena = (arena == NULL);
+    pool->arena = (arena == NULL ? createArena(STRING_POOL_SLAB_SIZE) : arena);
+    if (pool->strings == NULL || pool->hashes == NULL || pool->arena == NULL) {
+        releasePool(pool);
+        return NULL;
+    }
+
+    if (arena != NULL) arenaAddCleanup(arena, pool, releasePool);
+    return pool;
+}
+
+/** Returns the pool's copy of string, adding one if there is none. The copy is made in the arena, or string itself is
+ * used if copy is false **/
+static const char* addString(StringPool* pool, const char* string, bool copy) {
+    size_t length = 0;
+    uint32_t hash = hashString(string, &length);
+    size_t slot = findSlot(pool, string, length, hash);
+    if (pool->strings[slot] != NULL) return pool->strings[slot];
+
+    //Grow before filling the slot, so the table never passes half full
+    if ((pool->count + 1) * 2 > pool->capacity) {
+        if (!growPool(pool)) return NULL;
+        slot = findSlot(pool, string, length, hash);
+    }
+
+    const char* stored = string;
+    if (copy) {
+        char* duplicate = arenaAlloc(pool->arena, length + 1);
+        if (duplicate == NULL) return NULL;
+        memcpy(duplicate, string, length + 1);
+        stored = duplicate;
+    }
+    pool->strings[slot] = stored;
+    pool->hashes[slot] = hash;
+    pool->count++;
+    return stored;
+}
+
+const char* internString(StringPool* pool, const char* string) {
+    return addString(pool, string, true);
+}
+
+const char* adoptString(StringPool* pool, const char* string) {
+    return addString(pool, string, false);
+}
+
+const char* findString(const StringPool* pool, const char* string) {
+    if (pool == NULL || string == NULL) return NULL;
+    size_t length = 0;
+    uint32_t hash = hashString(string, &length);
+    return pool->strings[findSlot(pool, string, length, hash)];
+}
+
+void freeStringPool(StringPool* pool) {
+    if (pool == NULL || !pool->ownsArena) return;
+    releasePool(pool);
+}
@@ -0,0 +1,239 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "SummaryCache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//Directory beside each file that holds its record
+#define CACHE_DIRECTORY ".svgcache"
+//Bumped whenever the record layout or the JSON it holds changes, so old records are ignored
+#define CACHE_VERSION 2
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+static uint64_t hashBytes(uint64_t hash, const unsigned char* bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/** Hashes a file's contents. False if it could not be read **/
+static bool hashFile(const char* path, uint64_t* hash) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return false;
+
+    unsigned char block[65536];
+    size_t length = 0;
+    *hash = FNV_OFFSET;
+    while ((length = fread(block, 1, sizeof(block), file)) > 0) *hash = hashBytes(*hash, block, length);
+    bool failed = ferror(file);
+    fclose(file);
+    return !failed;
+}
+
+/** Path of the cache directory for a file, or of one of the file's records if extension is not NULL. Newly allocated **/
+static char* cachePath(const char* path, const char* extension) {
+    const char* slash = strrchr(path, '/');
+    const char* name = (slash == NULL ? path : slash + 1);
+    int directoryLength = (slash == NULL ? 1 : (int)(slash - path));
+    const char* directory = (slash == NULL ? "." : path);
+
+    char* result = malloc(directoryLength + strlen(CACHE_DIRECTORY) + strlen(name) + (extension == NULL ? 0 : strlen(extension)) + 3);
+    if (result == NULL) return NULL;
+    if (extension != NULL) {
+        sprintf(result, "%.*s/%s/%s%s", directoryLength, directory, CACHE_DIRECTORY, name, extension);
+    } else {
+        sprintf(result, "%.*s/%s", directoryLength, directory, CACHE_DIRECTORY);
+    }
+    return result;
+}
+
+/** Creates the cache directory for a file if needed, and opens a new temporary file in it beside the record.
+ * NULL on failure. On success tempPath is set to the newly allocated name of the temporary file **/
+static FILE* openTempRecord(const char* path, const char* recordPath, char** tempPath) {
+    char* directory = cachePath(path, NULL);
+    *tempPath = malloc(strlen(recordPath) + 8);
+    if (directory == NULL || *tempPath == NULL || (mkdir(directory, 0755) != 0 && errno != EEXIST)) {
+        free(directory);
+        free(*tempPath);
+        *tempPath = NULL;
+        return NULL;
+    }
+    free(directory);
+
+    sprintf(*tempPath, "%s.XXXXXX", recordPath);
+    int descriptor = mkstemp(*tempPath);
+    FILE* file = (descriptor < 0 ? NULL : fdopen(descriptor, "wb"));
+    if (file == NULL) {
+        if (descriptor >= 0) {
+            close(descriptor);
+            unlink(*tempPath);
+        }
+        free(*tempPath);
+        *tempPath = NULL;
+    }
+    return file;
+}
+
+/** Closes a temporary file and renames it over the record, so readers see the old or the new record. The temporary
+ * file is removed instead if anything went wrong. Frees tempPath **/
+static bool commitTempRecord(FILE* file, char* tempPath, const char* recordPath) {
+    bool written = !ferror(file);
+    written = (fclose(file) == 0 && written);
+    if (!(written && rename(tempPath, recordPath) == 0)) {
+        unlink(tempPath);
+        written = false;
+    }
+    free(tempPath);
+    return written;
+}
+
+bool sameFileIdentity(const FileIdentity* a, const FileIdentity* b) {
+    return a->size == b->size && a->mtimeSec == b->mtimeSec && a->mtimeNsec == b->mtimeNsec && a->hash == b->hash &&
+           a->schemaHash == b->schemaHash && a->schemaSize == b->schemaSize &&
+           a->schemaMtimeSec == b->schemaMtimeSec && a->schemaMtimeNsec == b->schemaMtimeNsec;
+}
+
+/** Reads a string of length bytes, or leaves it NULL if length is -1. False on a short read **/
+static bool readCachedString(FILE* file, long long length, char** string) {
+    *string = NULL;
+    if (length < 0) return true;
+    if ((*string = malloc(length + 1)) == NULL) return false;
+    if (fread(*string, 1, length, file) != (size_t)length) return false;
+    (*string)[length] = '\0';
+    return true;
+}
+
+/** Fills in the file's size and modification time and the schema's part of an identity. False if the schema could
+ * not be read **/
+static bool startIdentity(long long size, long long mtimeSec, long mtimeNsec, const char* schemaPath, FileIdentity* identity) {
+    struct stat schemaInfo;
+    if (schemaPath == NULL || stat(schemaPath, &schemaInfo) != 0) return false;
+
+    memset(identity, 0, sizeof(FileIdentity));
+    identity->size = size;
+    identity->mtimeSec = mtimeSec;
+    identity->mtimeNsec = mtimeNsec;
+    identity->schemaHash = hashBytes(FNV_OFFSET, (const unsigned char*)schemaPath, strlen(schemaPath));
+    identity->schemaSize = schemaInfo.st_size;
+    identity->schemaMtimeSec = schemaInfo.st_mtim.tv_sec;
+    identity->schemaMtimeNsec = schemaInfo.st_mtim.tv_nsec;
+    return true;
+}
+
+bool getFileIdentity(const char* path, const char* schemaPath, FileIdentity* identity) {
+    struct stat fileInfo;
+    if (path == NULL || stat(path, &fileInfo) != 0 ||
+        !startIdentity(fileInfo.st_size, fileInfo.st_mtim.tv_sec, fileInfo.st_mtim.tv_nsec, schemaPath, identity)) return false;
+    return hashFile(path, &identity->hash);
+}
+
+bool getContentIdentity(const void* contents, size_t size, long long mtimeSec, long mtimeNsec, const char* schemaPath,
+                        FileIdentity* identity) {
+    if (contents == NULL || !startIdentity(size, mtimeSec, mtimeNsec, schemaPath, identity)) return false;
+    identity->hash = hashBytes(FNV_OFFSET, contents, size);
+    return true;
+}
+
+FileSummary* createFileSummary(const FileIdentity* identity) {
+    FileSummary* summary = calloc(1, sizeof(FileSummary));
+    if (summary == NULL) return NULL;
+    summary->identity = *identity;
+    summary->valid = true;
+    return summary;
+}
+
+FileSummary* loadFileSummary(const char* path, const FileIdentity* identity) {
+    char* recordPath = cachePath(path, "");
+    FILE* file = (recordPath == NULL ? NULL : fopen(recordPath, "rb"));
+    free(recordPath);
+    if (file == NULL) return NULL;
+
+    //One header line with the identity, the valid flag and the string lengths, then the strings themselves
+    FileIdentity cached = {0};
+    int version = 0, valid = 0;
+    long long countsLength = -1, fullLength = -1;
+    unsigned long long hash = 0, schemaHash = 0;
+    char header[512];
+    FileSummary* summary = NULL;
+    if (fgets(header, sizeof(header), file) != NULL &&
+        sscanf(header, "svgcache %d %lld %lld %ld %llx %llx %lld %lld %ld %d %lld %lld", &version, &cached.size,
+               &cached.mtimeSec, &cached.mtimeNsec, &hash, &schemaHash, &cached.schemaSize, &cached.schemaMtimeSec,
+               &cached.schemaMtimeNsec, &valid, &countsLength, &fullLength) == 12) {
+        cached.hash = hash;
+        cached.schemaHash = schemaHash;
+        if (version == CACHE_VERSION && sameFileIdentity(&cached, identity)) summary = createFileSummary(identity);
+    }
+
+    if (summary != NULL) {
+        summary->valid = valid;
+        if (!readCachedString(file, countsLength, &summary->counts) || !readCachedString(file, fullLength, &summary->full)) {
+            freeFileSummary(summary);
+            summary = NULL;
+        }
+    }
+    fclose(file);
+    return summary;
+}
+
+bool storeFileSummary(const char* path, const FileSummary* summary) {
+    char* recordPath = cachePath(path, "");
+    char* tempPath = NULL;
+    FILE* file = (recordPath == NULL ? NULL : openTempRecord(path, recordPath, &tempPath));
+    if (file == NULL) {
+        free(recordPath);
+        return false;
+    }
+
+    const FileIdentity* id = &summary->identity;
+    long long countsLength = (summary->counts == NULL ? -1 : (long long)strlen(summary->counts));
+    long long fullLength = (summary->full == NULL ? -1 : (long long)strlen(summary->full));
+    fprintf(file, "svgcache %d %lld %lld %ld %llx %llx %lld %lld %ld %d %lld %lld\n", CACHE_VERSION, id->size,
+            id->mtimeSec, id->mtimeNsec, (unsigned long long)id->hash, (unsigned long long)id->schemaHash,
+            id->schemaSize, id->schemaMtimeSec, id->schemaMtimeNsec, summary->valid, countsLength, fullLength);
+    if (summary->counts != NULL) fputs(summary->counts, file);
+    if (summary->full != NULL) fputs(summary->full, file);
+
+    bool written = commitTempRecord(file, tempPath, recordPath);
+    free(recordPath);
+    return written;
+}
+
+char* cacheRecordPath(const char* path, const char* extension) {
+    return (path == NULL || extension == NULL ? NULL : cachePath(path, extension));
+}
+
+bool storeCacheRecord(const char* path, const char* extension, const void* data, size_t length) {
+    char* recordPath = cacheRecordPath(path, extension);
+    char* tempPath = NULL;
+    FILE* file = (recordPath == NULL ? NULL : openTempRecord(path, recordPath, &tempPath));
+    if (file == NULL) {
+        free(recordPath);
+        return false;
+    }
+
+    fwrite(data, 1, length, file);
+    bool written = commitTempRecord(file, tempPath, recordPath);
+    free(recordPath);
+    return written;
+}
+
+void invalidateFileSummary(const char* path) {
+    if (path == NULL) return;
+    char* recordPath = cachePath(path, "");
+    if (recordPath != NULL) unlink(recordPath);
+    free(recordPath);
+}
+
+void freeFileSummary(FileSummary* summary) {
+    if (summary == NULL) return;
+    free(summary->counts);
+    free(summary->full);
+    free(summary);
+}
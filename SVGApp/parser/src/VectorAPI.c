@@ -0,0 +1,170 @@
+#include "VectorAPI.h"
+
+#define VECTOR_INITIAL_CAPACITY 8
+
+/** Delete function for vectors that only borrow their data **/
+void borrowedVectorData(void* toBeDeleted){
+}
+
+Vector* initializeVector(char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second)){
+    assert(printFunction != NULL);
+    assert(deleteFunction != NULL);
+    assert(compareFunction != NULL);
+
+    Vector* vector = calloc(1, sizeof(Vector));
+    if (vector == NULL){
+        return NULL;
+    }
+
+    vector->deleteData = deleteFunction;
+    vector->compare = compareFunction;
+    vector->printData = printFunction;
+
+    return vector;
+}
+
+void freeVector(Vector* vector){
+    if (vector == NULL){
+        return;
+    }
+
+    clearVector(vector);
+    free(vector->data);
+    free(vector);
+}
+
+void clearVector(Vector* vector){
+    if (vector == NULL){
+        return;
+    }
+
+    for (int i = 0; i < vector->length; i++){
+        vector->deleteData(vector->data[i]);
+    }
+    vector->length = 0;
+}
+
+void reserveVector(Vector* vector, int capacity){
+    if (vector == NULL || capacity <= vector->capacity){
+        return;
+    }
+
+    void** data = realloc(vector->data, sizeof(void*) * capacity);
+    if (data == NULL){
+        return;
+    }
+    vector->data = data;
+    vector->capacity = capacity;
+}
+
+void insertBackVector(Vector* vector, void* toBeAdded){
+    if (vector == NULL || toBeAdded == NULL){
+        return;
+    }
+
+    //Doubling keeps insertion amortized constant time
+    if (vector->length == vector->capacity){
+        reserveVector(vector, vector->capacity == 0 ? VECTOR_INITIAL_CAPACITY : vector->capacity * 2);
+        if (vector->length == vector->capacity){
+            return;
+        }
+    }
+
+    vector->data[vector->length] = toBeAdded;
+    (vector->length)++;
+}
+
+void* getVectorElement(Vector* vector, int index){
+    if (vector == NULL || index < 0 || index >= vector->length){
+        return NULL;
+    }
+
+    return vector->data[index];
+}
+
+void* setVectorElement(Vector* vector, int index, void* data){
+    if (vector == NULL || index < 0 || index >= vector->length || data == NULL){
+        return NULL;
+    }
+
+    void* old = vector->data[index];
+    vector->data[index] = data;
+    return old;
+}
+
+int getVectorLength(Vector* vector){
+    if (vector == NULL){
+        return -1;
+    }
+
+    return vector->length;
+}
+
+char* vectorToString(Vector* vector){
+    size_t length = 0;
+    size_t capacity = 64;
+    char* str = malloc(capacity);
+    str[0] = '\0';
+
+    for (int i = 0; i < vector->length; i++){
+        char* currDescr = vector->printData(vector->data[i]);
+        size_t descrLength = strlen(currDescr);
+
+        //Grow geometrically so building the string stays linear
+        if (length + descrLength + 2 > capacity){
+            while (length + descrLength + 2 > capacity){
+                capacity *= 2;
+            }
+            str = realloc(str, capacity);
+        }
+        str[length++] = '\n';
+        memcpy(str + length, currDescr, descrLength + 1);
+        length += descrLength;
+
+        free(currDescr);
+    }
+
+    return str;
+}
+
+VectorIterator createVectorIterator(Vector* vector){
+    VectorIterator iter;
+
+    iter.vector = vector;
+    iter.index = 0;
+
+    return iter;
+}
+
+void* nextVectorElement(VectorIterator* iter){
+    if (iter->vector == NULL || iter->index >= iter->vector->length){
+        return NULL;
+    }
+
+    return iter->vector->data[(iter->index)++];
+}
+
+void* findVectorElement(Vector* vector, bool (*customCompare)(const void* first,const void* second), const void* searchRecord){
+    if (vector == NULL || customCompare == NULL){
+        return NULL;
+    }
+
+    for (int i = 0; i < vector->length; i++){
+        if (customCompare(vector->data[i], searchRecord)){
+            return vector->data[i];
+        }
+    }
+
+    return NULL;
+}
+
+Vector* listToVector(List* list){
+    Vector* vector = initializeVector(list->printData, borrowedVectorData, list->compare);
+    reserveVector(vector, list->length);
+
+    for (Node* node = list->head; node != NULL; node = node->next){
+        insertBackVector(vector, node->data);
+    }
+
+    return vector;
+}
@@ -1,5 +1,13 @@
+#define _XOPEN_SOURCE 700
 #include <Helper.h>
 #include "SVGParser.h"
+#include <ftw.h>
+#include <malloc.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
 
 Circle* getTestCircle();
 Path* getTestPath();
@@ -7,7 +15,96 @@ Group* getTestGroup();
 Attribute* getTestAttr1();
 Attribute* getTestAttr2();
 
-int main() {
+//A named check run by "programTest test", or a timing run by "programTest bench". Returns true if it passed or
+//completed.
+typedef struct {
+    const char* name;
+    bool (*run)(const char* directory, char* schemaFile);
+    //Set for slow runs, which only run when asked for by name
+    bool onDemand;
+} TestCase;
+
+bool runTests(const TestCase* tests, int numTests, const char* only, char* schemaFile);
+char* makeTestDirectory();
+int removeTestFile(const char* path, const struct stat* info, int type, struct FTW* walk);
+char* writeTestSVG(const char* directory, const char* name, int numRects, int numCircles, int numPaths, int numGroups);
+double elapsedMs(const struct timespec* start);
+uint64_t nextRandom(uint64_t* state);
+void randomNumberText(uint64_t* state, char* buffer);
+bool testConcurrentLoads(const char* directory, char* schemaFile);
+bool testNumberParser(const char* directory, char* schemaFile);
+int significantDigits(const char* text);
+void* checkFloatRange(void* data);
+bool checkFloats(uint64_t stride);
+bool testFloatFormatSampled(const char* directory, char* schemaFile);
+bool testFloatFormatExhaustive(const char* directory, char* schemaFile);
+char* describeImage(SVGimage* image);
+void editImage(SVGimage* image);
+bool testSnapshotRoundTrip(const char* directory, char* schemaFile);
+bool testPathBounds(const char* directory, char* schemaFile);
+bool testJSONEscapes(const char* directory, char* schemaFile);
+bool testTitleText(const char* directory, char* schemaFile);
+bool benchValidatedLoads(const char* directory, char* schemaFile);
+bool benchSpatialQueries(const char* directory, char* schemaFile);
+bool benchNumberParser(const char* directory, char* schemaFile);
+bool benchSnapshotLoads(const char* directory, char* schemaFile);
+bool benchFloatFormat(const char* directory, char* schemaFile);
+bool benchContainers(const char* directory, char* schemaFile);
+char* intToString(void* data);
+int compareInts(const void* first, const void* second);
+bool benchElementEdits(const char* directory, char* schemaFile);
+bool benchJSONWriter(const char* directory, char* schemaFile);
+char* concatenateRectsJSON(const List* list);
+bool benchKeywordDispatch(const char* directory, char* schemaFile);
+int dispatchByStrcmp(const char* name);
+bool benchStreamingWriter(const char* directory, char* schemaFile);
+char* readTestFile(const char* path);
+void* countedMalloc(size_t size);
+void* countedRealloc(void* memory, size_t size);
+void countedFree(void* memory);
+char* countedStrdup(const char* string);
+
+//Every test, in the order "programTest test" runs them
+const TestCase tests[] = {
+    {"concurrent", testConcurrentLoads},
+    {"numbers", testNumberParser},
+    {"snapshot", testSnapshotRoundTrip},
+    {"floats", testFloatFormatSampled},
+    {"floats-all", testFloatFormatExhaustive, true},
+    {"paths", testPathBounds},
+    {"json", testJSONEscapes},
+    {"text", testTitleText},
+};
+
+//Every benchmark, in the order "programTest bench" runs them
+const TestCase benchmarks[] = {
+    {"load", benchValidatedLoads},
+    {"rtree", benchSpatialQueries},
+    {"numbers", benchNumberParser},
+    {"snapshot", benchSnapshotLoads},
+    {"floats", benchFloatFormat},
+    {"containers", benchContainers},
+    {"edits", benchElementEdits},
+    {"json", benchJSONWriter},
+    {"keywords", benchKeywordDispatch},
+    {"writer", benchStreamingWriter},
+};
+
+/*  Usage:
+ *    programTest                         prints the first rectangle of uploads/quad01_A2.svg
+ *    programTest test [name] [schema]    runs every test, or only the named one
+ *    programTest bench [name] [schema]   runs every benchmark, or only the named one
+ */
+int main(int argc, char** argv) {
+    char* schemaFile = (argc > 3 ? argv[3] : "parser/bin/files/svg.xsd");
+    const char* only = (argc > 2 && strcmp(argv[2], "all") != 0 ? argv[2] : NULL);
+    if (argc > 1 && strcmp(argv[1], "test") == 0) {
+        return runTests(tests, sizeof(tests) / sizeof(tests[0]), only, schemaFile) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return runTests(benchmarks, sizeof(benchmarks) / sizeof(benchmarks[0]), only, schemaFile) ? 0 : 1;
+    }
+
     SVGimage* image = createValidSVGimage("uploads/quad01_A2.svg", "parser/bin/files/svg.xsd");
 
     printf("%s\n", rectToJSON(image->rectangles->head->data));
@@ -16,6 +113,1228 @@ int main() {
     return 0;
 }
 
+/**
+ * Runs tests, each in a fresh temporary directory that is removed afterwards.
+ * @param tests The tests.
+ * @param numTests Number of tests.
+ * @param only Name of the one test to run, or NULL to run all but the on demand ones.
+ * @param schemaFile The SVG schema, passed to each test.
+ * @return True if every test that ran passed, and at least one ran.
+ */
+bool runTests(const TestCase* tests, int numTests, const char* only, char* schemaFile) {
+    initSVGParser();
+    int ran = 0;
+    int failed = 0;
+    for (int i = 0; i < numTests; i++) {
+        if (only != NULL ? strcmp(only, tests[i].name) != 0 : tests[i].onDemand) continue;
+        char* directory = makeTestDirectory();
+        if (directory == NULL) return false;
+        bool passed = tests[i].run(directory, schemaFile);
+        printf("%-12s %s\n", tests[i].name, passed ? "ok" : "FAILED");
+        nftw(directory, removeTestFile, 16, FTW_DEPTH | FTW_PHYS);
+        free(directory);
+        ran++;
+        failed += !passed;
+    }
+    cleanupSVGParser();
+    if (ran == 0) printf("no test named %s\n", only);
+    return ran > 0 && failed == 0;
+}
+
+/**
+ * Creates an empty directory for a test's files.
+ * @return The directory's path, which the caller frees, or NULL if it could not be made.
+ */
+char* makeTestDirectory() {
+    const char* base = getenv("TMPDIR");
+    char* path = calloc(strlen(base != NULL ? base : "/tmp") + 32, sizeof(char));
+    sprintf(path, "%s/svgtest.XXXXXX", base != NULL ? base : "/tmp");
+    if (mkdtemp(path) == NULL) {
+        perror("mkdtemp");
+        free(path);
+        return NULL;
+    }
+    return path;
+}
+
+/**Milliseconds since start, on the monotonic clock*/
+double elapsedMs(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e3 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+/**xorshift64 step, so every run of a test sees the same random inputs*/
+uint64_t nextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**nftw callback that removes everything under a test directory, the directory last*/
+int removeTestFile(const char* path, const struct stat* info, int type, struct FTW* walk) {
+    return remove(path);
+}
+
+/**
+ * Writes an SVG file with the given numbers of components to a test directory. Each group holds one of each shape,
+ * so the file has numGroups more rectangles, circles and paths than asked for at the top level.
+ * @param directory The test directory.
+ * @param name The file's name.
+ * @return The file's path, which the caller frees, or NULL if it could not be written.
+ */
+char* writeTestSVG(const char* directory, const char* name, int numRects, int numCircles, int numPaths, int numGroups) {
+    char* path = calloc(strlen(directory) + strlen(name) + 2, sizeof(char));
+    sprintf(path, "%s/%s", directory, name);
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        free(path);
+        return NULL;
+    }
+
+    fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\" viewBox=\"0 0 1000 1000\">\n");
+    fprintf(file, "  <title>%s</title>\n  <desc>Generated by programTest</desc>\n", name);
+    for (int i = 0; i < numRects; i++) {
+        fprintf(file, "  <rect x=\"%d\" y=\"%d.5\" width=\"10\" height=\"20\" fill=\"#%06x\"/>\n", i % 1000, i / 1000, i * 37 % 0xffffff);
+    }
+    for (int i = 0; i < numCircles; i++) {
+        fprintf(file, "  <circle cx=\"%d\" cy=\"%d\" r=\"%d.25\" stroke=\"red\"/>\n", i % 1000, i / 1000, i % 7 + 1);
+    }
+    for (int i = 0; i < numPaths; i++) {
+        fprintf(file, "  <path d=\"M%d %d l10 0 0 10 -10 0z\" fill=\"none\"/>\n", i % 1000, i / 1000);
+    }
+    for (int i = 0; i < numGroups; i++) {
+        fprintf(file, "  <g id=\"g%d\" fill=\"blue\">\n", i);
+        fprintf(file, "    <rect x=\"%d\" y=\"1\" width=\"2\" height=\"2\"/>\n", i);
+        fprintf(file, "    <circle cx=\"%d\" cy=\"1\" r=\"1\"/>\n", i);
+        fprintf(file, "    <path d=\"M0 0 C 1 2 3 4 %d 6\"/>\n", i);
+        fprintf(file, "  </g>\n");
+    }
+    fprintf(file, "</svg>\n");
+    if (fclose(file) != 0) {
+        free(path);
+        return NULL;
+    }
+    return path;
+}
+
+//Shared by the threads of testConcurrentLoads
+typedef struct {
+    char* files[2];
+    char* expected[2];
+    char* schemaFile;
+    atomic_bool failed;
+    atomic_bool done;
+} ConcurrentLoads;
+
+/**Worker for testConcurrentLoads: loads, exports and validates both files, checking every result*/
+void* concurrentLoadWorker(void* data) {
+    ConcurrentLoads* shared = data;
+    for (int i = 0; i < 40 && !atomic_load(&shared->failed); i++) {
+        int which = i % 2;
+        char* json = fullImageToJSON(shared->files[which], shared->schemaFile);
+        bool ok = (json != NULL && strcmp(json, shared->expected[which]) == 0);
+        free(json);
+
+        //Validating an image always goes through the schema cache, unlike a load that a snapshot can answer
+        SVGimage* image = createSVGimage(shared->files[which]);
+        ok = ok && image != NULL && validateSVGimage(image, shared->schemaFile);
+        deleteSVGimage(image);
+
+        SVGimage* arenaImage = createValidSVGimageInArena(shared->files[1 - which], shared->schemaFile);
+        ok = ok && arenaImage != NULL && getLength(arenaImage->rectangles) > 0;
+        deleteSVGimage(arenaImage);
+        if (!ok) atomic_store(&shared->failed, true);
+    }
+    return NULL;
+}
+
+/**Clears the schema cache over and over while the workers are validating with it*/
+void* schemaCacheClearer(void* data) {
+    ConcurrentLoads* shared = data;
+    while (!atomic_load(&shared->done)) {
+        clearSchemaCache();
+    }
+    return NULL;
+}
+
+/**
+ * Loads, exports and validates two files from several threads at once while another thread clears the schema
+ * cache, and checks every thread sees the same results as a single threaded run.
+ */
+bool testConcurrentLoads(const char* directory, char* schemaFile) {
+    ConcurrentLoads shared = {.schemaFile = schemaFile};
+    shared.files[0] = writeTestSVG(directory, "small.svg", 20, 10, 10, 5);
+    shared.files[1] = writeTestSVG(directory, "large.svg", 2000, 500, 500, 200);
+    bool passed = (shared.files[0] != NULL && shared.files[1] != NULL);
+    for (int i = 0; passed && i < 2; i++) {
+        shared.expected[i] = fullImageToJSON(shared.files[i], schemaFile);
+        passed = (shared.expected[i] != NULL);
+    }
+    if (!passed) printf("  could not load the test files, is %s the SVG schema?\n", schemaFile);
+
+    if (passed) {
+        pthread_t workers[8];
+        pthread_t clearer;
+        pthread_create(&clearer, NULL, schemaCacheClearer, &shared);
+        for (int i = 0; i < 8; i++) pthread_create(&workers[i], NULL, concurrentLoadWorker, &shared);
+        for (int i = 0; i < 8; i++) pthread_join(workers[i], NULL);
+        atomic_store(&shared.done, true);
+        pthread_join(clearer, NULL);
+        passed = !atomic_load(&shared.failed);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        free(shared.files[i]);
+        free(shared.expected[i]);
+    }
+    return passed;
+}
+
+/**
+ * Writes random text that starts like a number: a float printed several ways, the exact halfway point between two
+ * floats, a coordinate, or a string of digits with a sign, decimal point and exponent that may be incomplete. Some
+ * have leading whitespace, and most are followed by units or a separator.
+ * @param state The random state.
+ * @param buffer Set to the text. Must hold 256 characters.
+ */
+void randomNumberText(uint64_t* state, char* buffer) {
+    static const char* formats[] = {"%g", "%.9g", "%.6f", "%.20e", "%.3f", "%.12g"};
+    static const char* tails[] = {"", "px", "em", ",3", " 4", "e", "e+", "ex", "%", ".", "mm"};
+    char* next = buffer;
+    if (nextRandom(state) % 8 == 0) *next++ = " \t\n"[nextRandom(state) % 3];
+
+    uint32_t bits = (uint32_t)nextRandom(state);
+    float value;
+    switch (nextRandom(state) % 6) {
+        case 0:
+            memcpy(&value, &bits, sizeof(value));
+            if (!isfinite(value)) value = 1.5f;
+            next += sprintf(next, formats[nextRandom(state) % 6], value);
+            break;
+        case 1:
+            //Halfway between a float and the next one up, the hardest case to round correctly
+            bits &= 0x7f7fffff;
+            memcpy(&value, &bits, sizeof(value));
+            next += sprintf(next, "%.60g", ((double)value + nextafterf(value, INFINITY)) / 2);
+            break;
+        case 2:
+            next += sprintf(next, "%s%d.%0*d", nextRandom(state) % 3 == 0 ? "-" : "", (int)(nextRandom(state) % 100000),
+                            (int)(1 + nextRandom(state) % 6), (int)(nextRandom(state) % 1000000));
+            break;
+        default:
+            if (nextRandom(state) % 3 == 0) *next++ = "+-"[nextRandom(state) % 2];
+            for (int i = nextRandom(state) % 30; i > 0; i--) *next++ = '0' + nextRandom(state) % 10;
+            if (nextRandom(state) % 2) {
+                *next++ = '.';
+                for (int i = nextRandom(state) % 30; i > 0; i--) *next++ = '0' + nextRandom(state) % 10;
+            }
+            if (nextRandom(state) % 2) {
+                *next++ = "eE"[nextRandom(state) % 2];
+                if (nextRandom(state) % 2) *next++ = "+-"[nextRandom(state) % 2];
+                for (int i = nextRandom(state) % 4; i > 0; i--) *next++ = '0' + nextRandom(state) % 10;
+            }
+            break;
+    }
+    strcpy(next, tails[nextRandom(state) % 11]);
+}
+
+/**
+ * Checks parseSVGNumber against strtof in the C locale, on edge cases and millions of random inputs. Both the value,
+ * bit for bit, and where the number ends must match.
+ */
+bool testNumberParser(const char* directory, char* schemaFile) {
+    static const char* edgeCases[] = {"0", "-0", "+.5", "5.", "1e38", "3.4028235e38", "3.5e38", "1e-46", "1e-40",
+                                      "1.17549435e-38", "7e-46", ".e5", "-", "", "1e999999999", "-1e-999999999",
+                                      "00000000000000000000000000001.5", "0.000000000000000000000000000000000000000000001",
+                                      "123456789012345678901234567890e-10", "16777217", "0.1", "1.5e", "2e+", "  -3.25px"};
+    const long numRandom = 2000000;
+    int numEdgeCases = sizeof(edgeCases) / sizeof(edgeCases[0]);
+    long mismatches = 0;
+    uint64_t state = 88172645463325252ULL;
+    char buffer[256];
+
+    for (long i = 0; i < numEdgeCases + numRandom; i++) {
+        const char* text = (i < numEdgeCases ? edgeCases[i] : buffer);
+        if (i >= numEdgeCases) randomNumberText(&state, buffer);
+        char* expectedEnd = NULL;
+        char* end = NULL;
+        float expected = strtof(text, &expectedEnd);
+        float value = parseSVGNumber(text, &end);
+        if (memcmp(&expected, &value, sizeof(float)) != 0 || end != expectedEnd) {
+            if (mismatches++ < 10) {
+                printf("  \"%s\": strtof gives %a ending at %ld, parseSVGNumber %a ending at %ld\n", text, expected,
+                       (long)(expectedEnd - text), value, (long)(end - text));
+            }
+        }
+    }
+    if (mismatches > 0) printf("  %ld of %ld inputs differ\n", mismatches, numEdgeCases + numRandom);
+    return mismatches == 0;
+}
+
+/**
+ * Counts the significant digits in a formatted number, ignoring sign, leading and trailing zeros and the exponent.
+ * @param text The number.
+ * @return The count, at least 1.
+ */
+int significantDigits(const char* text) {
+    int first = -1, last = -1, index = 0;
+    for (const char* c = text; *c != '\0' && *c != 'e'; c++) {
+        if (*c < '0' || *c > '9') continue;
+        if (*c != '0') {
+            if (first < 0) first = index;
+            last = index;
+        }
+        index++;
+    }
+    return (first < 0 ? 1 : last - first + 1);
+}
+
+//One thread's share of checkFloats: every stride'th float bit pattern from first up to end
+typedef struct {
+    uint64_t first;
+    uint64_t end;
+    uint64_t stride;
+    unsigned long checked;
+    unsigned long mismatches;
+    unsigned long tooLong;
+} FloatRange;
+
+/**Worker for checkFloats*/
+void* checkFloatRange(void* data) {
+    FloatRange* range = data;
+    char buffer[NUMBER_FORMAT_SIZE];
+    char reference[32];
+    for (uint64_t pattern = range->first; pattern < range->end; pattern += range->stride) {
+        uint32_t bits = (uint32_t)pattern;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value)) continue;
+        range->checked++;
+
+        formatNumber(buffer, value, NUMBER_SHORTEST);
+        float parsed = parseSVGNumber(buffer, NULL);
+        if (memcmp(&parsed, &value, sizeof(value)) != 0 && range->mismatches++ < 5) {
+            printf("  %08x is written as %s, which reads back as %a\n", bits, buffer, parsed);
+        }
+
+        //The shortest text that reads back correctly has as few digits as the shortest %g that does
+        if (pattern % 4099 == 0) {
+            int precision = 1;
+            for (; precision < 9; precision++) {
+                snprintf(reference, sizeof(reference), "%.*g", precision, value);
+                if (strtof(reference, NULL) == value) break;
+            }
+            if (significantDigits(buffer) > precision && range->tooLong++ < 5) {
+                printf("  %08x is written as %s, but %.*g is shorter\n", bits, buffer, precision, value);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Checks that every stride'th finite float is written with formatNumber as text that reads back as the same float,
+ * and a sample of them with no more digits than needed.
+ */
+bool checkFloats(uint64_t stride) {
+    const int numThreads = 8;
+    pthread_t threads[numThreads];
+    FloatRange ranges[numThreads];
+    uint64_t share = ((1ULL << 32) / stride + numThreads - 1) / numThreads * stride;
+    for (int i = 0; i < numThreads; i++) {
+        ranges[i] = (FloatRange){.first = share * i, .end = share * (i + 1), .stride = stride};
+        if (ranges[i].end > (1ULL << 32)) ranges[i].end = (1ULL << 32);
+        pthread_create(&threads[i], NULL, checkFloatRange, &ranges[i]);
+    }
+
+    unsigned long checked = 0, mismatches = 0, tooLong = 0;
+    for (int i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+        checked += ranges[i].checked;
+        mismatches += ranges[i].mismatches;
+        tooLong += ranges[i].tooLong;
+    }
+
+    //Fixed precision rounds the shortest text half away from zero
+    static const struct {float value; int precision; const char* text;} rounded[] = {
+        {1.005f, 2, "1.01"}, {-1.005f, 2, "-1.01"}, {10.0f, 3, "10"}, {0.125f, 2, "0.13"}, {1234.5678f, 0, "1235"},
+        {1e-7f, 2, "0"}, {99.996f, 2, "100"},
+    };
+    char buffer[NUMBER_FORMAT_SIZE];
+    for (int i = 0; i < sizeof(rounded) / sizeof(rounded[0]); i++) {
+        formatNumber(buffer, rounded[i].value, rounded[i].precision);
+        if (strcmp(buffer, rounded[i].text) != 0) {
+            printf("  %.9g with precision %d is written as %s, not %s\n", rounded[i].value, rounded[i].precision, buffer,
+                   rounded[i].text);
+            mismatches++;
+        }
+    }
+
+    if (mismatches > 0 || tooLong > 0) {
+        printf("  %lu of %lu floats do not read back, %lu are longer than needed\n", mismatches, checked, tooLong);
+    }
+    return mismatches == 0 && tooLong == 0;
+}
+
+/**Round trips every 997th float, quick enough to run with the other tests*/
+bool testFloatFormatSampled(const char* directory, char* schemaFile) {
+    return checkFloats(997);
+}
+
+/**Round trips all 2^32 float bit patterns. Takes minutes, so it runs only as "programTest test floats-all"*/
+bool testFloatFormatExhaustive(const char* directory, char* schemaFile) {
+    return checkFloats(1);
+}
+
+/**
+ * Describes everything about an image the API can report: its text form, its JSON summary and component lists,
+ * nested components included, and its attribute count.
+ * @return The description, which the caller frees.
+ */
+char* describeImage(SVGimage* image) {
+    StringBuffer* out = createStringBuffer(0);
+    char* text = SVGimageToString(image);
+    bufferAppend(out, text);
+    free(text);
+    text = SVGtoJSON(image);
+    bufferAppend(out, text);
+    free(text);
+    text = attrListToJSON(image->otherAttributes);
+    bufferAppend(out, text);
+    free(text);
+
+    List* (*getters[4])(SVGimage* image) = {getRects, getCircles, getPaths, getGroups};
+    char* (*writers[4])(const List* list) = {rectListToJSON, circListToJSON, pathListToJSON, groupListToJSON};
+    for (int i = 0; i < 4; i++) {
+        List* components = getters[i](image);
+        text = writers[i](components);
+        bufferAppend(out, text);
+        free(text);
+        freeList(components);
+    }
+
+    char counts[32];
+    sprintf(counts, "%d", numAttr(image));
+    bufferAppend(out, counts);
+    return bufferRelease(out);
+}
+
+/**Makes the same edits to an image's shapes, groups and own attributes that an editor would*/
+void editImage(SVGimage* image) {
+    setAttribute(image, SVG_IMAGE, 0, newAttribute("width", "55"));
+    setAttribute(image, SVG_IMAGE, 0, newAttribute("data-edited", "yes"));
+    setAttribute(image, RECT, 0, newAttribute("fill", "none"));
+    setAttribute(image, RECT, 1, newAttribute("x", "-12.5"));
+    setAttribute(image, CIRC, 0, newAttribute("r", "7"));
+    setAttribute(image, PATH, 0, newAttribute("d", "M1 1 L 2 2"));
+    setAttribute(image, GROUP, 0, newAttribute("fill", "red"));
+}
+
+/**
+ * Checks that an image mapped back from its snapshot is the same as the parsed image it was saved from, before and
+ * after the same edits, that heap loads never come from the snapshot, and that changing the file retires it.
+ */
+bool testSnapshotRoundTrip(const char* directory, char* schemaFile) {
+    char* file = writeTestSVG(directory, "shapes.svg", 200, 50, 50, 30);
+    SVGimage* parsed = (file == NULL ? NULL : createValidSVGimage(file, schemaFile));
+    if (parsed == NULL) {
+        printf("  could not load the test file, is %s the SVG schema?\n", schemaFile);
+        free(file);
+        return false;
+    }
+
+    FileIdentity identity;
+    bool passed = getFileIdentity(file, schemaFile, &identity) && matchesSVGsnapshot(file, &identity);
+    if (!passed) printf("  no snapshot was saved by the first load\n");
+
+    SVGimage* mapped = createValidSVGimageInArena(file, schemaFile);
+    SVGimage* heap = createValidSVGimage(file, schemaFile);
+    if (mapped == NULL || heap == NULL || mapped->arena == NULL || heap->arena != NULL) {
+        printf("  the arena load should come from the snapshot and the heap load should not\n");
+        passed = false;
+    }
+
+    for (int round = 0; passed && round < 2; round++) {
+        char* expected = describeImage(parsed);
+        char* actual = describeImage(mapped);
+        if (strcmp(expected, actual) != 0) {
+            printf("  the mapped image differs from the parsed one %s\n", round == 0 ? "as loaded" : "after editing");
+            passed = false;
+        }
+        free(expected);
+        free(actual);
+        editImage(parsed);
+        editImage(mapped);
+    }
+    deleteSVGimage(parsed);
+    deleteSVGimage(mapped);
+    deleteSVGimage(heap);
+
+    //A new version of the file must be parsed again, not answered from the old snapshot
+    free(writeTestSVG(directory, "shapes.svg", 3, 0, 0, 0));
+    mapped = createValidSVGimageInArena(file, schemaFile);
+    if (mapped == NULL || getLength(mapped->rectangles) != 3 || getLength(mapped->groups) != 0) {
+        printf("  the snapshot of the old file was used after the file changed\n");
+        passed = false;
+    }
+    deleteSVGimage(mapped);
+    free(file);
+    return passed;
+}
+
+/**
+ * Times validated loads of a corpus of large files: the single pass createValidSVGimage, which validates while it
+ * streams the file, against reading the file into a tree to validate it and then reading it again to build the image.
+ */
+bool benchValidatedLoads(const char* directory, char* schemaFile) {
+    char* files[3] = {
+        writeTestSVG(directory, "rects.svg", 150000, 0, 0, 0),
+        writeTestSVG(directory, "mixed.svg", 40000, 30000, 30000, 5000),
+        writeTestSVG(directory, "groups.svg", 0, 0, 0, 40000),
+    };
+    bool loaded = true;
+    for (int i = 0; i < 3; i++) {
+        if (files[i] == NULL) {
+            loaded = false;
+            continue;
+        }
+        double best[2] = {INFINITY, INFINITY};
+        for (int run = 0; run < 3 && loaded; run++) {
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            //Two passes: parse and validate a tree, free it, then parse the file again to build the image
+            xmlDoc* document = xmlReadFile(files[i], NULL, 0);
+            bool valid = (document != NULL && validateXMLwithXSD(document, schemaFile) == 0);
+            xmlFreeDoc(document);
+            document = (valid ? xmlReadFile(files[i], NULL, 0) : NULL);
+            SVGimage* image = (document == NULL ? NULL : createSVGimageFromDoc(document));
+            xmlFreeDoc(document);
+            double twoPassMs = elapsedMs(&start);
+            loaded = loaded && image != NULL;
+            deleteSVGimage(image);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            image = createValidSVGimage(files[i], schemaFile);
+            double onePassMs = elapsedMs(&start);
+            loaded = loaded && image != NULL;
+            deleteSVGimage(image);
+
+            if (twoPassMs < best[0]) best[0] = twoPassMs;
+            if (onePassMs < best[1]) best[1] = onePassMs;
+        }
+        if (loaded) {
+            printf("  %-12s two passes %9.2f ms, one pass %9.2f ms  (%.1fx)\n", strrchr(files[i], '/') + 1, best[0],
+                   best[1], best[0] / best[1]);
+        }
+        free(files[i]);
+    }
+    if (!loaded) printf("  could not load the test files, is %s the SVG schema?\n", schemaFile);
+    return loaded;
+}
+
+/**
+ * Checks the bounds of paths with smooth curves, whose first control point is the reflection of the previous
+ * curve's last one, in absolute and relative form, and after commands they do not reflect.
+ */
+bool testPathBounds(const char* directory, char* schemaFile) {
+    static const struct {
+        const char* data;
+        BoundingBox bounds;
+    } cases[] = {
+        {"M0 0 Q50 100 100 0 T200 0", {0, -100, 200, 100}},
+        {"m0 0 q50 100 100 0 t100 0", {0, -100, 200, 100}},
+        {"M0 0 Q10 10 20 0 T40 0 T60 0", {0, -10, 60, 10}},
+        {"M0 0 L10 10 T20 0", {0, 0, 20, 10}},
+        {"M0 0 C0 100 100 100 100 0 S200 0 200 0", {0, -100, 200, 100}},
+        {"m0 0 c0 100 100 100 100 0 s100 0 100 0", {0, -100, 200, 100}},
+        {"M0 0 Q10 10 20 0 S40 0 40 0", {0, 0, 40, 10}},
+        {"M0 0 C0 -50 50 -50 50 0 Z s50 50 50 0", {0, -50, 50, 50}},
+    };
+    bool passed = true;
+    for (int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        Path path = {.data = (char*)cases[i].data};
+        BoundingBox box = getPathBounds(&path);
+        const BoundingBox* expected = &cases[i].bounds;
+        if (box.minX != expected->minX || box.minY != expected->minY || box.maxX != expected->maxX || box.maxY != expected->maxY) {
+            printf("  %s: bounds %g %g %g %g, expected %g %g %g %g\n", cases[i].data, box.minX, box.minY, box.maxX,
+                   box.maxY, expected->minX, expected->minY, expected->maxX, expected->maxY);
+            passed = false;
+        }
+    }
+
+    //The implied control point is one of the path's points, between the previous end point and its own end point
+    PathGeometry* geometry = parsePathGeometry("M0 0 Q50 100 100 0 T200 0", NULL);
+    if (geometry == NULL || geometry->numPoints != 5 || geometry->x[3] != 150 || geometry->y[3] != -100) {
+        printf("  M0 0 Q50 100 100 0 T200 0: the implied control point is not (150, -100)\n");
+        passed = false;
+    }
+    deletePathGeometry(geometry);
+    return passed;
+}
+
+/**
+ * Checks that quotes, backslashes and control characters in titles, descriptions, attributes and path data are
+ * escaped in the image's JSON.
+ */
+bool testJSONEscapes(const char* directory, char* schemaFile) {
+    char* path = calloc(strlen(directory) + 16, sizeof(char));
+    sprintf(path, "%s/quotes.svg", directory);
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        free(path);
+        return false;
+    }
+    fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"10\" height=\"10\">\n"
+                  "  <title>say &quot;hi&quot; \\ now</title>\n  <desc>two\nlines</desc>\n"
+                  "  <rect x=\"1\" y=\"1\" width=\"2\" height=\"2\" data-note=\"a &quot;b&quot;\"/>\n"
+                  "  <path d=\"M0 0 L1 1 &quot;\" data-slash=\"\\\"/>\n</svg>\n");
+    fclose(file);
+    SVGimage* image = createSVGimage(path);
+    free(path);
+    if (image == NULL) return false;
+
+    StringBuffer* buffer = createStringBuffer(0);
+    writeFullImageJSON(buffer, image);
+    char* json = bufferRelease(buffer);
+    deleteSVGimage(image);
+
+    const char* expected[] = {"{\"title\":\"say \\\"hi\\\" \\\\ now\",\"description\":\"two\\u000alines\",",
+                              "{\"name\":\"data-note\",\"value\":\"a \\\"b\\\"\"}",
+                              "{\"d\":\"M0 0 L1 1 \\\"\",",
+                              "{\"name\":\"data-slash\",\"value\":\"\\\\\"}"};
+    bool passed = true;
+    for (int i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        if (strstr(json, expected[i]) == NULL) {
+            printf("  %s is not in %s\n", expected[i], json);
+            passed = false;
+        }
+    }
+    free(json);
+    return passed;
+}
+
+/**
+ * Checks that a streamed load takes titles and descriptions with comments in them from their first text node, as the
+ * DOM loader does, for the image and for groups.
+ */
+bool testTitleText(const char* directory, char* schemaFile) {
+    char* path = calloc(strlen(directory) + 16, sizeof(char));
+    sprintf(path, "%s/comments.svg", directory);
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        free(path);
+        return false;
+    }
+    fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"10\" height=\"10\">\n"
+                  "  <title>first<!-- note -->second</title>\n  <desc>a &amp; b<!-- x --> c</desc>\n"
+                  "  <g><desc>group<!-- y -->more</desc><rect x=\"1\" y=\"1\" width=\"1\" height=\"1\"/></g>\n"
+                  "  <rect x=\"1\" y=\"1\" width=\"2\" height=\"2\"/>\n</svg>\n");
+    fclose(file);
+    SVGimage* streamed = createSVGimage(path);
+    xmlDoc* document = xmlReadFile(path, NULL, 0);
+    SVGimage* parsed = (document == NULL ? NULL : createSVGimageFromDoc(document));
+    xmlFreeDoc(document);
+    free(path);
+
+    bool passed = (streamed != NULL && parsed != NULL);
+    if (passed) {
+        char* texts[2];
+        SVGimage* images[2] = {streamed, parsed};
+        for (int i = 0; i < 2; i++) {
+            Group* group = images[i]->groups->head->data;
+            Attribute* desc = group->otherAttributes->head->data;
+            texts[i] = calloc(strlen(desc->value) + 600, sizeof(char));
+            sprintf(texts[i], "%s|%s|%s=%s|%d|%d", images[i]->title, images[i]->description, desc->name, desc->value,
+                    getLength(images[i]->rectangles), getLength(group->rectangles));
+        }
+        passed = strcmp(texts[0], "first|a & b|desc=group|1|1") == 0 && strcmp(texts[0], texts[1]) == 0;
+        if (!passed) printf("  streamed %s, parsed %s\n", texts[0], texts[1]);
+        free(texts[0]);
+        free(texts[1]);
+    }
+    deleteSVGimage(streamed);
+    deleteSVGimage(parsed);
+    return passed;
+}
+
+/**
+ * Times area and point queries on a 1M shape image through the spatial index, against a linear scan of getRects,
+ * getCircles and getPaths, and checks both find the same shapes.
+ */
+bool benchSpatialQueries(const char* directory, char* schemaFile) {
+    char* file = writeTestSVG(directory, "shapes.svg", 600000, 200000, 200000, 0);
+    SVGimage* image = (file == NULL ? NULL : createSVGimageInArena(file));
+    free(file);
+    if (image == NULL) return false;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bool built = (getSpatialIndex(image) != NULL);
+    printf("  build index          %10.2f ms\n", elapsedMs(&start));
+
+    //Queries cover 1% of the drawing's width and height, at fixed pseudo random spots
+    BoundingBox all = getImageBounds(image);
+    float width = (all.maxX - all.minX) / 100, height = (all.maxY - all.minY) / 100;
+    unsigned int seed = 1;
+    const int numIndexed = 2000, numScanned = 5;
+    long indexedHits = 0, scannedHits = 0;
+    bool matched = built;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numIndexed; i++) {
+        float x = all.minX + (all.maxX - all.minX) * rand_r(&seed) / RAND_MAX;
+        float y = all.minY + (all.maxY - all.minY) * rand_r(&seed) / RAND_MAX;
+        Vector* found = getComponentsInArea(image, (BoundingBox){x, y, x + width, y + height});
+        indexedHits += getVectorLength(found);
+        freeVector(found);
+    }
+    double indexedMs = elapsedMs(&start) / numIndexed;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numIndexed; i++) {
+        float x = all.minX + (all.maxX - all.minX) * rand_r(&seed) / RAND_MAX;
+        float y = all.minY + (all.maxY - all.minY) * rand_r(&seed) / RAND_MAX;
+        Vector* found = getComponentsAtPoint(image, x, y);
+        freeVector(found);
+    }
+    double pointMs = elapsedMs(&start) / numIndexed;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numScanned; i++) {
+        float x = all.minX + (all.maxX - all.minX) * rand_r(&seed) / RAND_MAX;
+        float y = all.minY + (all.maxY - all.minY) * rand_r(&seed) / RAND_MAX;
+        BoundingBox area = {x, y, x + width, y + height};
+        List* lists[3] = {getRects(image), getCircles(image), getPaths(image)};
+        elementType types[3] = {RECT, CIRC, PATH};
+        long hits = 0;
+        for (int j = 0; j < 3; j++) {
+            ListIterator iterator = createIterator(lists[j]);
+            void* component = NULL;
+            while ((component = nextElement(&iterator)) != NULL) {
+                hits += boundsIntersect(getComponentBounds(image, types[j], component), area);
+            }
+            freeList(lists[j]);
+        }
+        Vector* found = getComponentsInArea(image, area);
+        matched = matched && getVectorLength(found) == hits;
+        freeVector(found);
+        scannedHits += hits;
+    }
+    double scannedMs = elapsedMs(&start) / numScanned;
+
+    printf("  area query (index)   %10.4f ms  %ld hits over %d queries\n", indexedMs, indexedHits, numIndexed);
+    printf("  point query (index)  %10.4f ms\n", pointMs);
+    printf("  area query (scan)    %10.2f ms  %ld hits over %d queries\n", scannedMs, scannedHits, numScanned);
+    deleteSVGimage(image);
+    return matched;
+}
+
+/**
+ * Times parseSVGNumber against strtof on 4M coordinates like those in a large drawing.
+ */
+bool benchNumberParser(const char* directory, char* schemaFile) {
+    const int count = 4000000;
+    char* texts = malloc(count * 16);
+    if (texts == NULL) return false;
+    uint64_t state = 1;
+    for (int i = 0; i < count; i++) {
+        uint64_t random = nextRandom(&state);
+        sprintf(texts + i * 16, "%s%u.%03u", random % 4 == 0 ? "-" : "", (unsigned)(random >> 8) % 5000, (unsigned)(random >> 40) % 1000);
+    }
+
+    volatile float sink = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < count; i++) sink += strtof(texts + i * 16, NULL);
+    double strtofMs = elapsedMs(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < count; i++) sink += parseSVGNumber(texts + i * 16, NULL);
+    double parserMs = elapsedMs(&start);
+
+    printf("  strtof               %10.1f ns/number\n", strtofMs * 1e6 / count);
+    printf("  parseSVGNumber       %10.1f ns/number  (%.1fx)\n", parserMs * 1e6 / count, strtofMs / parserMs);
+    free(texts);
+    return true;
+}
+
+/**
+ * Times validated loads of a large file parsed from XML, to the heap and to an arena, against arena loads mapped
+ * back from its snapshot.
+ */
+bool benchSnapshotLoads(const char* directory, char* schemaFile) {
+    char* file = writeTestSVG(directory, "shapes.svg", 100000, 30000, 30000, 10000);
+    if (file == NULL) return false;
+    const int runs = 5;
+    double best[3] = {INFINITY, INFINITY, INFINITY};
+    bool loaded = true;
+
+    for (int i = 0; i < runs && loaded; i++) {
+        for (int kind = 0; kind < 3; kind++) {
+            //Kind 1 parses into an arena, and saves the snapshot that kind 2 maps back
+            if (kind == 1) invalidateSVGsnapshot(file);
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            SVGimage* image = (kind == 0 ? createValidSVGimage(file, schemaFile) : createValidSVGimageInArena(file, schemaFile));
+            double ms = elapsedMs(&start);
+            loaded = loaded && image != NULL;
+            deleteSVGimage(image);
+            if (ms < best[kind]) best[kind] = ms;
+        }
+    }
+    if (!loaded) printf("  could not load the test file, is %s the SVG schema?\n", schemaFile);
+
+    printf("  parse and validate, heap     %10.2f ms\n", best[0]);
+    printf("  parse, validate and save     %10.2f ms\n", best[1]);
+    printf("  map snapshot                 %10.2f ms  (%.1fx faster than parsing)\n", best[2], best[0] / best[2]);
+    free(file);
+    return loaded;
+}
+
+/**
+ * Times formatNumber, shortest and with 2 decimals, against the printf conversions the writers used before it.
+ */
+bool benchFloatFormat(const char* directory, char* schemaFile) {
+    const int count = 2000000;
+    float* values = malloc(count * sizeof(float));
+    if (values == NULL) return false;
+    uint64_t state = 3;
+    for (int i = 0; i < count; i++) {
+        uint64_t random = nextRandom(&state);
+        values[i] = ((long)(random % 2000000) - 1000000) / (float)(1 << (random >> 32) % 12);
+    }
+
+    const char* names[] = {"printf %f", "printf %.2f", "printf %g, else %.9g", "shortest", "precision 2"};
+    char buffer[64];
+    long sink = 0;
+    for (int kind = 0; kind < 5; kind++) {
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < count; i++) {
+            switch (kind) {
+                case 0:
+                    sink += snprintf(buffer, sizeof(buffer), "%f", values[i]);
+                    break;
+                case 1:
+                    sink += snprintf(buffer, sizeof(buffer), "%.2f", values[i]);
+                    break;
+                case 2:
+                    //The shortest round trip the printf family can give, trying a short form first
+                    sink += snprintf(buffer, sizeof(buffer), "%g", values[i]);
+                    if (strtof(buffer, NULL) != values[i]) sink += snprintf(buffer, sizeof(buffer), "%.9g", values[i]);
+                    break;
+                default:
+                    sink += formatNumber(buffer, values[i], kind == 3 ? NUMBER_SHORTEST : 2);
+                    break;
+            }
+        }
+        printf("  %-22s %8.1f ns/number\n", names[kind], elapsedMs(&start) * 1e6 / count);
+    }
+    free(values);
+    return sink > 0;
+}
+
+/**
+ * Times inserting at the back of, and iterating over, a linked List and a Vector of 1k, 100k and 10M elements, and
+ * reading the Vector by index.
+ */
+bool benchContainers(const char* directory, char* schemaFile) {
+    const int sizes[3] = {1000, 100000, 10000000};
+    int* values = malloc(sizes[2] * sizeof(int));
+    if (values == NULL) return false;
+    for (int i = 0; i < sizes[2]; i++) values[i] = i;
+
+    long sink = 0;
+    for (int s = 0; s < 3; s++) {
+        const int count = sizes[s];
+        //Small sizes are repeated so that each timing covers about 10M elements
+        const int rounds = sizes[2] / count;
+        double insertMs[2] = {0, 0};
+        double iterateMs[2] = {0, 0};
+        double indexMs = 0;
+        for (int round = 0; round < rounds; round++) {
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            List* list = initializeList(intToString, borrowedVectorData, compareInts);
+            for (int i = 0; i < count; i++) insertBack(list, &values[i]);
+            insertMs[0] += elapsedMs(&start);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            Vector* vector = initializeVector(intToString, borrowedVectorData, compareInts);
+            for (int i = 0; i < count; i++) insertBackVector(vector, &values[i]);
+            insertMs[1] += elapsedMs(&start);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            ListIterator listIter = createIterator(list);
+            for (int* value; (value = nextElement(&listIter)) != NULL;) sink += *value;
+            iterateMs[0] += elapsedMs(&start);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            VectorIterator vectorIter = createVectorIterator(vector);
+            for (int* value; (value = nextVectorElement(&vectorIter)) != NULL;) sink += *value;
+            iterateMs[1] += elapsedMs(&start);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (int i = 0; i < count; i++) sink += *(int*)getVectorElement(vector, i);
+            indexMs += elapsedMs(&start);
+
+            freeList(list);
+            freeVector(vector);
+        }
+        double elements = (double)count * rounds;
+        printf("  %8d elements  insert: list %6.2f ns, vector %6.2f ns   iterate: list %6.2f ns, vector %6.2f ns, "
+               "by index %6.2f ns\n", count, insertMs[0] * 1e6 / elements, insertMs[1] * 1e6 / elements,
+               iterateMs[0] * 1e6 / elements, iterateMs[1] * 1e6 / elements, indexMs * 1e6 / elements);
+    }
+    free(values);
+    return sink > 0;
+}
+
+/**Print function for the containers of benchContainers, which hold pointers to ints*/
+char* intToString(void* data) {
+    char* string = malloc(16);
+    sprintf(string, "%d", *(int*)data);
+    return string;
+}
+
+/**Compare function for the containers of benchContainers, ordering the ints they point to*/
+int compareInts(const void* first, const void* second) {
+    return *(const int*)first - *(const int*)second;
+}
+
+/**
+ * Times setAttribute on every shape of a 100k shape image, against finding each shape by walking its list from the
+ * head. A full walk per edit is too slow to run on every shape, so it is timed on every 100th one and scaled up.
+ */
+bool benchElementEdits(const char* directory, char* schemaFile) {
+    char* file = writeTestSVG(directory, "shapes.svg", 40000, 30000, 30000, 0);
+    SVGimage* image = (file == NULL ? NULL : createSVGimage(file));
+    free(file);
+    if (image == NULL) return false;
+
+    const elementType types[3] = {RECT, CIRC, PATH};
+    List* lists[3] = {image->rectangles, image->circles, image->paths};
+    const int sampleStep = 100;
+    double indexedMs = 0;
+    double walkMs = 0;
+    int edits = 0;
+    for (int t = 0; t < 3; t++) {
+        int length = getLength(lists[t]);
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < length; i++) setAttribute(image, types[t], i, newAttribute("fill", i % 2 ? "red" : "blue"));
+        indexedMs += elapsedMs(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < length; i += sampleStep) {
+            Node* node = lists[t]->head;
+            for (int j = 0; j < i; j++) node = node->next;
+            if (validateComponent(types[t], node->data)) applyAttribute(image, types[t], node->data, newAttribute("fill", "green"));
+        }
+        walkMs += elapsedMs(&start) * sampleStep;
+        edits += length;
+    }
+
+    //Every shape should be left with the last fill the indexed edits gave it, and one fill attribute
+    bool edited = true;
+    Vector* rectangles = getComponentView(image, RECT);
+    for (int i = 0; i < getVectorLength(rectangles); i++) {
+        Rectangle* rectangle = getVectorElement(rectangles, i);
+        Attribute* fill = existsInList(rectangle->otherAttributes, image->strings, "fill");
+        const char* expected = (i % sampleStep == 0 ? "green" : i % 2 ? "red" : "blue");
+        edited = edited && fill != NULL && strcmp(fill->value, expected) == 0 && getLength(rectangle->otherAttributes) == 1;
+    }
+    deleteSVGimage(image);
+    if (!edited) {
+        printf("  the edits were not applied\n");
+        return false;
+    }
+
+    printf("  %d edits  by index %9.2f ms (%6.2f us/edit), walking the list %9.2f ms (%6.2f us/edit, scaled)\n",
+           edits, indexedMs, indexedMs * 1e3 / edits, walkMs, walkMs * 1e3 / edits);
+    return true;
+}
+
+/**
+ * Times the JSON writers on a 1M shape image, and the rectangle list written the old way, by concatenating each
+ * rectangle's string, against rectListToJSON on growing prefixes of the rectangles.
+ */
+bool benchJSONWriter(const char* directory, char* schemaFile) {
+    char* file = writeTestSVG(directory, "shapes.svg", 400000, 300000, 300000, 0);
+    SVGimage* image = (file == NULL ? NULL : createSVGimageInArena(file));
+    free(file);
+    if (image == NULL) return false;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    char* lists[3] = {rectListToJSON(image->rectangles), circListToJSON(image->circles), pathListToJSON(image->paths)};
+    double listsMs = elapsedMs(&start);
+    size_t listsLength = strlen(lists[0]) + strlen(lists[1]) + strlen(lists[2]);
+    for (int i = 0; i < 3; i++) free(lists[i]);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    StringBuffer* buffer = createStringBuffer(0);
+    writeFullImageJSON(buffer, image);
+    char* full = bufferRelease(buffer);
+    double fullMs = elapsedMs(&start);
+    size_t fullLength = strlen(full);
+    free(full);
+    printf("  1000000 shapes  list JSON %9.2f ms (%.1f MB), full image JSON %9.2f ms (%.1f MB)\n", listsMs,
+           listsLength / 1e6, fullMs, fullLength / 1e6);
+
+    //Concatenating is quadratic, so it only gets prefixes
+    bool same = true;
+    for (int count = 10000; count <= 40000 && same; count *= 2) {
+        List* prefix = initializeList(rectangleToString, borrowedVectorData, compareRectangles);
+        ListIterator iter = createIterator(image->rectangles);
+        for (int i = 0; i < count; i++) insertBack(prefix, nextElement(&iter));
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        char* concatenated = concatenateRectsJSON(prefix);
+        double concatenateMs = elapsedMs(&start);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        char* written = rectListToJSON(prefix);
+        double writtenMs = elapsedMs(&start);
+
+        same = strcmp(concatenated, written) == 0;
+        printf("  %7d rects   concatenated %9.2f ms, rectListToJSON %9.2f ms  (%.0fx)\n", count, concatenateMs,
+               writtenMs, concatenateMs / writtenMs);
+        free(concatenated);
+        free(written);
+        freeList(prefix);
+    }
+    deleteSVGimage(image);
+    if (!same) printf("  the concatenated JSON does not match rectListToJSON\n");
+    return same;
+}
+
+/**rectListToJSON as it was before the single pass writer, growing the string and appending one rectangle at a time*/
+char* concatenateRectsJSON(const List* list) {
+    if (list == NULL || list->head == NULL) {
+        char* retString = calloc(3, sizeof(char));
+        strcpy(retString, "[]");
+        return retString;
+    }
+    ListIterator listIterator = createIterator((List*)list);
+    Rectangle* rectangle = NULL;
+    char* string = calloc(4, sizeof(char));
+    string[0] = '[';
+    while ((rectangle = nextElement(&listIterator)) != NULL) {
+        char* rectJSON = rectToJSON(rectangle);
+        string = realloc(string, strlen(string) + strlen(rectJSON) + 8);
+        strcat(string, rectJSON);
+        strcat(string, ",");
+        free(rectJSON);
+    }
+    *strrchr(string, ',') = ']';
+    return string;
+}
+
+/**
+ * Times a validated load of a file where every shape carries a dozen presentation attributes, and telling apart the
+ * element and attribute names of such a file with a strcmp chain, lookupKeyword and a KeywordCache.
+ */
+bool benchKeywordDispatch(const char* directory, char* schemaFile) {
+    const char* names[] = {"rect", "circle", "path", "g", "x", "y", "width", "height", "cx", "cy", "r", "d", "id",
+                           "class", "fill", "fill-opacity", "stroke", "stroke-width", "stroke-linecap",
+                           "stroke-linejoin", "opacity", "transform", "data-index"};
+    const int numNames = sizeof(names) / sizeof(names[0]);
+
+    char* path = calloc(strlen(directory) + 16, sizeof(char));
+    sprintf(path, "%s/styled.svg", directory);
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        free(path);
+        return false;
+    }
+    fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\">\n");
+    const int shapes = 60000;
+    for (int i = 0; i < shapes; i++) {
+        const char* style = "id=\"s%d\" class=\"shape\" fill=\"#%06x\" fill-opacity=\"0.5\" stroke=\"black\" "
+                            "stroke-width=\"2\" stroke-linecap=\"round\" stroke-linejoin=\"bevel\" opacity=\"0.9\" "
+                            "transform=\"rotate(%d)\" data-index=\"%d\"";
+        if (i % 3 == 0) fprintf(file, "  <rect x=\"%d\" y=\"%d\" width=\"10\" height=\"20\" ", i % 1000, i / 1000);
+        if (i % 3 == 1) fprintf(file, "  <circle cx=\"%d\" cy=\"%d\" r=\"5\" ", i % 1000, i / 1000);
+        if (i % 3 == 2) fprintf(file, "  <path d=\"M%d %d h10 v10 z\" ", i % 1000, i / 1000);
+        fprintf(file, style, i, i * 37 % 0xffffff, i % 360, i);
+        fprintf(file, "/>\n");
+    }
+    fprintf(file, "</svg>\n");
+    bool written = (fclose(file) == 0);
+
+    double loadMs = INFINITY;
+    for (int run = 0; run < 3 && written; run++) {
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        SVGimage* image = createValidSVGimage(path, schemaFile);
+        double ms = elapsedMs(&start);
+        written = (image != NULL);
+        deleteSVGimage(image);
+        if (ms < loadMs) loadMs = ms;
+    }
+    free(path);
+    if (!written) {
+        printf("  could not load the test file, is %s the SVG schema?\n", schemaFile);
+        return false;
+    }
+    printf("  %d shapes, 12 to 15 attributes each  validated load %9.2f ms\n", shapes, loadMs);
+
+    //The names come in as a parse sees them: a few distinct pointers, repeated
+    const int count = 10000000;
+    const char** stream = malloc(count * sizeof(char*));
+    if (stream == NULL) return false;
+    uint64_t state = 5;
+    for (int i = 0; i < count; i++) stream[i] = names[nextRandom(&state) % numNames];
+
+    KeywordCache cache;
+    initKeywordCache(&cache);
+    const char* kinds[3] = {"strcmp chain", "lookupKeyword", "KeywordCache"};
+    long sink = 0;
+    for (int kind = 0; kind < 3; kind++) {
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < count; i++) {
+            if (kind == 0) sink += dispatchByStrcmp(stream[i]);
+            else if (kind == 1) sink += lookupKeyword(stream[i]);
+            else sink += lookupCachedKeyword(&cache, stream[i]);
+        }
+        printf("  %-16s %8.1f ns/name\n", kinds[kind], elapsedMs(&start) * 1e6 / count);
+    }
+    free(stream);
+    return sink != 0;
+}
+
+/**Picks a handler for an element or attribute name the way the parser once did, one strcmp at a time*/
+int dispatchByStrcmp(const char* name) {
+    const char* handled[] = {"rect", "circle", "path", "g", "title", "desc", "x", "y", "width", "height", "cx",
+                             "cy", "r", "d"};
+    for (int i = 0; i < sizeof(handled) / sizeof(handled[0]); i++) {
+        if (strcmp(name, handled[i]) == 0) return i + 1;
+    }
+    return -1;
+}
+
+//Bytes libxml2 holds on the heap while benchStreamingWriter counts them, and the most it held at once
+long libxmlHeapBytes = 0;
+long libxmlHeapPeak = 0;
+
+/**
+ * Times writing a large image with writeSVGimage, which streams it, against building its tree with imageToXML and
+ * saving that, and compares the most heap libxml2 holds during each. The two files must be identical.
+ */
+bool benchStreamingWriter(const char* directory, char* schemaFile) {
+    char* file = writeTestSVG(directory, "shapes.svg", 100000, 30000, 30000, 10000);
+    SVGimage* image = (file == NULL ? NULL : createSVGimage(file));
+    free(file);
+    if (image == NULL) return false;
+
+    char* paths[2];
+    for (int kind = 0; kind < 2; kind++) {
+        paths[kind] = calloc(strlen(directory) + 16, sizeof(char));
+        sprintf(paths[kind], "%s/%s", directory, kind == 0 ? "tree.svg" : "streamed.svg");
+    }
+
+    //libxml2 allocates through the counting functions while they are installed. They use the same malloc, so memory
+    //allocated before or after can be freed either way.
+    xmlFreeFunc oldFree;
+    xmlMallocFunc oldMalloc;
+    xmlReallocFunc oldRealloc;
+    xmlStrdupFunc oldStrdup;
+    xmlMemGet(&oldFree, &oldMalloc, &oldRealloc, &oldStrdup);
+    xmlMemSetup(countedFree, countedMalloc, countedRealloc, countedStrdup);
+
+    double best[2] = {INFINITY, INFINITY};
+    long peak[2] = {0, 0};
+    bool written = true;
+    for (int run = 0; run < 3 && written; run++) {
+        for (int kind = 0; kind < 2; kind++) {
+            libxmlHeapBytes = libxmlHeapPeak = 0;
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            if (kind == 0) {
+                //writeSVGimage as it was, which checked the image the same way before building the tree
+                xmlDoc* document = (hasValidComponents(image) ? imageToXML(image) : NULL);
+                written = written && document != NULL && xmlSaveFormatFileEnc(paths[kind], document, "UTF-8", 1) != -1;
+                xmlFreeDoc(document);
+            } else {
+                written = written && writeSVGimage(image, paths[kind]);
+            }
+            double ms = elapsedMs(&start);
+            if (ms < best[kind]) best[kind] = ms;
+            peak[kind] = libxmlHeapPeak;
+        }
+    }
+    xmlMemSetup(oldFree, oldMalloc, oldRealloc, oldStrdup);
+    deleteSVGimage(image);
+
+    char* contents[2] = {readTestFile(paths[0]), readTestFile(paths[1])};
+    bool same = written && contents[0] != NULL && contents[1] != NULL && strcmp(contents[0], contents[1]) == 0;
+    if (same) {
+        printf("  tree and save  %9.2f ms, libxml2 peak heap %10.1f KB\n", best[0], peak[0] / 1e3);
+        printf("  streamed       %9.2f ms, libxml2 peak heap %10.1f KB\n", best[1], peak[1] / 1e3);
+    } else {
+        printf("  the streamed file does not match the saved tree\n");
+    }
+    for (int i = 0; i < 2; i++) {
+        free(contents[i]);
+        free(paths[i]);
+    }
+    return same;
+}
+
+/**
+ * Reads a whole file.
+ * @param path The file.
+ * @return Its contents, which the caller frees, or NULL if it could not be read.
+ */
+char* readTestFile(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    rewind(file);
+    char* contents = calloc(length + 1, sizeof(char));
+    if (fread(contents, 1, length, file) != length) {
+        free(contents);
+        contents = NULL;
+    }
+    fclose(file);
+    return contents;
+}
+
+/**malloc for libxml2 that adds to libxmlHeapBytes*/
+void* countedMalloc(size_t size) {
+    void* memory = malloc(size);
+    libxmlHeapBytes += malloc_usable_size(memory);
+    if (libxmlHeapBytes > libxmlHeapPeak) libxmlHeapPeak = libxmlHeapBytes;
+    return memory;
+}
+
+/**realloc for libxml2 that keeps libxmlHeapBytes up to date*/
+void* countedRealloc(void* memory, size_t size) {
+    size_t oldSize = malloc_usable_size(memory);
+    void* resized = realloc(memory, size);
+    if (resized == NULL) return NULL;
+    libxmlHeapBytes += (long)malloc_usable_size(resized) - (long)oldSize;
+    if (libxmlHeapBytes > libxmlHeapPeak) libxmlHeapPeak = libxmlHeapBytes;
+    return resized;
+}
+
+/**free for libxml2 that takes from libxmlHeapBytes*/
+void countedFree(void* memory) {
+    libxmlHeapBytes -= malloc_usable_size(memory);
+    free(memory);
+}
+
+/**strdup for libxml2 that adds to libxmlHeapBytes*/
+char* countedStrdup(const char* string) {
+    char* copy = countedMalloc(strlen(string) + 1);
+    if (copy != NULL) strcpy(copy, string);
+    return copy;
+}
+
 Rectangle* getTestRect() {
     Rectangle* r = calloc(1, sizeof(Rectangle));
     r->otherAttributes = initializeList(attributeToString, deleteAttribute, compareAttributes);
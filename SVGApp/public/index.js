@@ -9,7 +9,7 @@ $(document).ready(function () {
         success: function (data) {
             populateTable(data);
         },
-        fail: function (error) {
+        error: function (xhr, status, error) {
             alert(new Error("Could not load files." + error));
             populateTable(null);
         }
@@ -31,7 +31,7 @@ $(document).ready(function () {
                     alert("New file " + data.filename + " created!");
                     location.reload();
                 },
-                fail: function (error) {
+                error: function (xhr, status, error) {
                     alert(new Error("Could not create new file." + error));
                 }
             });
@@ -97,46 +97,89 @@ function populateTable (response) {
     }
 }
 
-function updateDetails (image) {
-//Update the details select box and details table
-    $('#detail-select').val(image);
-    $('.detail-wrapper').css("display", "block");
-    $('#component-save-edit-wrapper').css("display", "block");
-    $('#selectShapeNumber').css("display", "none");
-    $('#attributeTable').css("display", "none");
-    $('#selectComponent').empty();
-    $('#selectComponent').append('<option disabled selected value>-- Select an element type--</option>');
-    $('#selectRectNumber').empty();
-    $('#selectRectNumber').append('<option disabled selected value>-- Select an element number--</option>');
-    $('#selectCircleNumber').empty();
-    $('#selectCircleNumber').append('<option disabled selected value>-- Select an element number--</option>');
-    $('#selectPathNumber').empty();
-    $('#selectPathNumber').append('<option disabled selected value>-- Select an element number--</option>');
-    const table = $('.details-table');
+//Number of components of each type shown at once in the details table
+const PAGE_SIZE = 50;
+
+//The component types in the details table, keyed by the element name the /fileComponents route takes
+const componentTypes = {
+    rect: {list: 'rectangles', label: 'Rectangle', heading: 'Rectangles', shape: 'rects', select: '#selectRectNumber'},
+    circle: {list: 'circles', label: 'Circle', heading: 'Circles', shape: 'circles', select: '#selectCircleNumber'},
+    path: {list: 'paths', label: 'Path', heading: 'Paths', shape: 'paths', select: '#selectPathNumber'},
+    g: {list: 'groups', label: 'Group', heading: 'Groups'}
+};
 
-    //Get our JSON string for a file
-    let imageJSON;
+//The image in the details table and the filter its components are shown with
+let details = {image: null, filter: {}};
+
+//Get one page of an image's components of a type, and pass it to done. Undefined if it could not be loaded
+function getComponentPage(image, type, offset, limit, filter, done) {
     $.ajax({
         type: 'get',
         dataType: 'json',
-        url: '/fileData',
-        async: false,
+        url: '/fileComponents',
         data: {
-            filename: image
+            filename: image,
+            type: type,
+            offset: offset,
+            limit: limit,
+            attrName: filter.attrName,
+            attrValue: filter.attrValue,
+            area: filter.area
         },
-        success: function (data) {
-            imageJSON = data;
+        success: done,
+        error: function (xhr, status, error) {
+            alert(new Error("Could not load components for file. " + error));
+            done(undefined);
+        }
+    });
+}
+
+//Get the first page of every component type in one request, and pass them to done keyed by type. Undefined if they
+//could not be loaded
+function getComponentPages(image, filter, done) {
+    $.ajax({
+        type: 'get',
+        dataType: 'json',
+        url: '/fileDetails',
+        data: {
+            filename: image,
+            limit: PAGE_SIZE,
+            attrName: filter.attrName,
+            attrValue: filter.attrValue,
+            area: filter.area
         },
-        fail: function (error) {
-            alert(new Error("Could not load data for file. " + error));
+        success: done,
+        error: function (xhr, status, error) {
+            alert(new Error("Could not load components for file. " + error));
+            done(undefined);
         }
     });
+}
 
-    if (imageJSON === undefined || imageJSON === "") {
-        $('#detail-select').val(image);
-        $('.detail-wrapper').css("display", "none");
-        return;
-    }
+function updateDetails (image) {
+//Update the details select box and details table
+    $('#detail-select').val(image);
+    $('.detail-wrapper').css("display", "block");
+    $('#component-save-edit-wrapper').css("display", "block");
+
+    details = {image: image, filter: {}};
+    getComponentPages(image, details.filter, function (pages) {
+        //Another image was picked while this one loaded
+        if (details.image !== image) return;
+        if (pages === undefined || pages === "") {
+            $('#detail-select').val(image);
+            $('.detail-wrapper').css("display", "none");
+            return;
+        }
+        showDetails(image, pages);
+    });
+}
+
+//Fill the details table for an image, given the first page of each of its component types
+function showDetails (image, pages) {
+    //Every page brings the title and description
+    const imageJSON = pages.rect;
+    const table = $('.details-table');
 
     //Clear the table first
     table.empty();
@@ -148,58 +191,101 @@ function updateDetails (image) {
         '<tr><td colspan="2" class="detail-heading"><b>Title</b></td><td colspan="4" class="detail-heading"><b>Description</b></td></tr>' +
         '<tr><td colspan="2"><textarea class="imageDescriptor title" id="' + image + '" maxlength="255">' + imageJSON.title + '</textarea><button onclick="saveTitle()">Save Title</button></td>' +
         '<td colspan="4"><textarea class="imageDescriptor description" id="' + image + '" maxlength="255">' + imageJSON.description + '</textarea><button onclick="saveDescription()">Save Description</button></td></tr>' +
+        '<tr><td class="detail-heading"><b>Filter</b></td><td colspan="5">Attribute <input id="filterName" size="10"> = <input id="filterValue" size="10"> ' +
+        'Area (x y width height) <input id="filterArea" size="16"> <button onclick="applyFilter()">Apply</button></td></tr>' +
         '<tr><td class="detail-heading"><b>Component</b></td><td colspan="4" class="detail-heading"><b>Summary</b></td><td class="other-attributes detail-heading"><b>Other attributes</b></td></tr>'
     );
 
-    let i;
-    let select;
-    //Loop through rectangles
-    imageJSON.rectangles.forEach(function(r, i)  {
-        table.append('<tr><td>Rectangle ' + (i - -1) + '</td><td colspan="4">Top left: x=' + r.x + r.units + ', y=' + r.y + r.units + '<br>' +
-            'Width: ' + r.w + r.units + ' Height: ' + r.h + r.units + '</td><td class="other-attributes">' + r.numAttr + '</td></tr>')
+    //Each type gets its own rows, so that paging through one leaves the others in place
+    Object.keys(componentTypes).forEach(function (type) {
+        table.append('<tbody id="' + type + '-components"></tbody>');
     });
-    //Add to selector for editing
-    if (imageJSON.rectangles.length > 0) {
-        $('#selectComponent').append('<option value="rects" class="element-option">Rectangles</option>')
-        select = $('#selectRectNumber');
-        for(i = 0; i < imageJSON.rectangles.length; i++){
-            select.append('<option value="' + i + '" class="element-option">Rectangle ' + (i - -1) + '</option>');
+    showComponentPages(pages);
+}
+
+//Replace the rows of every type with the given pages, and offer the types that have components for editing
+function showComponentPages (pages) {
+    $('#selectShapeNumber').css("display", "none");
+    $('#attributeTable').css("display", "none");
+    $('#selectComponent').empty();
+    $('#selectComponent').append('<option disabled selected value>-- Select an element type--</option>');
+
+    Object.keys(componentTypes).forEach(function (type) {
+        const page = pages[type];
+        showComponentPage(type, page);
+
+        //Add to selector for editing
+        if (componentTypes[type].select !== undefined && page.total > 0) {
+            $('#selectComponent').append('<option value="' + componentTypes[type].shape + '" class="element-option">' + componentTypes[type].heading + '</option>');
         }
-    }
+    });
+}
 
-    //Loop through circles
-    imageJSON.circles.forEach(function(c, i)  {
-        table.append('<tr><td>Circle ' + (i - -1) + '</td><td colspan="4">Center: cx=' + c.cx + c.units + ', cy=' + c.cy + c.units + '<br>' +
-            'Radius: ' + c.r + c.units + '</td><td class="other-attributes">' + c.numAttr + '</td></tr>')
+//Show the components of a type from the given offset, with the current filter
+function changePage (type, offset) {
+    const image = details.image;
+    const filter = details.filter;
+    getComponentPage(image, type, Math.max(offset, 0), PAGE_SIZE, filter, function (page) {
+        if (page !== undefined && details.image === image && details.filter === filter) showComponentPage(type, page);
     });
-    //Add to selector for editing
-    if (imageJSON.circles.length > 0) {
-        $('#selectComponent').append('<option value="circles" class="element-option">Circles</option>')
-        select = $('#selectCircleNumber');
-        for(i = 0; i < imageJSON.circles.length; i++){
-            select.append('<option value="' + i + '" class="element-option">Circle ' + (i - -1) + '</option>');
-        }
-    }
+}
 
-    //Loop through paths
-    imageJSON.paths.forEach(function(p, i)  {
-        table.append('<tr><td>Path ' + (i - -1) + '</td><td colspan="4">Data: ' + p.d + '</td><td class="other-attributes">' + p.numAttr + '</td></tr>')
+//Show only the components that match the filter
+function applyFilter () {
+    const image = details.image;
+    const filter = {
+        attrName: $('#filterName').val(),
+        attrValue: $('#filterValue').val(),
+        area: $('#filterArea').val()
+    };
+    details.filter = filter;
+    getComponentPages(image, filter, function (pages) {
+        if (pages !== undefined && details.image === image && details.filter === filter) showComponentPages(pages);
+    });
+}
+
+//Replace the rows for a type with one page of its components
+function showComponentPage (type, page) {
+    const info = componentTypes[type];
+    const rows = $('#' + type + '-components');
+    const items = page[info.list];
+    const select = $(info.select);
+    rows.empty();
+    select.empty();
+    select.append('<option disabled selected value>-- Select an element number--</option>');
+    if (page.total === 0) return;
+
+    let heading = '<tr><td colspan="6" class="detail-heading"><b>' + info.heading + '</b> ' + (page.offset - -1) + '-' +
+        (page.offset + items.length) + ' of ' + page.total;
+    if (page.offset > 0) heading += ' <button onclick="changePage(\'' + type + '\', ' + (page.offset - PAGE_SIZE) + ')">Previous</button>';
+    if (page.offset + items.length < page.total) heading += ' <button onclick="changePage(\'' + type + '\', ' + (page.offset + PAGE_SIZE) + ')">Next</button>';
+    rows.append(heading + '</td></tr>');
+
+    items.forEach(function (c, i) {
+        rows.append(componentRow(type, c, page.indices[i]));
     });
-    //Add to selector for editing
-    if (imageJSON.paths.length > 0) {
-        $('#selectComponent').append('<option value="paths" class="element-option">Paths</option>')
-        select = $('#selectPathNumber');
-        for(i = 0; i < imageJSON.paths.length; i++){
-            select.append('<option value="' + i + '" class="element-option">Path ' + (i - -1) + '</option>');
-        }
-    }
 
-    //Loop through groups
-    imageJSON.groups.forEach(function(g, i)  {
-        table.append('<tr><td>Group ' + (i - -1) + '</td><td colspan="4">Number of children: ' + g.children + '</td><td class="other-attributes">' + g.numAttr + '</td></tr>')
+    //Only the components on the page can be picked for editing
+    items.forEach(function (c, i) {
+        select.append('<option value="' + page.indices[i] + '" class="element-option">' + info.label + ' ' + (page.indices[i] - -1) + '</option>');
     });
 }
 
+//Make the details table row for a component, given its index among the image's components of its type
+function componentRow (type, c, index) {
+    const name = componentTypes[type].label + ' ' + (index - -1);
+    if (type === 'rect') {
+        return '<tr><td>' + name + '</td><td colspan="4">Top left: x=' + c.x + c.units + ', y=' + c.y + c.units + '<br>' +
+            'Width: ' + c.w + c.units + ' Height: ' + c.h + c.units + '</td><td class="other-attributes">' + c.numAttr + '</td></tr>';
+    } else if (type === 'circle') {
+        return '<tr><td>' + name + '</td><td colspan="4">Center: cx=' + c.cx + c.units + ', cy=' + c.cy + c.units + '<br>' +
+            'Radius: ' + c.r + c.units + '</td><td class="other-attributes">' + c.numAttr + '</td></tr>';
+    } else if (type === 'path') {
+        return '<tr><td>' + name + '</td><td colspan="4">Data: ' + c.d + '</td><td class="other-attributes">' + c.numAttr + '</td></tr>';
+    }
+    return '<tr><td>' + name + '</td><td colspan="4">Number of children: ' + c.children + '</td><td class="other-attributes">' + c.numAttr + '</td></tr>';
+}
+
 function saveTitle() {
     const title = $('.title').val();
     const imageName = $('#imageInFocus').attr('src');
@@ -214,7 +300,7 @@ function saveTitle() {
         success: function () {
             alert("Title saved!");
         },
-        fail: function (error) {
+        error: function (xhr, status, error) {
             alert(new Error("Could not save description. " + error));
         }
     });
@@ -234,7 +320,7 @@ function saveDescription() {
         success: function () {
             alert("Description saved!");
         },
-        fail: function (error) {
+        error: function (xhr, status, error) {
             alert(new Error("Could not save description. " + error));
         }
     });
@@ -263,34 +349,29 @@ function showShapes(type) {
 }
 
 function showAttrs(shapeNumber, shape) {
-    var shapes;
     const imageName = $('#imageInFocus').attr('src');
-    $.ajax({
-        type: 'get',
-        dataType: 'json',
-        url: '/fileData',
-        async: false,
-        data: {
-            filename: imageName
-        },
-        success: function (r) {
-            shapes = r;
-        },
-        fail: function (error) {
-            alert(new Error("Could not get shapes. " + error));
+    //Only the selected component is fetched, as a page of one
+    const type = Object.keys(componentTypes).find(function (t) {
+        return componentTypes[t].shape === shape;
+    });
+    getComponentPage(imageName, type, shapeNumber, 1, {}, function (page) {
+        if (page === undefined || page[componentTypes[type].list].length === 0) {
             location.reload();
+            return;
         }
+        showAttrTable(page[componentTypes[type].list][0], shape);
     });
+}
 
+//Fill the attribute table with a component's attributes
+function showAttrTable(s, shape) {
     //Populate the attribute table with all the attributes of the selected element
     var table = $('#attributeTable');
     table.empty();
     table.append('<tr><th class="heading"><h2>Attribute</h2></th><th class="heading"><h2>Value</h2></th></tr>');
 
     //This is kinda gross and very duplicate codey but each part has something slightly different
-    let s;
     if (shape === "circles") {
-        s = shapes.circles[shapeNumber];
         table.append(
             '<tr><td>cx</td><td><textarea class="imageDescriptor attributeDescriptor" id="circleCX">' + s.cx + '</textarea></td></tr>' +
             '<tr><td>cy</td><td><textarea class="imageDescriptor attributeDescriptor" id="circleCY">' + s.cy + '</textarea></td></tr>' +
@@ -304,7 +385,6 @@ function showAttrs(shapeNumber, shape) {
             )
         })
     } else if (shape === "rects") {
-        s = shapes.rectangles[shapeNumber];
         table.append(
             '<tr><td>x</td><td><textarea class="imageDescriptor attributeDescriptor" id="rectX">' + s.x + '</textarea></td></tr>' +
             '<tr><td>y</td><td><textarea class="imageDescriptor attributeDescriptor" id="rectY">' + s.y + '</textarea></td></tr>' +
@@ -319,7 +399,6 @@ function showAttrs(shapeNumber, shape) {
             )
         })
     } else if (shape === "paths") {
-        s = shapes.paths[shapeNumber];
         table.append('<tr><td>d</td><td><textarea class="imageDescriptor attributeDescriptor" id="pathData" maxlength="63">' + s.d + '</textarea></td></tr>');
 
         if (s.numAttr > 0) table.append('<tr><td colspan="2"><b>Other Attribute(s)</b></td></tr>');